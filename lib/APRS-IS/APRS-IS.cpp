@@ -1,5 +1,6 @@
 #include "APRS-IS.h"
 #include <logger.h>
+#include <lwip/sockets.h>
 
 void APRS_IS::setup(const String &user, const String &passcode, const String &tool_name, const String &version) {
   _user      = user;
@@ -8,38 +9,75 @@ void APRS_IS::setup(const String &user, const String &passcode, const String &to
   _version   = version;
 }
 
-APRS_IS::ConnectionStatus APRS_IS::connect(const String &server, const int port) {
+APRS_IS::ConnectionStatus APRS_IS::connect(const String &server, const int port, const uint32_t connect_timeout) {
   const String login = "user " + _user + " pass " + _passcode + " vers " + _tool_name + " " + _version + "\n\r";
-  return _connect(server, port, login);
+  return _connect(server, port, login, connect_timeout);
 }
 
-APRS_IS::ConnectionStatus APRS_IS::connect(const String &server, const int port, const String &filter) {
+APRS_IS::ConnectionStatus APRS_IS::connect(const String &server, const int port, const String &filter, const uint32_t connect_timeout) {
   const String login = "user " + _user + " pass " + _passcode + " vers " + _tool_name + " " + _version + " filter " + filter + "\n\r";
-  return _connect(server, port, login);
+  return _connect(server, port, login, connect_timeout);
 }
 
-APRS_IS::ConnectionStatus APRS_IS::_connect(const String &server, const int port, const String &login_line) {
-  if (!_client.connect(server.c_str(), port)) {
+APRS_IS::ConnectionStatus APRS_IS::connect(int socket, const String &filter) {
+  // Same socket settings as WiFiClient::connect()
+  int enable = 1;
+  fcntl(socket, F_SETFL, fcntl(socket, F_GETFL, 0) & ~O_NONBLOCK);
+  setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+  setsockopt(socket, SOL_SOCKET, SO_KEEPALIVE, &enable, sizeof(enable));
+  _client = WiFiClient(socket);
+
+  String login = "user " + _user + " pass " + _passcode + " vers " + _tool_name + " " + _version;
+  if (!filter.isEmpty()) {
+    login += " filter " + filter;
+  }
+  return _login(login + "\n\r");
+}
+
+APRS_IS::ConnectionStatus APRS_IS::_connect(const String &server, const int port, const String &login_line, const uint32_t connect_timeout) {
+  if (!_client.connect(server.c_str(), port, connect_timeout)) {
     return ERROR_CONNECTION;
   }
+  return _login(login_line);
+}
+
+APRS_IS::ConnectionStatus APRS_IS::_login(const String &login_line) {
+  _framer.reset();
   sendMessage(login_line);
-  while (true) {
-    String line = _client.readStringUntil('\n');
-    if (line.indexOf("logresp") != -1) {
-      if (line.indexOf("unverified") == -1) {
-        return SUCCESS;
-      } else {
-        return ERROR_PASSCODE;
-      }
+  _loginStart    = millis();
+  _lastReceived  = _loginStart;
+  _lastHeartbeat = _loginStart;
+  return IN_PROGRESS;
+}
+
+APRS_IS::ConnectionStatus APRS_IS::pollLogin(const uint32_t login_timeout) {
+  if (!connected()) {
+    return ERROR_CONNECTION;
+  }
+
+  const char *line;
+  size_t      length;
+  while (readLine(&line, &length)) {
+    // Anything else is the server banner
+    if (strstr(line, "logresp") != NULL) {
+      return (strstr(line, "unverified") == NULL) ? SUCCESS : ERROR_PASSCODE;
     }
   }
-  return SUCCESS;
+
+  if (millis() - _loginStart >= login_timeout) {
+    return ERROR_TIMEOUT;
+  }
+  return IN_PROGRESS;
 }
 
 bool APRS_IS::connected() {
   return _client.connected();
 }
 
+void APRS_IS::disconnect() {
+  _client.stop();
+}
+
 bool APRS_IS::sendMessage(const String &message) {
   if (!connected()) {
     return false;
@@ -56,30 +94,65 @@ bool APRS_IS::sendMessage(const std::shared_ptr<APRSMessage> message) {
   return true;
 }
 
+size_t APRS_IS::sendRaw(const char *data, size_t length) {
+  if (!connected()) {
+    return 0;
+  }
+  return _client.write((const uint8_t *)data, length);
+}
+
 int APRS_IS::available() {
   return _client.available();
 }
 
+bool APRS_IS::readLine(const char **line, size_t *length) {
+  while (!_framer.next(line, length)) {
+    if (_framer.fill(_client) == 0) {
+      return false;
+    }
+    _lastReceived = millis();
+  }
+  if ((*line)[0] == '#') {
+    // Server comment, aprsc sends one every 20s even when no packet matches the filter
+    _lastHeartbeat = millis();
+  }
+  return true;
+}
+
 String APRS_IS::getMessage() {
-  String line;
-  if (_client.available() > 0) {
-    line = _client.readStringUntil('\n');
+  const char *line;
+  size_t      length;
+  if (!readLine(&line, &length)) {
+    return String();
   }
-  return line;
+  return String(line);
 }
 
 std::shared_ptr<APRSMessage> APRS_IS::getAPRSMessage() {
-  String line;
-  if (_client.available() > 0) {
-    line = _client.readStringUntil('\n');
+  const char *line;
+  size_t      length;
+  if (!readLine(&line, &length)) {
+    return 0;
   }
-  if (line.startsWith("#")) {
+  if (line[0] == '#') {
     return 0;
   }
-  if (line.length() == 0) {
+  if (length == 0) {
     return 0;
   }
   std::shared_ptr<APRSMessage> msg = std::shared_ptr<APRSMessage>(new APRSMessage());
   msg->decode(line);
   return msg;
 }
+
+uint32_t APRS_IS::getLastReceived() const {
+  return _lastReceived;
+}
+
+uint32_t APRS_IS::getLastHeartbeat() const {
+  return _lastHeartbeat;
+}
+
+uint32_t APRS_IS::getOverflowCount() const {
+  return _framer.getOverflowCount();
+}
@@ -5,6 +5,8 @@
 #include <APRS-Decoder.h>
 #include <WiFi.h>
 
+#include "LineFramer.h"
+
 class APRS_IS {
 public:
   void setup(const String &user, const String &passcode, const String &tool_name, const String &version);
@@ -14,28 +16,87 @@ public:
     SUCCESS,
     ERROR_CONNECTION,
     ERROR_PASSCODE,
+    ERROR_TIMEOUT,
+    IN_PROGRESS,
   };
 
-  ConnectionStatus connect(const String &server, const int port);
-  ConnectionStatus connect(const String &server, const int port, const String &filter);
-  bool             connected();
+  /**
+   * @brief     Opens the TCP connection (waiting at most connect_timeout ms) and sends the login line.
+   *
+   * @return    IN_PROGRESS if the login line was sent, then call pollLogin() until it returns something else.
+   *            ERROR_CONNECTION if the server could not be reached.
+   */
+  ConnectionStatus connect(const String &server, const int port, const uint32_t connect_timeout);
+  ConnectionStatus connect(const String &server, const int port, const String &filter, const uint32_t connect_timeout);
+
+  /**
+   * @brief     Takes over a TCP connection already opened to the server (it may be non-blocking) and sends the login line.
+   *
+   * @param[in] filter Server-side filter, empty for none.
+   *
+   * @return    IN_PROGRESS, then call pollLogin() until it returns something else.
+   */
+  ConnectionStatus connect(int socket, const String &filter);
+
+  /**
+   * @brief     Never blocks. Reads the lines received so far, looking for the login response.
+   *
+   * @param[in] login_timeout Time (in ms) after connect() to give up on the login response.
+   */
+  ConnectionStatus pollLogin(const uint32_t login_timeout);
+
+  bool connected();
+  void disconnect();
 
   bool sendMessage(const String &message);
   bool sendMessage(const std::shared_ptr<APRSMessage> message);
 
+  /**
+   * @brief     Sends data as is, in a single write. The data must contain complete lines, "\r\n" terminated.
+   *
+   * @return    The number of bytes written, less than length if the connection failed on the way.
+   */
+  size_t sendRaw(const char *data, size_t length);
+
   int available();
 
+  /**
+   * @brief     Never blocks. Returns the next line received from the server, without "\r\n" and NUL terminated.
+   *
+   * The line points into the receive buffer and is only valid until the next call.
+   *
+   * @return    false if no complete line was received.
+   */
+  bool readLine(const char **line, size_t *length);
+
   String                       getMessage();
   std::shared_ptr<APRSMessage> getAPRSMessage();
 
+  /**
+   * @brief     millis() when the last byte was received from the server, or when the connection was opened.
+   */
+  uint32_t getLastReceived() const;
+
+  /**
+   * @brief     millis() when the last server comment line ("# ...") was read, or when the connection was opened.
+   */
+  uint32_t getLastHeartbeat() const;
+
+  uint32_t getOverflowCount() const;
+
 private:
   String     _user;
   String     _passcode;
   String     _tool_name;
   String     _version;
   WiFiClient _client;
+  LineFramer _framer;
+  uint32_t   _loginStart;    // millis() when the login line was sent
+  uint32_t   _lastReceived;  // millis()
+  uint32_t   _lastHeartbeat; // millis()
 
-  ConnectionStatus _connect(const String &server, const int port, const String &login_line);
+  ConnectionStatus _connect(const String &server, const int port, const String &login_line, const uint32_t connect_timeout);
+  ConnectionStatus _login(const String &login_line);
 };
 
 #endif
@@ -0,0 +1,69 @@
+#include "LineFramer.h"
+
+LineFramer::LineFramer() : _start(0), _end(0), _scan(0), _discarding(false), _overflows(0) {
+}
+
+void LineFramer::reset() {
+  _start      = 0;
+  _end        = 0;
+  _scan       = 0;
+  _discarding = false;
+}
+
+size_t LineFramer::fill(Client &client) {
+  if (_start > 0) {
+    memmove(_buffer, _buffer + _start, _end - _start);
+    _end -= _start;
+    _scan -= _start;
+    _start = 0;
+  }
+
+  int available = client.available();
+  if (available <= 0 || _end == BUFFER_SIZE) {
+    return 0;
+  }
+
+  int received = client.read((uint8_t *)_buffer + _end, std::min<size_t>(available, BUFFER_SIZE - _end));
+  if (received <= 0) {
+    return 0;
+  }
+  _end += received;
+  return received;
+}
+
+bool LineFramer::next(const char **line, size_t *length) {
+  for (;;) {
+    char *newLine = (char *)memchr(_buffer + _scan, '\n', _end - _scan);
+    if (newLine == NULL) {
+      _scan = _end;
+      if (_start == 0 && _end == BUFFER_SIZE) {
+        // No room left to complete the line
+        _overflows++;
+        reset();
+        _discarding = true;
+      }
+      return false;
+    }
+
+    size_t lineStart = _start;
+    size_t lineEnd   = newLine - _buffer;
+    _start           = lineEnd + 1;
+    _scan            = _start;
+    if (_discarding) {
+      _discarding = false;
+      continue;
+    }
+
+    if (lineEnd > lineStart && _buffer[lineEnd - 1] == '\r') {
+      lineEnd--;
+    }
+    _buffer[lineEnd] = '\0';
+    *line            = _buffer + lineStart;
+    *length          = lineEnd - lineStart;
+    return true;
+  }
+}
+
+uint32_t LineFramer::getOverflowCount() const {
+  return _overflows;
+}
@@ -0,0 +1,45 @@
+#ifndef LINE_FRAMER_H_
+#define LINE_FRAMER_H_
+
+#include <Client.h>
+
+/**
+ * @brief Splits the bytes received on a socket into lines without any allocation.
+ *
+ * Bytes are read in blocks into a fixed buffer. Complete lines are returned as pointers into that buffer, the incomplete line at
+ * its end is moved to the front before the next read. Lines longer than the buffer are dropped up to their end.
+ */
+class LineFramer {
+public:
+  static constexpr size_t BUFFER_SIZE = 1024; // APRS-IS lines are at most 512 bytes long
+
+  LineFramer();
+
+  void reset();
+
+  /**
+   * @brief     Reads as many bytes as available and as fit in the buffer. Invalidates the lines returned by next().
+   *
+   * @return    The number of bytes read.
+   */
+  size_t fill(Client &client);
+
+  /**
+   * @brief     Returns the next complete line, without its "\r\n" and NUL terminated. The line is valid until the next call of fill().
+   *
+   * @return    false if the buffer does not hold a complete line.
+   */
+  bool next(const char **line, size_t *length);
+
+  uint32_t getOverflowCount() const;
+
+private:
+  char     _buffer[BUFFER_SIZE + 1];
+  size_t   _start;      // First byte of the next line
+  size_t   _end;        // End of the received bytes
+  size_t   _scan;       // Bytes before this one were already searched for '\n'
+  bool     _discarding; // Dropping the end of a line too long for the buffer
+  uint32_t _overflows;
+};
+
+#endif
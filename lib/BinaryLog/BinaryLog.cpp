@@ -0,0 +1,414 @@
+#include <time.h>
+
+#include "BinaryLog.h"
+
+// The ESP32 is little endian, like the file format
+template <typename T> static void put(uint8_t *&p, T value) {
+  memcpy(p, &value, sizeof(T));
+  p += sizeof(T);
+}
+
+template <typename T> static T get(const uint8_t *&p) {
+  T value;
+  memcpy(&value, p, sizeof(T));
+  p += sizeof(T);
+  return value;
+}
+
+BinaryLog::BinaryLog(fs::FS &fs, uint16_t indexInterval, size_t bufferSize) : _fs(fs), _indexInterval(std::max<uint16_t>(indexInterval, 1)), _buffer(new uint8_t[bufferSize]), _bufferSize(bufferSize), _buffered(0), _firstSeq(0), _nextSeq(0), _size(0), _nbPending(0) {
+}
+
+BinaryLog::~BinaryLog() {
+  close();
+  delete[] _buffer;
+}
+
+bool BinaryLog::create(const String &path, uint32_t firstSeq) {
+  close();
+  _data  = _fs.open(path, "w", true);
+  _index = _fs.open(getIndexPath(path), "w", true);
+  if (!_data || !_index) {
+    close();
+    return false;
+  }
+
+  uint8_t  header[HEADER_SIZE];
+  uint8_t *p = header;
+  put<uint32_t>(p, MAGIC);
+  put<uint16_t>(p, VERSION);
+  put<uint16_t>(p, _indexInterval);
+  put<uint32_t>(p, firstSeq);
+  put<uint32_t>(p, 0); // Reserved
+  if (_data.write(header, HEADER_SIZE) != HEADER_SIZE) {
+    close();
+    return false;
+  }
+  _data.flush();
+
+  _firstSeq  = firstSeq;
+  _nextSeq   = firstSeq;
+  _size      = HEADER_SIZE;
+  _buffered  = 0;
+  _nbPending = 0;
+  return true;
+}
+
+bool BinaryLog::open(const String &path) {
+  close();
+  Reader reader(_fs);
+  if (!reader.open(path)) {
+    // Bad header, the records after it may still be readable
+    _nextSeq = 0;
+    findNextSeq(_fs, path, &_nextSeq);
+    return false;
+  }
+  _firstSeq = reader.getFirstSeq();
+  if (reader._indexInterval != _indexInterval) {
+    _nextSeq = _firstSeq;
+    findNextSeq(_fs, path, &_nextSeq);
+    return false;
+  }
+
+  // Start from the last index entry, or from the first record if the index does not match the records
+  size_t entries = reader._index ? reader._index.size() / INDEX_SIZE : 0;
+  size_t size    = reader._data.size();
+  bool   rebuild = false;
+  if (entries > 0) {
+    Reader::IndexEntry entry;
+    if (reader.readIndex(entries - 1, entry) && entry.seq == _firstSeq + (entries - 1) * _indexInterval && entry.offset < size) {
+      reader._data.seek(entry.offset);
+      _nextSeq = entry.seq;
+    } else {
+      rebuild  = true;
+      _nextSeq = _firstSeq;
+    }
+  } else {
+    _nextSeq = _firstSeq;
+  }
+
+  Record record;
+  while (reader._data.position() < size) {
+    if (!readRecord(reader._data, record) || record.seq != _nextSeq) {
+      // Truncated by a power loss, appending after it would make the rest of the file unreadable
+      return false;
+    }
+    _nextSeq++;
+  }
+  reader.close();
+
+  size_t expected = (getCount() + _indexInterval - 1) / _indexInterval;
+  if ((rebuild || entries != expected) && !rebuildIndex(path)) {
+    return false;
+  }
+
+  _data  = _fs.open(path, "a");
+  _index = _fs.open(getIndexPath(path), "a");
+  if (!_data || !_index) {
+    close();
+    return false;
+  }
+  _size      = size;
+  _buffered  = 0;
+  _nbPending = 0;
+  return true;
+}
+
+void BinaryLog::close() {
+  if (_data) {
+    flush();
+  }
+  _data.close();
+  _index.close();
+}
+
+bool BinaryLog::append(Record &record) {
+  size_t length = FIXED_SIZE + record.frameLength;
+  if (_buffered + length > _bufferSize || _nbPending == MAX_PENDING) {
+    if (!flush()) {
+      return false;
+    }
+  }
+  if (length > _bufferSize) {
+    return false;
+  }
+
+  record.seq = _nextSeq;
+  if ((record.seq - _firstSeq) % _indexInterval == 0) {
+    uint8_t *p = _pending + _nbPending * INDEX_SIZE;
+    put<uint32_t>(p, record.seq);
+    put<uint32_t>(p, record.rxTime);
+    put<uint32_t>(p, _size);
+    _nbPending++;
+  }
+
+  uint8_t *p = _buffer + _buffered;
+  put<uint16_t>(p, length - 2);
+  put<uint32_t>(p, record.seq);
+  put<uint32_t>(p, record.rxTime);
+  put<float>(p, record.rssi);
+  put<float>(p, record.snr);
+  put<float>(p, record.freqError);
+  put<uint8_t>(p, record.crcOk ? 1 : 0);
+  memcpy(p, record.frame, record.frameLength);
+
+  _buffered += length;
+  _size += length;
+  _nextSeq++;
+  return true;
+}
+
+bool BinaryLog::flush() {
+  if (!_data) {
+    return false;
+  }
+
+  // Records first: an index entry must never point past the end of the file
+  bool ok = true;
+  if (_buffered > 0) {
+    ok = (_data.write(_buffer, _buffered) == _buffered);
+    _data.flush();
+    _buffered = 0;
+  }
+  if (_nbPending > 0) {
+    ok = (_index.write(_pending, _nbPending * INDEX_SIZE) == _nbPending * INDEX_SIZE) && ok;
+    _index.flush();
+    _nbPending = 0;
+  }
+  return ok;
+}
+
+size_t BinaryLog::getBuffered() const {
+  return _buffered;
+}
+
+uint32_t BinaryLog::getFirstSeq() const {
+  return _firstSeq;
+}
+
+uint32_t BinaryLog::getNextSeq() const {
+  return _nextSeq;
+}
+
+uint32_t BinaryLog::getCount() const {
+  return _nextSeq - _firstSeq;
+}
+
+String BinaryLog::getIndexPath(const String &path) {
+  return path + ".idx";
+}
+
+size_t BinaryLog::toTsv(const Record &record, char *buffer, size_t size) {
+  struct tm timeInfo;
+  time_t    rxTime = record.rxTime;
+  char      timestamp[21];
+  gmtime_r(&rxTime, &timeInfo);
+  strftime(timestamp, sizeof(timestamp), "%FT%TZ", &timeInfo);
+
+  // Same columns as PacketLoggerTask::HEADER
+  const char fmt[] = "%u\t%s\t%.*s\t%.*s\t%.*s\t%s\t%.1f\t%.1f\t%.1f\n";
+  if (!record.crcOk) {
+    int length = snprintf(buffer, size, fmt, record.seq, timestamp, 1, " ", 1, " ", 1, " ", "INVALID PACKET", record.rssi, record.snr, record.freqError);
+    return (length > 0 && (size_t)length < size) ? length : 0;
+  }
+
+  // "SOURCE>DESTINATION,PATH:DATA"
+  const char *frame       = record.frame;
+  const char *source      = strchr(frame, '>');
+  const char *data        = strchr(frame, ':');
+  const char *destination = (source != NULL && source < data) ? source + 1 : frame;
+  const char *path        = (data != NULL) ? (const char *)memchr(destination, ',', data - destination) : NULL;
+  const char *end         = (path != NULL) ? path : data;
+  if (source == NULL || data == NULL || source > data) {
+    int length = snprintf(buffer, size, fmt, record.seq, timestamp, 0, "", 0, "", 0, "", frame, record.rssi, record.snr, record.freqError);
+    return (length > 0 && (size_t)length < size) ? length : 0;
+  }
+
+  int length = snprintf(buffer, size, fmt, record.seq, timestamp, (int)(source - frame), frame, (int)(end - destination), destination, //
+                        (path != NULL) ? (int)(data - path - 1) : 0, (path != NULL) ? path + 1 : "", data + 1, record.rssi, record.snr, record.freqError);
+  return (length > 0 && (size_t)length < size) ? length : 0;
+}
+
+bool BinaryLog::findNextSeq(fs::FS &fs, const String &path, uint32_t *nextSeq) {
+  File file = fs.open(path, "r");
+  if (!file || !file.seek(HEADER_SIZE)) {
+    return false;
+  }
+
+  // Up to the first unreadable record or break in the sequence
+  Record record;
+  bool   found = false;
+  while (readRecord(file, record) && (!found || record.seq == *nextSeq)) {
+    *nextSeq = record.seq + 1;
+    found    = true;
+  }
+  return found;
+}
+
+bool BinaryLog::readRecord(File &file, Record &record) {
+  uint8_t fixed[FIXED_SIZE];
+  if (file.read(fixed, FIXED_SIZE) != FIXED_SIZE) {
+    return false;
+  }
+
+  const uint8_t *p      = fixed;
+  uint16_t       length = get<uint16_t>(p);
+  if (length < FIXED_SIZE - 2 || length - (FIXED_SIZE - 2) > MAX_FRAME) {
+    return false;
+  }
+  record.seq         = get<uint32_t>(p);
+  record.rxTime      = get<uint32_t>(p);
+  record.rssi        = get<float>(p);
+  record.snr         = get<float>(p);
+  record.freqError   = get<float>(p);
+  record.crcOk       = (get<uint8_t>(p) & 1) != 0;
+  record.frameLength = length - (FIXED_SIZE - 2);
+  if (file.read((uint8_t *)record.frame, record.frameLength) != record.frameLength) {
+    return false;
+  }
+  record.frame[record.frameLength] = '\0';
+  return true;
+}
+
+bool BinaryLog::rebuildIndex(const String &path) {
+  File data  = _fs.open(path, "r");
+  File index = _fs.open(getIndexPath(path), "w", true);
+  if (!data || !index || !data.seek(HEADER_SIZE)) {
+    return false;
+  }
+
+  Record record;
+  size_t offset = HEADER_SIZE;
+  while (readRecord(data, record)) {
+    if ((record.seq - _firstSeq) % _indexInterval == 0) {
+      uint8_t  entry[INDEX_SIZE];
+      uint8_t *p = entry;
+      put<uint32_t>(p, record.seq);
+      put<uint32_t>(p, record.rxTime);
+      put<uint32_t>(p, offset);
+      if (index.write(entry, INDEX_SIZE) != INDEX_SIZE) {
+        return false;
+      }
+    }
+    offset = data.position();
+  }
+  index.flush();
+  return true;
+}
+
+BinaryLog::Reader::Reader(fs::FS &fs) : _fs(fs), _firstSeq(0), _indexInterval(1) {
+}
+
+BinaryLog::Reader::~Reader() {
+  close();
+}
+
+bool BinaryLog::Reader::open(const String &path) {
+  close();
+  _data = _fs.open(path, "r");
+  if (!_data) {
+    return false;
+  }
+
+  uint8_t header[HEADER_SIZE];
+  if (_data.read(header, HEADER_SIZE) != HEADER_SIZE) {
+    close();
+    return false;
+  }
+  const uint8_t *p = header;
+  if (get<uint32_t>(p) != MAGIC || get<uint16_t>(p) != VERSION) {
+    close();
+    return false;
+  }
+  _indexInterval = std::max<uint16_t>(get<uint16_t>(p), 1);
+  _firstSeq      = get<uint32_t>(p);
+
+  // Without index, seeking reads the records from the start
+  _index = _fs.open(getIndexPath(path), "r");
+  return true;
+}
+
+void BinaryLog::Reader::close() {
+  _data.close();
+  _index.close();
+}
+
+bool BinaryLog::Reader::seek(uint32_t seq) {
+  size_t entries = _index ? _index.size() / INDEX_SIZE : 0;
+  size_t offset  = HEADER_SIZE;
+  if (seq > _firstSeq && entries > 0) {
+    IndexEntry entry;
+    if (readIndex(std::min<size_t>((seq - _firstSeq) / _indexInterval, entries - 1), entry) && entry.seq <= seq) {
+      offset = entry.offset;
+    }
+  }
+  if (!_data.seek(offset)) {
+    return false;
+  }
+
+  // Less than indexInterval records to skip
+  Record record;
+  for (;;) {
+    size_t position = _data.position();
+    if (!readRecord(_data, record)) {
+      return false;
+    }
+    if (record.seq >= seq) {
+      return _data.seek(position);
+    }
+  }
+}
+
+bool BinaryLog::Reader::seekTime(uint32_t rxTime) {
+  // Last entry received before rxTime
+  size_t     entries = _index ? _index.size() / INDEX_SIZE : 0;
+  size_t     low     = 0;
+  size_t     high    = entries;
+  size_t     offset  = HEADER_SIZE;
+  IndexEntry entry;
+  while (low < high) {
+    size_t middle = (low + high) / 2;
+    if (!readIndex(middle, entry)) {
+      return false;
+    }
+    if (entry.rxTime < rxTime) {
+      offset = entry.offset;
+      low    = middle + 1;
+    } else {
+      high = middle;
+    }
+  }
+  if (!_data.seek(offset)) {
+    return false;
+  }
+
+  Record record;
+  for (;;) {
+    size_t position = _data.position();
+    if (!readRecord(_data, record)) {
+      return false;
+    }
+    if (record.rxTime >= rxTime) {
+      return _data.seek(position);
+    }
+  }
+}
+
+bool BinaryLog::Reader::next(Record &record) {
+  return readRecord(_data, record);
+}
+
+uint32_t BinaryLog::Reader::getFirstSeq() const {
+  return _firstSeq;
+}
+
+bool BinaryLog::Reader::readIndex(size_t position, IndexEntry &entry) {
+  uint8_t buffer[INDEX_SIZE];
+  if (!_index.seek(position * INDEX_SIZE) || _index.read(buffer, INDEX_SIZE) != INDEX_SIZE) {
+    return false;
+  }
+  const uint8_t *p = buffer;
+  entry.seq        = get<uint32_t>(p);
+  entry.rxTime     = get<uint32_t>(p);
+  entry.offset     = get<uint32_t>(p);
+  return true;
+}
@@ -0,0 +1,176 @@
+#ifndef BINARY_LOG_H_
+#define BINARY_LOG_H_
+
+#include <Arduino.h>
+#include <FS.h>
+
+/**
+ * @brief Binary packet log made of length-prefixed records, with a sparse index to seek by sequence number or time.
+ *
+ * The log file starts with a fixed header (magic, version, index interval, sequence number of its first record), followed by
+ * the records:
+ *
+ *   uint16 length | uint32 seq | uint32 rxTime | float rssi | float snr | float freqError | uint8 flags | frame (TNC2 text)
+ *
+ * where length is the size of everything after it. Every field is little endian. Sequence numbers are consecutive and keep
+ * increasing across rotations.
+ *
+ * The index is a separate file ("<log>.idx") with one entry (seq, rxTime, offset) every indexInterval records, entry k being the
+ * record firstSeq + k * indexInterval. Seeking to a sequence number reads one index entry and skips less than indexInterval
+ * records; seeking to a time does a binary search on the index.
+ *
+ * Records are written through a RAM buffer, see flush(). Not thread safe.
+ */
+class BinaryLog {
+public:
+  static constexpr size_t MAX_FRAME = 255; // Largest LoRa payload
+
+  struct Record {
+    uint32_t seq;
+    uint32_t rxTime;    // UNIX time
+    float    rssi;      // dBm
+    float    snr;       // dB
+    float    freqError; // Hz
+    bool     crcOk;
+    uint8_t  frameLength;
+    char     frame[MAX_FRAME + 1]; // NUL terminated, empty if the CRC is wrong
+  };
+
+  /**
+   * @brief Sequential reader of a log file, independent from the writer.
+   */
+  class Reader {
+  public:
+    explicit Reader(fs::FS &fs);
+    ~Reader();
+
+    /**
+     * @brief     Opens a log file and places the cursor on its first record.
+     */
+    bool open(const String &path);
+    void close();
+
+    /**
+     * @brief     Places the cursor on the first record whose sequence number is not lower than seq.
+     */
+    bool seek(uint32_t seq);
+
+    /**
+     * @brief     Places the cursor on the first record received at or after rxTime, assuming the times are increasing.
+     */
+    bool seekTime(uint32_t rxTime);
+
+    /**
+     * @brief     Reads the record under the cursor and moves the cursor after it.
+     *
+     * @return    false at the end of the file or on a truncated record.
+     */
+    bool next(Record &record);
+
+    uint32_t getFirstSeq() const;
+
+  private:
+    friend class BinaryLog;
+
+    struct IndexEntry {
+      uint32_t seq;
+      uint32_t rxTime;
+      uint32_t offset;
+    };
+
+    bool readIndex(size_t position, IndexEntry &entry);
+
+    fs::FS  &_fs;
+    File     _data;
+    File     _index;
+    uint32_t _firstSeq;
+    uint16_t _indexInterval;
+  };
+
+  /**
+   * @param[in] indexInterval Number of records between two index entries.
+   *
+   * @param[in] bufferSize Size (in bytes) of the write buffer.
+   */
+  BinaryLog(fs::FS &fs, uint16_t indexInterval, size_t bufferSize);
+  ~BinaryLog();
+
+  /**
+   * @brief     Creates an empty log, replacing any existing one.
+   */
+  bool create(const String &path, uint32_t firstSeq);
+
+  /**
+   * @brief     Opens an existing log to append to it. The sequence number of the next record is recovered from the last index
+   *            entry, and the index is rebuilt if it does not match the records.
+   *
+   * @return    false if the file is missing or damaged (bad header, truncated last record). getNextSeq() then follows the
+   *            last readable record, or the first sequence number of the header if there is none.
+   */
+  bool open(const String &path);
+
+  /**
+   * @brief     Writes the buffer and closes the files.
+   */
+  void close();
+
+  /**
+   * @brief     Adds a record to the buffer. Its sequence number is set to getNextSeq(). The buffer is written first if full.
+   */
+  bool append(Record &record);
+
+  /**
+   * @brief     Writes the buffered records, then their index entries.
+   */
+  bool flush();
+
+  size_t   getBuffered() const;
+  uint32_t getFirstSeq() const;
+  uint32_t getNextSeq() const;
+
+  /**
+   * @brief     Number of records in the log.
+   */
+  uint32_t getCount() const;
+
+  static String getIndexPath(const String &path);
+
+  /**
+   * @brief     Finds the sequence number following the last readable record of a log, whether its header is valid or not.
+   *
+   * @return    false if the log holds no readable record.
+   */
+  static bool findNextSeq(fs::FS &fs, const String &path, uint32_t *nextSeq);
+
+  /**
+   * @brief     Formats a record as a line of the TSV packet log (numbered with its sequence number). Returns the length written.
+   */
+  static size_t toTsv(const Record &record, char *buffer, size_t size);
+
+private:
+  static constexpr uint32_t MAGIC       = 0x474F4C50; // "PLOG"
+  static constexpr uint16_t VERSION     = 1;
+  static constexpr size_t   HEADER_SIZE = 16;
+  static constexpr size_t   FIXED_SIZE  = 2 + 21; // Length and fixed fields of a record
+  static constexpr size_t   INDEX_SIZE  = 12;
+  static constexpr size_t   MAX_PENDING = 16; // Index entries waiting for the next flush
+
+  static bool readRecord(File &file, Record &record);
+  bool        rebuildIndex(const String &path);
+
+  fs::FS        &_fs;
+  const uint16_t _indexInterval;
+  uint8_t       *_buffer;
+  const size_t   _bufferSize;
+  size_t         _buffered;
+  File           _data;
+  File           _index;
+  uint32_t       _firstSeq;
+  uint32_t       _nextSeq;
+  uint32_t       _size; // Of the data file, including the buffer
+
+  uint8_t _pending[MAX_PENDING * INDEX_SIZE];
+  size_t  _nbPending;
+};
+
+#endif
@@ -23,7 +23,7 @@ void ConfigurationManagement::readConfiguration(Configuration &conf) {
     APP_LOGE(MODULE_NAME, "Failed to open file for reading, using default configuration.");
     return;
   }
-  DynamicJsonDocument  data(2048);
+  DynamicJsonDocument  data(4096);
   DeserializationError error = deserializeJson(data, file);
   if (error) {
     APP_LOGW(MODULE_NAME, "Failed to read file, using default configuration.");
@@ -44,7 +44,7 @@ void ConfigurationManagement::writeConfiguration(Configuration &conf) {
     APP_LOGE(MODULE_NAME, "Failed to open file for writing...");
     return;
   }
-  DynamicJsonDocument data(2048);
+  DynamicJsonDocument data(4096);
 
   writeProjectConfiguration(conf, data);
 
@@ -0,0 +1,173 @@
+#include "DigiPath.h"
+
+DigiPath::DigiPath() : _nbHops(0), _lastUsed(-1) {
+}
+
+bool DigiPath::parse(const char *path) {
+  _nbHops   = 0;
+  _lastUsed = -1;
+
+  const char *p = path;
+  while (*p != '\0') {
+    if (_nbHops >= MAX_HOPS) {
+      return false;
+    }
+
+    size_t length = 0;
+    while (p[length] != '\0' && p[length] != ',') {
+      length++;
+    }
+    const char *next = (p[length] == ',') ? p + length + 1 : p + length;
+
+    if (length > 0 && p[length - 1] == '*') {
+      length--;
+      _lastUsed = _nbHops;
+    }
+    if (length == 0 || length >= HOP_SIZE) {
+      return false;
+    }
+
+    memcpy(_hops[_nbHops], p, length);
+    _hops[_nbHops][length] = '\0';
+    _nbHops++;
+    p = next;
+  }
+  return true;
+}
+
+DigiPath::Result DigiPath::process(const Rules &rules) {
+  for (int i = 0; i <= _lastUsed; i++) {
+    if (strcmp(_hops[i], rules.callsign) == 0) {
+      return Loop;
+    }
+  }
+
+  size_t index = _lastUsed + 1;
+  if (index >= _nbHops) {
+    return NotForUs;
+  }
+
+  const char *hop = _hops[index];
+  if (strcmp(hop, rules.callsign) == 0) {
+    _lastUsed = index;
+    return Digipeat;
+  }
+
+  bool        trace;
+  const char *p;
+  if (strncmp(hop, "WIDE", 4) == 0) {
+    trace = false;
+    p     = hop + 4;
+  } else if (strncmp(hop, "TRACE", 5) == 0) {
+    trace = true;
+    p     = hop + 5;
+  } else {
+    return NotForUs;
+  }
+
+  // n is the number of hops asked for, N the number of hops remaining
+  if (*p < '1' || *p > '7' || p[1] != '-') {
+    return NotForUs;
+  }
+  if (p[2] < '1' || p[2] > '9' || p[3] != '\0') {
+    return NotForUs;
+  }
+  unsigned int n         = p[0] - '0';
+  unsigned int remaining = p[2] - '0';
+  if (remaining > n) {
+    return Invalid;
+  }
+
+  if (rules.fillIn && (trace || n != 1)) {
+    return NotForUs;
+  }
+  if (n > rules.maxHops) {
+    return TooManyHops;
+  }
+
+  bool insertCallsign = trace || rules.traceWide;
+  if (insertCallsign && _nbHops >= MAX_HOPS) {
+    return PathFull;
+  }
+  if (strlen(rules.callsign) >= HOP_SIZE) {
+    return Invalid;
+  }
+
+  remaining--;
+  // n and N are single digits, written as characters so that the longest hop ("TRACE7-6") provably fits in HOP_SIZE
+  const char *prefix      = trace ? "TRACE" : "WIDE";
+  char        nDigit      = '0' + n;
+  char        remainDigit = '0' + remaining;
+  if (remaining == 0) {
+    snprintf(_hops[index], HOP_SIZE, "%s%c", prefix, nDigit);
+  } else {
+    snprintf(_hops[index], HOP_SIZE, "%s%c-%c", prefix, nDigit, remainDigit);
+  }
+
+  if (insertCallsign) {
+    insert(index, rules.callsign);
+    _lastUsed = index;
+    index++;
+  }
+  if (remaining == 0) {
+    _lastUsed = index;
+  }
+  return Digipeat;
+}
+
+size_t DigiPath::format(char *buffer, size_t size) const {
+  size_t length = 0;
+  for (size_t i = 0; i < _nbHops; i++) {
+    int written = snprintf(buffer + length, size - length, "%s%s%s", (i > 0) ? "," : "", _hops[i], ((int)i == _lastUsed) ? "*" : "");
+    if (written < 0 || (size_t)written >= size - length) {
+      return 0;
+    }
+    length += written;
+  }
+  if (_nbHops == 0) {
+    if (size == 0) {
+      return 0;
+    }
+    buffer[0] = '\0';
+  }
+  return length;
+}
+
+const char *DigiPath::getLastDigipeater() const {
+  for (int i = _lastUsed; i >= 0; i--) {
+    const char *hop = _hops[i];
+    if (strncmp(hop, "WIDE", 4) != 0 && strncmp(hop, "TRACE", 5) != 0 && strncmp(hop, "RELAY", 5) != 0) {
+      return hop;
+    }
+  }
+  return NULL;
+}
+
+const char *DigiPath::toString(Result result) {
+  switch (result) {
+  case Digipeat:
+    return "digipeat";
+  case NotForUs:
+    return "not for us";
+  case Loop:
+    return "loop";
+  case TooManyHops:
+    return "too many hops";
+  case PathFull:
+    return "path full";
+  case Invalid:
+  default:
+    return "invalid path";
+  }
+}
+
+bool DigiPath::insert(size_t index, const char *call) {
+  if (_nbHops >= MAX_HOPS || index > _nbHops) {
+    return false;
+  }
+  memmove(_hops[index + 1], _hops[index], (_nbHops - index) * HOP_SIZE);
+  strncpy(_hops[index], call, HOP_SIZE - 1);
+  _hops[index][HOP_SIZE - 1] = '\0';
+  _nbHops++;
+  return true;
+}
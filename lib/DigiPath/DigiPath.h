@@ -0,0 +1,89 @@
+#ifndef DIGI_PATH_H_
+#define DIGI_PATH_H_
+
+#include <Arduino.h>
+
+/**
+ * @brief Digipeater path of a packet, parsed once into a fixed array of hops and rewritten in place.
+ *
+ * The path is in TNC2 format: hops separated by ',', the last hop already digipeated is followed by '*' and every hop before it
+ * is considered used. The first unused hop decides whether we digipeat:
+ *  - our own callsign: the hop is marked used;
+ *  - WIDEn-N / TRACEn-N: our callsign is inserted before it (always for TRACE, only with Rules::traceWide for WIDE) and N is
+ *    decremented. When N reaches 0 the alias is marked used and shown without SSID;
+ *  - anything else: the packet is not for us.
+ * Packets already digipeated by us are refused (loop), as are aliases asking for more than Rules::maxHops hops. In fill-in mode
+ * only WIDE1-1 is handled.
+ *
+ * Transformations with callsign "DIGI", maxHops 2, traceWide true, fillIn false:
+ *
+ *   WIDE1-1                 -> DIGI,WIDE1*
+ *   WIDE2-2                 -> DIGI*,WIDE2-1
+ *   WIDE1-1,WIDE2-1         -> DIGI,WIDE1*,WIDE2-1
+ *   OTHER*,WIDE2-1          -> OTHER,DIGI,WIDE2*
+ *   TRACE2-2                -> DIGI*,TRACE2-1
+ *   DIGI                    -> DIGI*
+ *   OTHER,DIGI              -> not for us (OTHER must digipeat first)
+ *   DIGI*,WIDE2-1           -> loop
+ *   WIDE3-3                 -> too many hops
+ *   WIDE2-3                 -> invalid path
+ *   WIDE1*                  -> not for us (no unused hop)
+ *   RFONLY                  -> not for us
+ *
+ * With traceWide false: WIDE2-2 -> WIDE2-1 and WIDE1-1 -> WIDE1*. With fillIn true: WIDE2-2 -> not for us.
+ */
+class DigiPath {
+public:
+  static constexpr size_t MAX_HOPS = 8;  // Maximum number of digipeaters of an AX.25 frame
+  static constexpr size_t HOP_SIZE = 10; // "CALL10-15" and the terminating NUL
+
+  struct Rules {
+    const char *callsign;
+    uint8_t     maxHops;   // Highest n accepted in WIDEn-N and TRACEn-N
+    bool        fillIn;    // Only handle WIDE1-1
+    bool        traceWide; // Insert our callsign when handling WIDEn-N
+  };
+
+  enum Result {
+    Digipeat,
+    NotForUs,
+    Loop,
+    TooManyHops,
+    PathFull,
+    Invalid,
+  };
+
+  DigiPath();
+
+  /**
+   * @brief     Parses a TNC2 path. Returns false if it has too many hops or a hop is too long.
+   */
+  bool parse(const char *path);
+
+  /**
+   * @brief     Applies the rules to the path. The path is only modified if the result is Digipeat.
+   */
+  Result process(const Rules &rules);
+
+  /**
+   * @brief     Writes the path in TNC2 format. Returns the length written, 0 if the buffer is too small.
+   */
+  size_t format(char *buffer, size_t size) const;
+
+  /**
+   * @brief     Callsign of the last digipeater the packet went through, NULL if it was heard directly or if the digipeaters
+   *            only decremented aliases without inserting their callsign.
+   */
+  const char *getLastDigipeater() const;
+
+  static const char *toString(Result result);
+
+private:
+  bool insert(size_t index, const char *call);
+
+  char   _hops[MAX_HOPS][HOP_SIZE];
+  size_t _nbHops;
+  int    _lastUsed; // Index of the last used hop, -1 if none
+};
+
+#endif
@@ -0,0 +1,63 @@
+#include "DupeCache.h"
+
+#include <Fnv1a.h>
+
+DupeCache::DupeCache(size_t size, uint32_t window_ms) : _size(size), _entries(new Entry[size]), _next(0), _window(window_ms), _hits(0), _misses(0), _earlyEvictions(0) {
+  for (size_t i = 0; i < _size; i++) {
+    _entries[i].used = false;
+  }
+}
+
+DupeCache::~DupeCache() {
+  delete[] _entries;
+}
+
+uint32_t DupeCache::hash(const String &source, const String &destination, const String &body) {
+  size_t bodyLength = body.length();
+  while (bodyLength > 0 && body[bodyLength - 1] == ' ') {
+    bodyLength--;
+  }
+
+  // Separators make sure that "AB>C" and "A>BC" do not hash the same
+  uint32_t h = fnv1a(source.c_str(), source.length());
+  h          = fnv1a(">", 1, h);
+  h          = fnv1a(destination.c_str(), destination.length(), h);
+  h          = fnv1a(":", 1, h);
+  return fnv1a(body.c_str(), bodyLength, h);
+}
+
+bool DupeCache::check(uint32_t hash, uint32_t now_ms) {
+  for (size_t i = 0; i < _size; i++) {
+    const Entry &entry = _entries[i];
+    if (entry.used && entry.hash == hash && (now_ms - entry.time) < _window) {
+      _hits++;
+      return true;
+    }
+  }
+
+  if (_entries[_next].used && (now_ms - _entries[_next].time) < _window) {
+    _earlyEvictions++;
+  }
+  _entries[_next].hash = hash;
+  _entries[_next].time = now_ms;
+  _entries[_next].used = true;
+  _next                = (_next + 1) % _size;
+  _misses++;
+  return false;
+}
+
+size_t DupeCache::getSize() const {
+  return _size;
+}
+
+uint32_t DupeCache::getHits() const {
+  return _hits;
+}
+
+uint32_t DupeCache::getMisses() const {
+  return _misses;
+}
+
+uint32_t DupeCache::getEarlyEvictions() const {
+  return _earlyEvictions;
+}
@@ -0,0 +1,65 @@
+#ifndef DUPE_CACHE_H_
+#define DUPE_CACHE_H_
+
+#include <Arduino.h>
+
+/**
+ * @brief Fixed-memory cache of the packets seen recently, used to drop duplicates.
+ *
+ * Packets are identified by a hash of their source, destination and body (the path is ignored since the same packet heard
+ * through another digipeater has a different path). Entries are stored in a ring so the oldest one is always the one replaced.
+ * The ring must hold every packet received during the window, replacing an entry younger than the window is counted as an early
+ * eviction.
+ */
+class DupeCache {
+public:
+  /**
+   * @param[in] size Number of packets remembered.
+   *
+   * @param[in] window_ms Time (in ms) during which an identical packet is considered a duplicate.
+   */
+  DupeCache(size_t size, uint32_t window_ms);
+  ~DupeCache();
+
+  /**
+   * @brief     Computes the FNV-1a hash identifying a packet. Trailing spaces of the body are ignored.
+   */
+  static uint32_t hash(const String &source, const String &destination, const String &body);
+
+  /**
+   * @brief     Checks if a packet was seen during the window and remembers it.
+   *
+   * @param[in] hash Hash of the packet, as returned by hash().
+   *
+   * @param[in] now_ms Current time in ms.
+   *
+   * @return    true if the packet is a duplicate, false if it is the first time it is seen during the window.
+   */
+  bool check(uint32_t hash, uint32_t now_ms);
+
+  size_t   getSize() const;
+  uint32_t getHits() const;
+  uint32_t getMisses() const;
+
+  /**
+   * @brief     Entries replaced before the end of their window: a duplicate of these packets would not be detected.
+   */
+  uint32_t getEarlyEvictions() const;
+
+private:
+  struct Entry {
+    uint32_t hash;
+    uint32_t time;
+    bool     used;
+  };
+
+  const size_t _size;
+  Entry       *_entries;
+  size_t       _next;
+  uint32_t     _window;
+  uint32_t     _hits;
+  uint32_t     _misses;
+  uint32_t     _earlyEvictions;
+};
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef FNV1A_H_
+#define FNV1A_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define FNV1A_OFFSET_BASIS 2166136261u
+#define FNV1A_PRIME        16777619u
+
+/**
+ * @brief     32 bits FNV-1a hash of a buffer. Several buffers are hashed as one by passing the hash of the previous ones.
+ *
+ * @param[in] hash Hash of the data preceding the buffer, FNV1A_OFFSET_BASIS for the first one.
+ */
+inline uint32_t fnv1a(const char *data, size_t length, uint32_t hash = FNV1A_OFFSET_BASIS) {
+  for (size_t i = 0; i < length; i++) {
+    hash ^= (uint8_t)data[i];
+    hash *= FNV1A_PRIME;
+  }
+  return hash;
+}
+
+#endif
@@ -0,0 +1,149 @@
+#include "PacketBus.h"
+
+const char *PacketBus::Subscriber::getName() const {
+  return _name;
+}
+
+uint32_t PacketBus::Subscriber::getLag() const {
+  return _lag;
+}
+
+uint32_t PacketBus::Subscriber::getReceivedCount() const {
+  return _received;
+}
+
+uint32_t PacketBus::Subscriber::getDropCount() const {
+  return _dropped;
+}
+
+PacketBus::PacketBus(size_t capacity) : _capacity(1), _entries(NULL), _write(0), _nbSubscribers(0) {
+  portMUX_INITIALIZE(&_lock);
+  while (_capacity < capacity) {
+    _capacity <<= 1;
+  }
+  _entries = new Entry[_capacity];
+  for (size_t i = 0; i < _capacity; i++) {
+    _entries[i].packet = NULL;
+    _entries[i].topics = 0;
+  }
+}
+
+PacketBus::~PacketBus() {
+  for (size_t i = 0; i < _nbSubscribers; i++) {
+    vSemaphoreDelete(_subscribers[i]._signal);
+  }
+  delete[] _entries;
+}
+
+PacketBus::Subscriber *PacketBus::subscribe(const char *name, uint32_t topics) {
+  SemaphoreHandle_t signal = xSemaphoreCreateBinary();
+  if (signal == NULL) {
+    return NULL;
+  }
+
+  Subscriber *subscriber = NULL;
+  portENTER_CRITICAL(&_lock);
+  if (_nbSubscribers < MAX_SUBSCRIBERS) {
+    subscriber            = &_subscribers[_nbSubscribers];
+    subscriber->_name     = name;
+    subscriber->_topics   = topics;
+    subscriber->_cursor   = _write;
+    subscriber->_lag      = 0;
+    subscriber->_received = 0;
+    subscriber->_dropped  = 0;
+    subscriber->_signal   = signal;
+    _nbSubscribers++;
+  }
+  portEXIT_CRITICAL(&_lock);
+
+  if (subscriber == NULL) {
+    vSemaphoreDelete(signal);
+  }
+  return subscriber;
+}
+
+void PacketBus::publish(Packet *packet, uint32_t topics) {
+  uint32_t toSignal = 0; // Bitmask of the subscribers to wake up
+  Packet  *dropped  = NULL;
+  uint32_t nbDrops  = 0;
+
+  portENTER_CRITICAL(&_lock);
+  Entry &entry = _entries[_write & (_capacity - 1)];
+
+  // Subscribers that still have not read the entry we are about to overwrite lose it
+  for (size_t i = 0; i < _nbSubscribers; i++) {
+    Subscriber &sub = _subscribers[i];
+    if (_write - sub._cursor >= _capacity) {
+      if (entry.topics & sub._topics) {
+        sub._dropped++;
+        sub._lag--;
+        nbDrops++;
+      }
+      sub._cursor++;
+    }
+  }
+  dropped = entry.packet;
+
+  entry.packet = packet;
+  entry.topics = topics;
+  for (size_t i = 0; i < _nbSubscribers; i++) {
+    Subscriber &sub = _subscribers[i];
+    if (topics & sub._topics) {
+      packet->retain();
+      sub._lag++;
+      toSignal |= (1 << i);
+    }
+  }
+  _write++;
+  portEXIT_CRITICAL(&_lock);
+
+  // Releasing a packet may give it back to the pool, which cannot be done from a critical section
+  for (uint32_t i = 0; i < nbDrops; i++) {
+    dropped->release();
+  }
+  for (size_t i = 0; i < _nbSubscribers; i++) {
+    if (toSignal & (1 << i)) {
+      xSemaphoreGive(_subscribers[i]._signal);
+    }
+  }
+}
+
+Packet *PacketBus::receive(Subscriber *subscriber, TickType_t timeout, uint32_t *topics) {
+  for (;;) {
+    Packet  *packet      = NULL;
+    uint32_t entryTopics = 0;
+
+    portENTER_CRITICAL(&_lock);
+    while (subscriber->_cursor != _write) {
+      const Entry &entry = _entries[subscriber->_cursor & (_capacity - 1)];
+      subscriber->_cursor++;
+      if (entry.topics & subscriber->_topics) {
+        packet      = entry.packet;
+        entryTopics = entry.topics;
+        subscriber->_lag--;
+        subscriber->_received++;
+        break;
+      }
+    }
+    portEXIT_CRITICAL(&_lock);
+
+    if (packet != NULL) {
+      if (topics != NULL) {
+        *topics = entryTopics;
+      }
+      return packet;
+    }
+
+    if (xSemaphoreTake(subscriber->_signal, timeout) != pdTRUE) {
+      return NULL;
+    }
+  }
+}
+
+size_t PacketBus::getSubscriberCount() const {
+  return _nbSubscribers;
+}
+
+const PacketBus::Subscriber *PacketBus::getSubscriber(size_t index) const {
+  return (index < _nbSubscribers) ? &_subscribers[index] : NULL;
+}
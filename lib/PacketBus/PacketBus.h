@@ -0,0 +1,105 @@
+#ifndef PACKET_BUS_H_
+#define PACKET_BUS_H_
+
+#include <Arduino.h>
+#include <PacketPool.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+/**
+ * @brief Broadcast ring buffer of packets with one write cursor and one read cursor per subscriber.
+ *
+ * Producers never block: when a subscriber is too slow the oldest entries it has not read yet are overwritten, which only drops
+ * that subscriber's backlog. Each entry is tagged with topics and every subscriber only receives the topics it subscribed to.
+ *
+ * On publish, the bus takes one reference on the packet per interested subscriber. receive() hands that reference over to the
+ * caller, which must release() the packet when done with it.
+ */
+class PacketBus {
+public:
+  enum Topic : uint32_t {
+    RfReceived = 1 << 0, // Valid frame received by the modem
+    RfCorrupt  = 1 << 1, // Frame received with a CRC error, only the reception metrics are valid
+    ToAprsIs   = 1 << 2, // Packet to upload to APRS-IS
+    IpBeacon   = 1 << 3, // Beacon sent to APRS-IS
+    RfBeacon   = 1 << 4, // Beacon sent on RF
+  };
+
+  class Subscriber {
+  public:
+    const char *getName() const;
+
+    /**
+     * @brief Number of entries published for this subscriber that it has not read yet.
+     */
+    uint32_t getLag() const;
+    uint32_t getReceivedCount() const;
+    uint32_t getDropCount() const;
+
+  private:
+    friend class PacketBus;
+
+    const char       *_name;
+    uint32_t          _topics;
+    uint32_t          _cursor;
+    uint32_t          _lag;
+    uint32_t          _received;
+    uint32_t          _dropped;
+    SemaphoreHandle_t _signal;
+  };
+
+  static constexpr size_t MAX_SUBSCRIBERS = 8;
+
+  /**
+   * @param[in] capacity Number of entries of the ring, rounded up to a power of two.
+   */
+  explicit PacketBus(size_t capacity);
+  ~PacketBus();
+
+  /**
+   * @brief     Registers a new subscriber. It will receive the packets published from now on.
+   *
+   * @param[in] name Name used when reporting statistics.
+   *
+   * @param[in] topics Bitmask of the Topic values to receive.
+   *
+   * @return    Subscriber*: the subscriber to pass to receive(), NULL if there are too many subscribers.
+   */
+  Subscriber *subscribe(const char *name, uint32_t topics);
+
+  /**
+   * @brief     Publishes a packet. Never blocks. The caller keeps its own reference.
+   */
+  void publish(Packet *packet, uint32_t topics);
+
+  /**
+   * @brief     Waits for the next packet of a subscriber.
+   *
+   * @param[in] subscriber The subscriber returned by subscribe().
+   *
+   * @param[in] timeout Maximum number of ticks to wait.
+   *
+   * @param[out] topics If not NULL, receives the topics the packet was published with.
+   *
+   * @return    Packet*: a packet holding one reference for the caller, or NULL on timeout.
+   */
+  Packet *receive(Subscriber *subscriber, TickType_t timeout, uint32_t *topics = NULL);
+
+  size_t            getSubscriberCount() const;
+  const Subscriber *getSubscriber(size_t index) const;
+
+private:
+  struct Entry {
+    Packet  *packet;
+    uint32_t topics;
+  };
+
+  size_t       _capacity;
+  Entry       *_entries;
+  uint32_t     _write;
+  Subscriber   _subscribers[MAX_SUBSCRIBERS];
+  size_t       _nbSubscribers;
+  portMUX_TYPE _lock;
+};
+
+#endif
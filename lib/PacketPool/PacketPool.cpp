@@ -0,0 +1,72 @@
+#include "PacketPool.h"
+
+Packet::Packet() : origin(Local), rx(), _pool(NULL), _refCount(0) {
+}
+
+void Packet::retain() {
+  _refCount.fetch_add(1);
+}
+
+void Packet::release() {
+  if (_refCount.fetch_sub(1) == 1) {
+    _pool->put(this);
+  }
+}
+
+PacketPool::PacketPool(size_t size) : _size(size), _packets(new Packet[size]), _free(xQueueCreate(size, sizeof(Packet *))), _inUse(0), _highWater(0), _acquireCount(0), _exhaustedCount(0) {
+  for (size_t i = 0; i < _size; i++) {
+    Packet *packet = &_packets[i];
+    packet->_pool  = this;
+    xQueueSend(_free, &packet, 0);
+  }
+}
+
+PacketPool::~PacketPool() {
+  vQueueDelete(_free);
+  delete[] _packets;
+}
+
+Packet *PacketPool::acquire() {
+  Packet *packet;
+  if (xQueueReceive(_free, &packet, 0) != pdTRUE) {
+    _exhaustedCount++;
+    return NULL;
+  }
+
+  packet->_refCount = 1;
+  packet->origin    = Packet::Local;
+  packet->rx        = RxMetadata();
+
+  uint32_t inUse = ++_inUse;
+  uint32_t high  = _highWater;
+  while (inUse > high && !_highWater.compare_exchange_weak(high, inUse)) {
+  }
+  _acquireCount++;
+
+  return packet;
+}
+
+void PacketPool::put(Packet *packet) {
+  _inUse--;
+  xQueueSend(_free, &packet, 0);
+}
+
+size_t PacketPool::getSize() const {
+  return _size;
+}
+
+size_t PacketPool::getInUse() const {
+  return _inUse;
+}
+
+size_t PacketPool::getHighWater() const {
+  return _highWater;
+}
+
+uint32_t PacketPool::getAcquireCount() const {
+  return _acquireCount;
+}
+
+uint32_t PacketPool::getExhaustedCount() const {
+  return _exhaustedCount;
+}
@@ -0,0 +1,101 @@
+#ifndef PACKET_POOL_H_
+#define PACKET_POOL_H_
+
+#include <APRSMessage.h>
+#include <Arduino.h>
+#include <atomic>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+
+class PacketPool;
+
+/**
+ * @brief Reception metrics of a frame, read once from the modem after its RX interrupt and shared by every consumer.
+ */
+struct RxMetadata {
+  int64_t irqTime;         // esp_timer_get_time() value (us) when the RX interrupt fired, 0 if not received
+  time_t  rxTime;          // Wall-clock time of the reception
+  float   rssi;            // dBm
+  float   snr;             // dB
+  float   freqError;       // Hz
+  uint8_t spreadingFactor; // 0 if not received
+  bool    crcOk;
+};
+
+/**
+ * @brief A packet slot of the PacketPool.
+ *
+ * A packet is shared between the tasks by reference: every task that keeps a pointer to it (including the queues it is sent
+ * through) owns one reference. The last one to call release() gives the slot back to the pool.
+ */
+class Packet {
+public:
+  enum Origin {
+    RF,     // Received by the modem
+    Local,  // Generated by the iGate itself (beacon, digipeated frame...)
+    Replay, // Injected by ReplayTask, never gated nor transmitted (published to MQTT and logged)
+  };
+
+  Packet();
+
+  APRSMessage msg;
+  Origin      origin;
+  RxMetadata  rx; // Only valid if origin is RF
+
+  /**
+   * @brief Takes one more reference on the packet.
+   */
+  void retain();
+
+  /**
+   * @brief Drops one reference. The packet must not be used by the caller afterwards.
+   */
+  void release();
+
+private:
+  friend class PacketPool;
+
+  PacketPool           *_pool;
+  std::atomic<uint32_t> _refCount;
+};
+
+/**
+ * @brief Fixed-size set of packets allocated once at boot.
+ *
+ * The Strings of the messages keep their buffers between uses so that, once the pool is warm, a received frame does not cause
+ * any heap allocation.
+ */
+class PacketPool {
+public:
+  explicit PacketPool(size_t size);
+  ~PacketPool();
+
+  /**
+   * @brief     Takes a free packet from the pool.
+   *
+   * @return    Packet*: a packet holding one reference, or NULL if the pool is exhausted.
+   */
+  Packet *acquire();
+
+  size_t   getSize() const;
+  size_t   getInUse() const;
+  size_t   getHighWater() const;
+  uint32_t getAcquireCount() const;
+  uint32_t getExhaustedCount() const;
+
+private:
+  friend class Packet;
+
+  void put(Packet *packet);
+
+  const size_t  _size;
+  Packet       *_packets;
+  QueueHandle_t _free;
+
+  std::atomic<uint32_t> _inUse;
+  std::atomic<uint32_t> _highWater;
+  std::atomic<uint32_t> _acquireCount;
+  std::atomic<uint32_t> _exhaustedCount;
+};
+
+#endif
@@ -0,0 +1,83 @@
+#include "RecordRing.h"
+
+#define HEADER_SIZE 2 // Record length, little endian
+
+RecordRing::RecordRing(size_t size) : _data(new uint8_t[size]), _size(size), _head(0), _used(0), _count(0) {
+}
+
+RecordRing::~RecordRing() {
+  delete[] _data;
+}
+
+bool RecordRing::push(const char *data, size_t length) {
+  if (!hasRoom(length)) {
+    return false;
+  }
+
+  uint8_t header[HEADER_SIZE] = {(uint8_t)(length & 0xFF), (uint8_t)(length >> 8)};
+  size_t  tail                = (_head + _used) % _size;
+  write(tail, header, HEADER_SIZE);
+  write((tail + HEADER_SIZE) % _size, (const uint8_t *)data, length);
+  _used += HEADER_SIZE + length;
+  _count++;
+  return true;
+}
+
+bool RecordRing::hasRoom(size_t length) const {
+  return length <= 0xFFFF && HEADER_SIZE + length <= _size - _used;
+}
+
+size_t RecordRing::peek(char *buffer, size_t size) const {
+  if (_count == 0 || size == 0) {
+    return 0;
+  }
+
+  uint8_t header[HEADER_SIZE];
+  read(_head, header, HEADER_SIZE);
+  size_t length = header[0] | (header[1] << 8);
+  size_t copied = std::min(length, size - 1);
+  read((_head + HEADER_SIZE) % _size, (uint8_t *)buffer, copied);
+  buffer[copied] = '\0';
+  return length;
+}
+
+void RecordRing::pop() {
+  if (_count == 0) {
+    return;
+  }
+
+  uint8_t header[HEADER_SIZE];
+  read(_head, header, HEADER_SIZE);
+  size_t record = HEADER_SIZE + (header[0] | (header[1] << 8));
+  _head         = (_head + record) % _size;
+  _used -= record;
+  _count--;
+}
+
+bool RecordRing::isEmpty() const {
+  return _count == 0;
+}
+
+size_t RecordRing::getCount() const {
+  return _count;
+}
+
+size_t RecordRing::getUsed() const {
+  return _used;
+}
+
+size_t RecordRing::getSize() const {
+  return _size;
+}
+
+void RecordRing::write(size_t offset, const uint8_t *data, size_t length) {
+  size_t first = std::min(length, _size - offset);
+  memcpy(_data + offset, data, first);
+  memcpy(_data, data + first, length - first);
+}
+
+void RecordRing::read(size_t offset, uint8_t *data, size_t length) const {
+  size_t first = std::min(length, _size - offset);
+  memcpy(data, _data + offset, first);
+  memcpy(data + first, _data, length - first);
+}
@@ -0,0 +1,64 @@
+#ifndef RECORD_RING_H_
+#define RECORD_RING_H_
+
+#include <Arduino.h>
+
+/**
+ * @brief FIFO of variable length records stored in a fixed-size byte ring, allocated once.
+ *
+ * Each record is stored as its length (2 bytes) followed by its data, and may wrap around the end of the buffer. Nothing is ever
+ * overwritten: push() fails when there is not enough room, and the caller decides whether to drop or move the oldest records.
+ *
+ * Not thread safe, meant to be used by a single task.
+ */
+class RecordRing {
+public:
+  /**
+   * @param[in] size Size (in bytes) of the buffer, including 2 bytes per record.
+   */
+  explicit RecordRing(size_t size);
+  ~RecordRing();
+
+  /**
+   * @return    false if there is not enough room for the record, nothing is written.
+   */
+  bool push(const char *data, size_t length);
+
+  /**
+   * @brief     Whether push() would succeed for a record of this length.
+   */
+  bool hasRoom(size_t length) const;
+
+  /**
+   * @brief     Copies the oldest record into buffer, NUL terminated, without removing it. The record is truncated if it does not fit.
+   *
+   * @return    The length of the record, 0 if the ring is empty.
+   */
+  size_t peek(char *buffer, size_t size) const;
+
+  /**
+   * @brief     Removes the oldest record.
+   */
+  void pop();
+
+  bool   isEmpty() const;
+  size_t getCount() const;
+
+  /**
+   * @brief     Bytes in use, including the record headers.
+   */
+  size_t getUsed() const;
+  size_t getSize() const;
+
+private:
+  void write(size_t offset, const uint8_t *data, size_t length);
+  void read(size_t offset, uint8_t *data, size_t length) const;
+
+  uint8_t     *_data;
+  const size_t _size;
+  size_t       _head; // Offset of the oldest record
+  size_t       _used;
+  size_t       _count;
+};
+
+#endif
@@ -0,0 +1,205 @@
+#include "Spool.h"
+
+Spool::Spool(fs::FS &fs, const char *directory, size_t segmentSize, size_t maxSegments) : _fs(fs), _directory(directory), _segmentSize(segmentSize), _maxSegments(std::max<size_t>(maxSegments, 1)), _first(0), _last(0), _writeSize(0), _commitOffset(0), _cursorSegment(0), _cursorOffset(0), _readBytes(0), _size(0), _pushed(0), _droppedSegments(0) {
+}
+
+Spool::~Spool() {
+  _readFile.close();
+  _writeFile.close();
+}
+
+bool Spool::begin() {
+  File dir = _fs.open(_directory);
+  if (!dir) {
+    // Nothing spooled yet
+    return true;
+  }
+  if (!dir.isDirectory()) {
+    return false;
+  }
+
+  bool     found = false;
+  uint32_t first = 0;
+  uint32_t last  = 0;
+  File     file  = dir.openNextFile();
+  while (file) {
+    const char *name = strrchr(file.path(), '/');
+    name             = (name != NULL) ? name + 1 : file.path();
+
+    char    *end;
+    uint32_t segment = strtoul(name, &end, 16);
+    if (end != name && *end == '\0') {
+      first = (!found || segment < first) ? segment : first;
+      last  = (!found || segment > last) ? segment : last;
+      found = true;
+      _size += file.size();
+    }
+    file = dir.openNextFile();
+  }
+  dir.close();
+
+  if (found) {
+    // Segments left by the previous run are all sealed, new lines go to a new segment
+    _first         = first;
+    _last          = last + 1;
+    _cursorSegment = first;
+  }
+  while (_last - _first > _maxSegments) {
+    dropOldest();
+  }
+  return true;
+}
+
+bool Spool::push(const String &line, time_t timestamp) {
+  String record = String((unsigned long)timestamp) + "\t" + line + "\n";
+
+  if (_writeSize > 0 && _writeSize + record.length() > _segmentSize) {
+    seal();
+  }
+  if (!_writeFile) {
+    while (_last - _first >= _maxSegments) {
+      dropOldest();
+    }
+    _writeFile = _fs.open(getPath(_last), "a", true);
+    if (!_writeFile) {
+      return false;
+    }
+  }
+
+  size_t written = _writeFile.print(record);
+  _writeFile.flush();
+  _writeSize += written;
+  _size += written;
+  if (written != record.length()) {
+    // Flash full: the partial record is skipped when read
+    return false;
+  }
+  _pushed++;
+  return true;
+}
+
+bool Spool::read(String &line, time_t *timestamp) {
+  for (;;) {
+    if (_cursorSegment == _last) {
+      if (_writeSize == 0) {
+        return false;
+      }
+      // Never read the segment being written, close it so that its lines can be read
+      seal();
+    }
+
+    if (!_readFile && !openRead(_cursorSegment, _cursorOffset)) {
+      _cursorSegment++;
+      _cursorOffset = 0;
+      continue;
+    }
+
+    if (!_readFile.available()) {
+      _readFile.close();
+      _cursorSegment++;
+      _cursorOffset = 0;
+      continue;
+    }
+
+    String record = _readFile.readStringUntil('\n');
+    size_t offset = _readFile.position();
+    _readBytes += offset - _cursorOffset;
+    _cursorOffset = offset;
+
+    int separator = record.indexOf('\t');
+    if (separator <= 0) {
+      // Record cut by a power loss or a full flash
+      continue;
+    }
+    *timestamp = (time_t)strtoul(record.c_str(), NULL, 10);
+    line       = record.substring(separator + 1);
+    return true;
+  }
+}
+
+void Spool::commit() {
+  if (_readFile && !_readFile.available()) {
+    // Segment entirely read, do not leave it behind to be read again after a reboot
+    _readFile.close();
+    _cursorSegment++;
+    _cursorOffset = 0;
+  }
+  // The segment of the cursor stays open, only the ones entirely read are removed
+  while (_first < _cursorSegment) {
+    _fs.remove(getPath(_first));
+    _first++;
+  }
+  _commitOffset = _cursorOffset;
+  _size -= std::min(_readBytes, _size);
+  _readBytes = 0;
+}
+
+void Spool::rewind() {
+  _readFile.close();
+  _cursorSegment = _first;
+  _cursorOffset  = _commitOffset;
+  _readBytes     = 0;
+}
+
+bool Spool::isEmpty() const {
+  return _size <= _readBytes;
+}
+
+size_t Spool::getSize() const {
+  return _size;
+}
+
+uint32_t Spool::getPushedCount() const {
+  return _pushed;
+}
+
+uint32_t Spool::getDroppedSegments() const {
+  return _droppedSegments;
+}
+
+String Spool::getPath(uint32_t segment) const {
+  char name[10];
+  snprintf(name, sizeof(name), "%08x", (unsigned int)segment);
+  return _directory + "/" + name;
+}
+
+bool Spool::openRead(uint32_t segment, size_t offset) {
+  _readFile = _fs.open(getPath(segment), "r");
+  if (!_readFile) {
+    return false;
+  }
+  if (offset > 0 && !_readFile.seek(offset)) {
+    _readFile.close();
+    return false;
+  }
+  return true;
+}
+
+void Spool::seal() {
+  _writeFile.close();
+  if (_writeSize > 0) {
+    _last++;
+    _writeSize = 0;
+  }
+}
+
+void Spool::dropOldest() {
+  if (_first == _last) {
+    return;
+  }
+  rewind();
+
+  File file = _fs.open(getPath(_first), "r");
+  if (file) {
+    size_t size = file.size();
+    _size -= std::min(size - std::min(_commitOffset, size), _size);
+    file.close();
+  }
+  _fs.remove(getPath(_first));
+
+  _first++;
+  _commitOffset  = 0;
+  _cursorSegment = _first;
+  _cursorOffset  = 0;
+  _droppedSegments++;
+}
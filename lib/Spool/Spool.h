@@ -0,0 +1,96 @@
+#ifndef SPOOL_H_
+#define SPOOL_H_
+
+#include <Arduino.h>
+#include <FS.h>
+
+/**
+ * @brief Persistent FIFO of text lines stored in flash, used to keep the APRS-IS traffic during outages.
+ *
+ * Lines are appended to segment files named after a sequence number ("<directory>/00000001", ...). A segment is never modified
+ * once written: when it is full a new one is started, and it is deleted as a whole once all its lines were committed. When the
+ * spool holds more than maxSegments segments the oldest one is dropped, so the flash usage is bounded and nothing is rewritten.
+ *
+ * Each line is stored with the time it was pushed as "<epoch>\t<line>\n". Lines are read with a cursor: read() moves it forward,
+ * commit() forgets everything read so far and rewind() moves it back to the last commit, so a batch can be sent again if the
+ * transmission failed.
+ *
+ * The segment being written is never read: it is closed as soon as the reader reaches it. The read position is not persisted, after a
+ * reboot the oldest segment is read again from its beginning.
+ *
+ * Not thread safe, meant to be used by a single task.
+ */
+class Spool {
+public:
+  /**
+   * @param[in] directory Directory of the segments, without trailing '/'.
+   *
+   * @param[in] segmentSize Size (in bytes) after which a new segment is started.
+   *
+   * @param[in] maxSegments Number of segments kept before the oldest one is dropped.
+   */
+  Spool(fs::FS &fs, const char *directory, size_t segmentSize, size_t maxSegments);
+  ~Spool();
+
+  /**
+   * @brief     Finds the segments left by a previous run. The file system must be mounted.
+   */
+  bool begin();
+
+  bool push(const String &line, time_t timestamp);
+
+  /**
+   * @brief     Reads the next line and moves the cursor after it.
+   *
+   * @return    false if there is nothing more to read.
+   */
+  bool read(String &line, time_t *timestamp);
+
+  /**
+   * @brief     Removes every line read so far.
+   */
+  void commit();
+
+  /**
+   * @brief     Moves the cursor back to the first line not committed.
+   */
+  void rewind();
+
+  bool isEmpty() const;
+
+  /**
+   * @brief     Size (in bytes) of the lines waiting in the spool, including the ones read but not committed.
+   */
+  size_t   getSize() const;
+  uint32_t getPushedCount() const;
+  uint32_t getDroppedSegments() const;
+
+private:
+  String getPath(uint32_t segment) const;
+  bool   openRead(uint32_t segment, size_t offset);
+  void   seal();
+  void   dropOldest();
+
+  fs::FS      &_fs;
+  const String _directory;
+  const size_t _segmentSize;
+  const size_t _maxSegments;
+
+  // Segments _first to _last - 1 are sealed, _last is the one being written (it may not exist yet)
+  uint32_t _first;
+  uint32_t _last;
+  File     _writeFile;
+  size_t   _writeSize;
+
+  size_t   _commitOffset; // In segment _first
+  uint32_t _cursorSegment;
+  size_t   _cursorOffset;
+  File     _readFile;  // Segment _cursorSegment, if open
+  size_t   _readBytes; // Read since the last commit
+
+  size_t   _size;
+  uint32_t _pushed;
+  uint32_t _droppedSegments;
+};
+
+#endif
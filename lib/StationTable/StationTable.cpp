@@ -0,0 +1,260 @@
+#include "StationTable.h"
+
+#include <Fnv1a.h>
+
+StationTable::StationTable(size_t capacity) : _capacity(std::min<size_t>(std::max<size_t>(capacity, 1), NONE / 2)), _count(0), _newest(NONE), _oldest(NONE), _evictions(0), _mutex(xSemaphoreCreateMutex()) {
+  size_t size = 1;
+  while (size < 2 * _capacity) {
+    size <<= 1;
+  }
+  _mask    = size - 1;
+  _entries = new Entry[_capacity];
+  _slots   = new uint16_t[size];
+  for (size_t i = 0; i < size; i++) {
+    _slots[i] = NONE;
+  }
+}
+
+StationTable::~StationTable() {
+  vSemaphoreDelete(_mutex);
+  delete[] _slots;
+  delete[] _entries;
+}
+
+void StationTable::update(const Station &heard) {
+  uint32_t h = hash(heard.callsign);
+
+  xSemaphoreTake(_mutex, portMAX_DELAY);
+  size_t   slot = findSlot(heard.callsign, h);
+  uint16_t index;
+  if (_slots[slot] != NONE) {
+    index = _slots[slot];
+    unlink(index);
+  } else {
+    if (_count < _capacity) {
+      index = _count++;
+    } else {
+      // Replace the station heard the longest time ago
+      index = _oldest;
+      unlink(index);
+      removeSlot(findSlot(_entries[index].station.callsign, _entries[index].hash));
+      _evictions++;
+      // Removing an entry may have moved the empty slot found for the new one
+      slot = findSlot(heard.callsign, h);
+    }
+    _slots[slot]             = index;
+    _entries[index].hash     = h;
+    _entries[index].wasGated = false;
+    Station &station         = _entries[index].station;
+    memcpy(station.callsign, heard.callsign, sizeof(station.callsign));
+    station.packets     = 0;
+    station.hasPosition = false;
+  }
+
+  Station &station = _entries[index].station;
+  memcpy(station.via, heard.via, sizeof(station.via));
+  station.lastHeard = heard.lastHeard;
+  station.rssi      = heard.rssi;
+  station.snr       = heard.snr;
+  station.packets++;
+  if (heard.hasPosition) {
+    station.hasPosition = true;
+    station.latitude    = heard.latitude;
+    station.longitude   = heard.longitude;
+  }
+  pushNewest(index);
+  xSemaphoreGive(_mutex);
+}
+
+bool StationTable::find(const char *callsign, Station *station) const {
+  uint32_t h = hash(callsign);
+
+  xSemaphoreTake(_mutex, portMAX_DELAY);
+  size_t slot  = findSlot(callsign, h);
+  bool   found = _slots[slot] != NONE;
+  if (found) {
+    *station = _entries[_slots[slot]].station;
+  }
+  xSemaphoreGive(_mutex);
+  return found;
+}
+
+size_t StationTable::snapshot(Station *stations, size_t size) const {
+  size_t count = 0;
+
+  xSemaphoreTake(_mutex, portMAX_DELAY);
+  for (uint16_t index = _newest; index != NONE && count < size; index = _entries[index].older) {
+    stations[count++] = _entries[index].station;
+  }
+  xSemaphoreGive(_mutex);
+  return count;
+}
+
+bool StationTable::wasHeard(const char *callsign, uint32_t now_ms, uint32_t window_ms) const {
+  uint32_t h = hash(callsign);
+
+  xSemaphoreTake(_mutex, portMAX_DELAY);
+  size_t slot  = findSlot(callsign, h);
+  bool   heard = _slots[slot] != NONE && now_ms - _entries[_slots[slot]].station.lastHeard < window_ms;
+  xSemaphoreGive(_mutex);
+  return heard;
+}
+
+bool StationTable::gate(const char *callsign, uint32_t now_ms, uint32_t interval_ms) {
+  uint32_t h = hash(callsign);
+
+  xSemaphoreTake(_mutex, portMAX_DELAY);
+  size_t slot  = findSlot(callsign, h);
+  bool   gated = false;
+  if (_slots[slot] != NONE) {
+    Entry &entry = _entries[_slots[slot]];
+    if (!entry.wasGated || now_ms - entry.gated >= interval_ms) {
+      entry.gated    = now_ms;
+      entry.wasGated = true;
+      gated          = true;
+    }
+  }
+  xSemaphoreGive(_mutex);
+  return gated;
+}
+
+size_t StationTable::getCount() const {
+  return _count;
+}
+
+size_t StationTable::getCapacity() const {
+  return _capacity;
+}
+
+uint32_t StationTable::getEvictions() const {
+  return _evictions;
+}
+
+bool StationTable::parsePosition(const char *body, float *latitude, float *longitude) {
+  const char *p;
+  switch (body[0]) {
+  case '!':
+  case '=':
+    p = body + 1;
+    break;
+  case '/':
+  case '@':
+    // Timestamp of 7 characters
+    if (strnlen(body, 8) < 8) {
+      return false;
+    }
+    p = body + 8;
+    break;
+  default:
+    return false;
+  }
+
+  if (isdigit(p[0])) {
+    // Uncompressed "DDMM.mmN/DDDMM.mmE", spaces are used for position ambiguity
+    if (strnlen(p, 19) < 19 || p[4] != '.' || p[14] != '.') {
+      return false;
+    }
+    int digits[13];
+    const int positions[] = {0, 1, 2, 3, 5, 6, 9, 10, 11, 12, 13, 15, 16};
+    for (size_t i = 0; i < 13; i++) {
+      char c = p[positions[i]];
+      if (c == ' ') {
+        c = '0';
+      }
+      if (!isdigit(c)) {
+        return false;
+      }
+      digits[i] = c - '0';
+    }
+    float lat = digits[0] * 10 + digits[1] + (digits[2] * 10 + digits[3] + digits[4] / 10.0f + digits[5] / 100.0f) / 60;
+    float lon = digits[6] * 100 + digits[7] * 10 + digits[8] + (digits[9] * 10 + digits[10] + digits[11] / 10.0f + digits[12] / 100.0f) / 60;
+    if ((p[7] != 'N' && p[7] != 'S') || (p[17] != 'E' && p[17] != 'W')) {
+      return false;
+    }
+    *latitude  = (p[7] == 'S') ? -lat : lat;
+    *longitude = (p[17] == 'W') ? -lon : lon;
+    return true;
+  }
+
+  // Compressed: symbol table, then latitude and longitude as 4 base-91 digits each
+  if (strnlen(p, 10) < 10) {
+    return false;
+  }
+  uint32_t lat = 0;
+  uint32_t lon = 0;
+  for (size_t i = 1; i <= 4; i++) {
+    if (p[i] < 33 || p[i] > 123 || p[i + 4] < 33 || p[i + 4] > 123) {
+      return false;
+    }
+    lat = lat * 91 + (p[i] - 33);
+    lon = lon * 91 + (p[i + 4] - 33);
+  }
+  *latitude  = 90 - lat / 380926.0f;
+  *longitude = -180 + lon / 190463.0f;
+  return true;
+}
+
+uint32_t StationTable::hash(const char *callsign) {
+  return fnv1a(callsign, strlen(callsign));
+}
+
+size_t StationTable::findSlot(const char *callsign, uint32_t hash) const {
+  // The table is at most half full, there always is an unused slot to stop at
+  size_t slot = hash & _mask;
+  while (_slots[slot] != NONE) {
+    const Entry &entry = _entries[_slots[slot]];
+    if (entry.hash == hash && strcmp(entry.station.callsign, callsign) == 0) {
+      break;
+    }
+    slot = (slot + 1) & _mask;
+  }
+  return slot;
+}
+
+void StationTable::removeSlot(size_t slot) {
+  // Backward shift: move back the following entries that are not in their home slot, so that no probe sequence is broken
+  size_t next = slot;
+  for (;;) {
+    _slots[slot] = NONE;
+    for (;;) {
+      next = (next + 1) & _mask;
+      if (_slots[next] == NONE) {
+        return;
+      }
+      size_t home = _entries[_slots[next]].hash & _mask;
+      // The entry can move to the free slot unless its home is cyclically between the free slot and itself
+      bool stays = (slot <= next) ? (slot < home && home <= next) : (slot < home || home <= next);
+      if (!stays) {
+        break;
+      }
+    }
+    _slots[slot] = _slots[next];
+    slot         = next;
+  }
+}
+
+void StationTable::unlink(uint16_t index) {
+  Entry &entry = _entries[index];
+  if (entry.newer != NONE) {
+    _entries[entry.newer].older = entry.older;
+  } else {
+    _newest = entry.older;
+  }
+  if (entry.older != NONE) {
+    _entries[entry.older].newer = entry.newer;
+  } else {
+    _oldest = entry.newer;
+  }
+}
+
+void StationTable::pushNewest(uint16_t index) {
+  Entry &entry = _entries[index];
+  entry.newer  = NONE;
+  entry.older  = _newest;
+  if (_newest != NONE) {
+    _entries[_newest].newer = index;
+  } else {
+    _oldest = index;
+  }
+  _newest = index;
+}
@@ -0,0 +1,116 @@
+#ifndef STATION_TABLE_H_
+#define STATION_TABLE_H_
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+/**
+ * @brief Stations heard on RF recently, with what was last heard from them.
+ */
+struct Station {
+  static constexpr size_t CALLSIGN_SIZE = 10; // "CALL10-15" and the terminating NUL
+
+  char     callsign[CALLSIGN_SIZE];
+  char     via[CALLSIGN_SIZE]; // Last digipeater the station was heard through, empty if heard directly
+  uint32_t lastHeard;          // millis()
+  uint32_t packets;
+  float    rssi;
+  float    snr;
+  bool     hasPosition;
+  float    latitude;
+  float    longitude;
+};
+
+/**
+ * @brief Fixed-memory table of the stations heard on RF.
+ *
+ * Stations are kept in a fixed pool linked in least recently heard order. Once the pool is full, the station heard the longest
+ * time ago is replaced. Callsigns are indexed by an open-addressing hash table with linear probing, twice the size of the pool so
+ * that probe sequences stay short. Entries are removed by shifting back the following ones, so the table never holds tombstones.
+ *
+ * Each entry also remembers when a message from APRS-IS was last gated to the station, to rate limit the messages per destination.
+ *
+ * The table is written by the router and read by the web, display and APRS-IS tasks: every method takes a mutex, and readers get
+ * copies.
+ */
+class StationTable {
+public:
+  /**
+   * @param[in] capacity Number of stations remembered, at most 32767.
+   */
+  explicit StationTable(size_t capacity);
+  ~StationTable();
+
+  /**
+   * @brief     Records a packet heard from a station. The position is only updated if the packet has one.
+   */
+  void update(const Station &heard);
+
+  /**
+   * @brief     Copies the entry of a station.
+   *
+   * @return    false if the station is not in the table.
+   */
+  bool find(const char *callsign, Station *station) const;
+
+  /**
+   * @brief     Copies at most size stations, the most recently heard first.
+   *
+   * @return    The number of stations copied.
+   */
+  size_t snapshot(Station *stations, size_t size) const;
+
+  /**
+   * @brief     Tells if a station was heard less than window_ms ago.
+   */
+  bool wasHeard(const char *callsign, uint32_t now_ms, uint32_t window_ms) const;
+
+  /**
+   * @brief     Records a message gated to a station, unless one was gated to it less than interval_ms ago.
+   *
+   * @return    true if the message may be gated, false if the station is not in the table or is rate limited.
+   */
+  bool gate(const char *callsign, uint32_t now_ms, uint32_t interval_ms);
+
+  size_t   getCount() const;
+  size_t   getCapacity() const;
+  uint32_t getEvictions() const;
+
+  /**
+   * @brief     Decodes the position of an APRS position report (uncompressed or compressed, with or without timestamp).
+   *
+   * @return    false if the body is not a position report. Mic-E and objects are not decoded.
+   */
+  static bool parsePosition(const char *body, float *latitude, float *longitude);
+
+private:
+  static constexpr uint16_t NONE = 0xFFFF;
+
+  struct Entry {
+    Station  station;
+    uint32_t hash;
+    uint16_t newer; // Index of the entry heard just after this one, NONE for the most recent
+    uint16_t older;
+    uint32_t gated; // millis() of the last message gated to the station
+    bool     wasGated;
+  };
+
+  static uint32_t hash(const char *callsign);
+  size_t          findSlot(const char *callsign, uint32_t hash) const;
+  void            removeSlot(size_t slot);
+  void            unlink(uint16_t index);
+  void            pushNewest(uint16_t index);
+
+  const size_t      _capacity;
+  size_t            _count;
+  Entry            *_entries;
+  uint16_t         *_slots; // Index in _entries, NONE if unused
+  size_t            _mask;
+  uint16_t          _newest;
+  uint16_t          _oldest;
+  uint32_t          _evictions;
+  SemaphoreHandle_t _mutex;
+};
+
+#endif
@@ -0,0 +1,76 @@
+#include "Histogram.h"
+
+Histogram::Histogram(float min, float binWidth, size_t nbBins) : _min(min), _binWidth(binWidth), _nbBins(nbBins), _bins(new uint32_t[nbBins]) {
+  reset();
+}
+
+Histogram::~Histogram() {
+  delete[] _bins;
+}
+
+void Histogram::add(float sample) {
+  if (sample < _min) {
+    _underflow++;
+    return;
+  }
+
+  size_t bin = (size_t)((sample - _min) / _binWidth);
+  if (bin >= _nbBins) {
+    _overflow++;
+  } else {
+    _bins[bin]++;
+  }
+}
+
+void Histogram::reset() {
+  for (size_t i = 0; i < _nbBins; i++) {
+    _bins[i] = 0;
+  }
+  _underflow = 0;
+  _overflow  = 0;
+}
+
+size_t Histogram::getNbBins() const {
+  return _nbBins;
+}
+
+float Histogram::getBinStart(size_t bin) const {
+  return _min + bin * _binWidth;
+}
+
+uint32_t Histogram::getBinCount(size_t bin) const {
+  return (bin < _nbBins) ? _bins[bin] : 0;
+}
+
+uint32_t Histogram::getUnderflow() const {
+  return _underflow;
+}
+
+uint32_t Histogram::getOverflow() const {
+  return _overflow;
+}
+
+uint32_t Histogram::getCount() const {
+  uint32_t count = _underflow + _overflow;
+  for (size_t i = 0; i < _nbBins; i++) {
+    count += _bins[i];
+  }
+  return count;
+}
+
+String Histogram::toString() const {
+  String str;
+  if (_underflow > 0) {
+    str += String("<") + String(_min, 1) + ":" + _underflow + " ";
+  }
+  for (size_t i = 0; i < _nbBins; i++) {
+    if (_bins[i] > 0) {
+      str += String(getBinStart(i), 1) + ":" + _bins[i] + " ";
+    }
+  }
+  if (_overflow > 0) {
+    str += String(">") + String(getBinStart(_nbBins), 1) + ":" + _overflow;
+  }
+  str.trim();
+  return str;
+}
@@ -0,0 +1,47 @@
+#ifndef HISTOGRAM_H_
+#define HISTOGRAM_H_
+
+#include <Arduino.h>
+
+/**
+ * @brief Counts samples (e.g. RSSI in dBm) into fixed-width bins, plus one bin below and one above the range.
+ *
+ * Written by a single task, read by any task. The bins are allocated once so the memory footprint is constant.
+ */
+class Histogram {
+public:
+  /**
+   * @param[in] min Lower bound of the first bin.
+   *
+   * @param[in] binWidth Width of each bin.
+   *
+   * @param[in] nbBins Number of bins between min and min + nbBins * binWidth.
+   */
+  Histogram(float min, float binWidth, size_t nbBins);
+  ~Histogram();
+
+  void add(float sample);
+  void reset();
+
+  size_t   getNbBins() const;
+  float    getBinStart(size_t bin) const;
+  uint32_t getBinCount(size_t bin) const;
+  uint32_t getUnderflow() const;
+  uint32_t getOverflow() const;
+  uint32_t getCount() const;
+
+  /**
+   * @brief Non-empty bins as "<min:count start:count ... >max:count", for logs.
+   */
+  String toString() const;
+
+private:
+  const float  _min;
+  const float  _binWidth;
+  const size_t _nbBins;
+  uint32_t    *_bins;
+  uint32_t     _underflow;
+  uint32_t     _overflow;
+};
+
+#endif
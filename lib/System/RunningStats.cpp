@@ -0,0 +1,40 @@
+#include "RunningStats.h"
+
+RunningStats::RunningStats() : _count(0), _last(0), _min(UINT32_MAX), _max(0), _sum(0) {
+}
+
+void RunningStats::add(uint32_t sample) {
+  _last = sample;
+  _min  = std::min(_min, sample);
+  _max  = std::max(_max, sample);
+  _sum += sample;
+  _count++;
+}
+
+void RunningStats::reset() {
+  _count = 0;
+  _last  = 0;
+  _min   = UINT32_MAX;
+  _max   = 0;
+  _sum   = 0;
+}
+
+uint32_t RunningStats::getCount() const {
+  return _count;
+}
+
+uint32_t RunningStats::getLast() const {
+  return _last;
+}
+
+uint32_t RunningStats::getMin() const {
+  return (_count == 0) ? 0 : _min;
+}
+
+uint32_t RunningStats::getMax() const {
+  return _max;
+}
+
+uint32_t RunningStats::getMean() const {
+  return (_count == 0) ? 0 : (uint32_t)(_sum / _count);
+}
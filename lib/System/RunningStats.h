@@ -0,0 +1,32 @@
+#ifndef RUNNING_STATS_H_
+#define RUNNING_STATS_H_
+
+#include <Arduino.h>
+
+/**
+ * @brief Keeps count, last, min, max and mean of a stream of samples (e.g. latencies in us).
+ *
+ * Written by a single task, read by any task. No history is kept so the memory footprint is constant.
+ */
+class RunningStats {
+public:
+  RunningStats();
+
+  void add(uint32_t sample);
+  void reset();
+
+  uint32_t getCount() const;
+  uint32_t getLast() const;
+  uint32_t getMin() const;
+  uint32_t getMax() const;
+  uint32_t getMean() const;
+
+private:
+  uint32_t _count;
+  uint32_t _last;
+  uint32_t _min;
+  uint32_t _max;
+  uint64_t _sum;
+};
+
+#endif
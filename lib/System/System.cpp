@@ -1,7 +1,7 @@
 #include "System.h"
 #include "../../src/TaskPacketLogger.h"
 
-System::System() : _boardConfig(0), _userConfig(0), _taskManager(), _isEthConnected(false), _isWifiConnected(false), _packetLogger(NULL) {
+System::System() : _boardConfig(0), _userConfig(0), _taskManager(), _isEthConnected(false), _isWifiConnected(false), _packetLogger(NULL), _packetPool(NULL), _stationTable(NULL) {
 }
 
 System::~System() {
@@ -46,3 +46,19 @@ void System::setPacketLogger(PacketLoggerTask *task) {
 PacketLoggerTask *System::getPacketLogger() {
   return _packetLogger;
 }
+
+void System::setPacketPool(PacketPool *pool) {
+  _packetPool = pool;
+}
+
+PacketPool *System::getPacketPool() {
+  return _packetPool;
+}
+
+void System::setStationTable(StationTable *table) {
+  _stationTable = table;
+}
+
+StationTable *System::getStationTable() {
+  return _stationTable;
+}
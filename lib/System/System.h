@@ -5,6 +5,8 @@
 #include "TaskManager.h"
 
 #include <BoardFinder.h>
+#include <PacketPool.h>
+#include <StationTable.h>
 #include <configuration.h>
 #include <logger.h>
 #include <memory>
@@ -27,6 +29,10 @@ public:
   void                       connectedViaWifi(bool status);
   void                       setPacketLogger(PacketLoggerTask *task);
   PacketLoggerTask          *getPacketLogger();
+  void                       setPacketPool(PacketPool *pool);
+  PacketPool                *getPacketPool();
+  void                       setStationTable(StationTable *table);
+  StationTable              *getStationTable();
 
 private:
   BoardConfig const   *_boardConfig;
@@ -35,6 +41,8 @@ private:
   bool                 _isEthConnected;
   bool                 _isWifiConnected;
   PacketLoggerTask    *_packetLogger;
+  PacketPool          *_packetPool;
+  StationTable        *_stationTable;
 };
 
 #endif
@@ -1,5 +1,4 @@
 #include "TaskManager.h"
-#include <FontConfig.h>
 #include <logger.h>
 
 #define MODULE_NAME "TaskManager"
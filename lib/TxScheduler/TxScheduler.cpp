@@ -0,0 +1,157 @@
+#include <math.h>
+
+#include "TxScheduler.h"
+
+#define DUTY_CYCLE_WINDOW_MS 3600000 // Duty cycle limits are given over one hour
+#define BACKOFF_MAX_EXPONENT 5       // The backoff window stops doubling after 2^5 slots
+
+TxScheduler::TxScheduler(size_t queueLength, const Config &config) : _config(config), _signal(xSemaphoreCreateBinary()), _rejected(0), _busy(0), _dutyCycleDelays(0), _lastRefill(0), _backoffUntil(0), _backoffAttempts(0), _budgetExhausted(false) {
+  for (size_t i = 0; i < NB_PRIORITIES; i++) {
+    _queues[i] = xQueueCreate(queueLength, sizeof(Entry));
+  }
+
+  _budgetRate     = _config.dutyCycle / 100;
+  _budgetCapacity = _budgetRate * DUTY_CYCLE_WINDOW_MS;
+  _budget         = _budgetCapacity;
+}
+
+TxScheduler::~TxScheduler() {
+  for (size_t i = 0; i < NB_PRIORITIES; i++) {
+    Entry entry;
+    while (xQueueReceive(_queues[i], &entry, 0) == pdTRUE) {
+      entry.packet->release();
+    }
+    vQueueDelete(_queues[i]);
+  }
+  vSemaphoreDelete(_signal);
+}
+
+bool TxScheduler::enqueue(Packet *packet, Priority priority) {
+  // Header + encoded message. The airtime is computed here once, the frame itself is only encoded by the modem task.
+  Entry entry;
+  entry.packet      = packet;
+  entry.enqueueTime = millis();
+  entry.airtime     = getAirtime(3 + packet->msg.encode().length());
+
+  if (xQueueSendToBack(_queues[priority], &entry, 0) != pdTRUE) {
+    _rejected++;
+    return false;
+  }
+  xSemaphoreGive(_signal);
+  return true;
+}
+
+SemaphoreHandle_t TxScheduler::getSignal() const {
+  return _signal;
+}
+
+bool TxScheduler::hasPending() const {
+  for (size_t i = 0; i < NB_PRIORITIES; i++) {
+    if (uxQueueMessagesWaiting(_queues[i]) > 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+size_t TxScheduler::getQueueLength(Priority priority) const {
+  return uxQueueMessagesWaiting(_queues[priority]);
+}
+
+uint32_t TxScheduler::getDelay(uint32_t now_ms) {
+  if ((int32_t)(_backoffUntil - now_ms) > 0) {
+    return _backoffUntil - now_ms;
+  }
+
+  if (!refill(now_ms)) {
+    return 0;
+  }
+
+  for (size_t i = 0; i < NB_PRIORITIES; i++) {
+    Entry entry;
+    if (xQueuePeek(_queues[i], &entry, 0) == pdTRUE) {
+      if (_budget >= entry.airtime) {
+        _budgetExhausted = false;
+        return 0;
+      }
+      if (!_budgetExhausted) {
+        _budgetExhausted = true;
+        _dutyCycleDelays++;
+      }
+      return (uint32_t)ceilf((entry.airtime - _budget) / _budgetRate);
+    }
+  }
+  return 0;
+}
+
+uint32_t TxScheduler::backoff(uint32_t now_ms) {
+  // One slot is the duration of a preamble, long enough for the modem to detect a station that starts transmitting
+  uint32_t slot = (uint32_t)ceilf((_config.preambleLength + 4.25f) * getSymbolTime());
+  if (_backoffAttempts < BACKOFF_MAX_EXPONENT) {
+    _backoffAttempts++;
+  }
+  uint32_t delay = slot * random(1, (1 << _backoffAttempts) + 1);
+  _backoffUntil  = now_ms + delay;
+  _busy++;
+  return delay;
+}
+
+Packet *TxScheduler::dequeue(uint32_t now_ms) {
+  for (size_t i = 0; i < NB_PRIORITIES; i++) {
+    Entry entry;
+    if (xQueueReceive(_queues[i], &entry, 0) == pdTRUE) {
+      if (refill(now_ms)) {
+        _budget -= entry.airtime;
+      }
+      _backoffAttempts = 0;
+      _waitTime[i].add(now_ms - entry.enqueueTime);
+      return entry.packet;
+    }
+  }
+  return NULL;
+}
+
+uint32_t TxScheduler::getAirtime(size_t length) const {
+  float symbolTime          = getSymbolTime();
+  int   lowDataRateOptimize = (symbolTime > 16) ? 1 : 0;
+
+  // Explicit header and CRC enabled
+  float payloadBits    = 8.0f * length - 4 * _config.spreadingFactor + 28 + 16;
+  float bitsPerSymbol  = 4.0f * (_config.spreadingFactor - 2 * lowDataRateOptimize);
+  float payloadSymbols = 8 + fmaxf(ceilf(payloadBits / bitsPerSymbol) * _config.codingRate4, 0);
+
+  return (uint32_t)ceilf((_config.preambleLength + 4.25f + payloadSymbols) * symbolTime);
+}
+
+const RunningStats &TxScheduler::getWaitTime(Priority priority) const {
+  return _waitTime[priority];
+}
+
+uint32_t TxScheduler::getRejectedCount() const {
+  return _rejected;
+}
+
+uint32_t TxScheduler::getBusyCount() const {
+  return _busy;
+}
+
+uint32_t TxScheduler::getDutyCycleDelayCount() const {
+  return _dutyCycleDelays;
+}
+
+int32_t TxScheduler::getBudget() const {
+  return (int32_t)_budget;
+}
+
+float TxScheduler::getSymbolTime() const {
+  return (float)(1 << _config.spreadingFactor) * 1000 / _config.signalBandwidth;
+}
+
+bool TxScheduler::refill(uint32_t now_ms) {
+  if (_budgetRate <= 0 || _budgetRate >= 1) {
+    return false;
+  }
+  _budget     = fminf(_budgetCapacity, _budget + (now_ms - _lastRefill) * _budgetRate);
+  _lastRefill = now_ms;
+  return true;
+}
@@ -0,0 +1,128 @@
+#ifndef TX_SCHEDULER_H_
+#define TX_SCHEDULER_H_
+
+#include <Arduino.h>
+#include <PacketPool.h>
+#include <RunningStats.h>
+#include <atomic>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+
+/**
+ * @brief Decides which frame the modem transmits next and when.
+ *
+ * Frames wait in one queue per traffic class and the highest priority class is always served first. A frame is only sent once
+ * the channel budget allows it: the airtime of every frame is computed from the modulation parameters and charged to a token
+ * bucket refilled at the configured duty cycle. When the modem reports the channel busy, transmission is delayed by a random
+ * exponential backoff.
+ *
+ * Any task may enqueue frames. Everything else is meant to be called by the modem task only.
+ */
+class TxScheduler {
+public:
+  enum Priority {
+    Digi,    // Digipeated frames, delaying them makes them useless
+    Message, // Messages gated from APRS-IS
+    Beacon,  // Our own beacons
+    NB_PRIORITIES,
+  };
+
+  struct Config {
+    int      spreadingFactor;
+    long     signalBandwidth; // Hz
+    int      codingRate4;
+    uint16_t preambleLength;
+    float    dutyCycle; // Percent of the airtime allowed over one hour, 0 to disable the limit
+  };
+
+  /**
+   * @param[in] queueLength Number of frames each class can hold.
+   */
+  TxScheduler(size_t queueLength, const Config &config);
+  ~TxScheduler();
+
+  /**
+   * @brief     Queues a frame. Never blocks. On success the caller's reference is handed over to the scheduler.
+   *
+   * @return    false if the queue of this class is full, the caller keeps its reference.
+   */
+  bool enqueue(Packet *packet, Priority priority);
+
+  /**
+   * @brief     Semaphore given each time a frame is queued, to add to the modem task's queue set.
+   */
+  SemaphoreHandle_t getSignal() const;
+
+  bool hasPending() const;
+
+  /**
+   * @brief     Number of frames waiting in the queue of a class.
+   */
+  size_t getQueueLength(Priority priority) const;
+
+  /**
+   * @brief     Time (in ms) to wait before the next frame may be sent, either because of a backoff or the duty cycle budget.
+   */
+  uint32_t getDelay(uint32_t now_ms);
+
+  /**
+   * @brief     To call when the channel is busy. Schedules a random backoff, longer after each consecutive busy channel.
+   *
+   * @return    The backoff (in ms).
+   */
+  uint32_t backoff(uint32_t now_ms);
+
+  /**
+   * @brief     Removes the next frame to send and charges its airtime to the budget.
+   *
+   * @return    Packet*: the frame, holding one reference for the caller, or NULL if nothing is queued.
+   */
+  Packet *dequeue(uint32_t now_ms);
+
+  /**
+   * @brief     Airtime (in ms) of a LoRa frame of the given length, Semtech AN1200.13.
+   */
+  uint32_t getAirtime(size_t length) const;
+
+  /**
+   * @brief     Time (in ms) the frames of a class waited in the queue.
+   */
+  const RunningStats &getWaitTime(Priority priority) const;
+  uint32_t            getRejectedCount() const;
+  uint32_t            getBusyCount() const;
+  uint32_t            getDutyCycleDelayCount() const;
+
+  /**
+   * @brief     Airtime (in ms) left in the duty cycle budget.
+   */
+  int32_t getBudget() const;
+
+private:
+  struct Entry {
+    Packet  *packet;
+    uint32_t enqueueTime; // ms
+    uint32_t airtime;     // ms
+  };
+
+  float getSymbolTime() const; // ms
+  bool  refill(uint32_t now_ms);
+
+  const Config          _config;
+  QueueHandle_t         _queues[NB_PRIORITIES];
+  SemaphoreHandle_t     _signal;
+  RunningStats          _waitTime[NB_PRIORITIES];
+  std::atomic<uint32_t> _rejected;
+  uint32_t              _busy;
+  uint32_t              _dutyCycleDelays;
+
+  float    _budget;         // ms of airtime
+  float    _budgetCapacity; // ms of airtime
+  float    _budgetRate;     // ms of airtime earned per ms
+  uint32_t _lastRefill;
+  uint32_t _backoffUntil;
+  uint8_t  _backoffAttempts;
+  bool     _budgetExhausted; // Only count each budget shortage once
+};
+
+#endif
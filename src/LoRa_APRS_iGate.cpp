@@ -1,5 +1,8 @@
 #include <APRS-IS.h>
 #include <BoardFinder.h>
+#include <PacketBus.h>
+#include <PacketPool.h>
+#include <StationTable.h>
 #include <System.h>
 #include <TaskManager.h>
 #include <esp_sntp.h>
@@ -16,23 +19,29 @@
 #include "TaskOTA.h"
 #include "TaskPacketLogger.h"
 #include "TaskRadiolib.h"
+#include "TaskReplay.h"
 #include "TaskRouter.h"
 #include "TaskWeb.h"
 #include "TaskWifi.h"
 #include "project_configuration.h"
 
-#define VERSION     "23.16.0"
-#define MODULE_NAME "Main"
+#define VERSION            "23.16.0"
+#define MODULE_NAME        "Main"
+#define PACKET_POOL_SIZE   32
+#define PACKET_BUS_SIZE    16
+#define STATION_TABLE_SIZE 128
+#define TX_QUEUE_SIZE      8
 
-QueueHandle_t toAprsIs;
-QueueHandle_t fromModem;
-QueueHandle_t toModem;
-QueueHandle_t toMQTT;
-QueueHandle_t toPacketLogger;
-QueueHandle_t toDisplay;
+#ifndef PACKET_REPLAY_SPEED
+#define PACKET_REPLAY_SPEED 1
+#endif
 
 System        LoRaSystem;
 Configuration userConfig;
+PacketPool   *packetPool;
+PacketBus    *packetBus;
+TxScheduler  *txScheduler;
+StationTable *stationTable;
 
 DisplayTask      *displayTask;
 RadiolibTask     *modemTask;
@@ -46,8 +55,10 @@ AprsIsTask       *aprsIsTask;
 RouterTask       *routerTask;
 BeaconTask       *beaconTask;
 PacketLoggerTask *packetLoggerTask;
+ReplayTask       *replayTask;
 
 void sntp_sync_callback_fn(timeval *timeVal);
+void mqtt_status_callback_fn(JsonObject status);
 
 void setup() {
   esp_task_wdt_init(10, true);
@@ -143,16 +154,15 @@ void setup() {
     }
   }
 
-  toAprsIs       = xQueueCreate(10, sizeof(APRSMessage *));
-  toModem        = xQueueCreate(10, sizeof(APRSMessage *));
-  fromModem      = xQueueCreate(10, sizeof(APRSMessage *));
-  toMQTT         = xQueueCreate(10, sizeof(APRSMessage *));
-  toPacketLogger = xQueueCreate(10, sizeof(logEntry));
-  toDisplay      = xQueueCreate(10, sizeof(TextFrame *));
+  packetPool   = new PacketPool(PACKET_POOL_SIZE);
+  packetBus    = new PacketBus(PACKET_BUS_SIZE);
+  stationTable = new StationTable(STATION_TABLE_SIZE);
 
   LoRaSystem.setBoardConfig(boardConfig);
   LoRaSystem.setUserConfig(&userConfig);
-  displayTask = new DisplayTask(1, 0, true, LoRaSystem, toDisplay, VERSION);
+  LoRaSystem.setPacketPool(packetPool);
+  LoRaSystem.setStationTable(stationTable);
+  displayTask = new DisplayTask(1, 0, true, LoRaSystem, *packetBus, VERSION);
   LoRaSystem.getTaskManager().addFreeRTOSTask(displayTask);
 
   if (LoRaSystem.getUserConfig()->callsign == "NOCALL-10") {
@@ -189,12 +199,24 @@ void setup() {
       APP_LOGE(MODULE_NAME, "Please upload configuration using \"Upload Filesystem Image\" or OTA update (no password, port 3232).");
     }
   } else {
-    modemTask = new RadiolibTask(5, 0, false, LoRaSystem, fromModem, toModem, toPacketLogger, toDisplay);
+    TxScheduler::Config txConfig;
+    txConfig.spreadingFactor = userConfig.lora.spreadingFactor;
+    txConfig.signalBandwidth = userConfig.lora.signalBandwidth;
+    txConfig.codingRate4     = userConfig.lora.codingRate4;
+    txConfig.preambleLength  = LORA_PREAMBLE_LENGTH;
+    txConfig.dutyCycle       = userConfig.lora.dutyCycle;
+    txScheduler              = new TxScheduler(TX_QUEUE_SIZE, txConfig);
+
+    modemTask = new RadiolibTask(5, 0, false, LoRaSystem, *packetBus, *txScheduler);
     LoRaSystem.getTaskManager().addFreeRTOSTask(modemTask);
-    routerTask = new RouterTask(4, 0, false, LoRaSystem, fromModem, toModem, toAprsIs, toMQTT);
+    routerTask = new RouterTask(4, 0, false, LoRaSystem, *packetBus, *txScheduler);
     LoRaSystem.getTaskManager().addFreeRTOSTask(routerTask);
-    beaconTask = new BeaconTask(3, 0, true, LoRaSystem, toModem, toAprsIs, toDisplay);
+    beaconTask = new BeaconTask(3, 0, true, LoRaSystem, *txScheduler, *packetBus);
     LoRaSystem.getTaskManager().addFreeRTOSTask(beaconTask);
+#if ENABLE_PACKET_REPLAY == 1 // See platformio.ini
+    replayTask = new ReplayTask(1, 1, true, LoRaSystem, *packetBus, PACKET_REPLAY_SPEED);
+    LoRaSystem.getTaskManager().addFreeRTOSTask(replayTask);
+#endif
   }
 
   bool tcpip = false;
@@ -222,12 +244,12 @@ void setup() {
     }
 
     if (userConfig.aprs_is.active) {
-      aprsIsTask = new AprsIsTask(4, 0, true, LoRaSystem, toAprsIs);
+      aprsIsTask = new AprsIsTask(4, 0, true, LoRaSystem, *packetBus, txScheduler);
       LoRaSystem.getTaskManager().addFreeRTOSTask(aprsIsTask);
     }
 
     if (userConfig.mqtt.active) {
-      mqttTask = new MQTTTask(4, 0, true, LoRaSystem, toMQTT);
+      mqttTask = new MQTTTask(4, 0, true, LoRaSystem, *packetBus, mqtt_status_callback_fn);
       LoRaSystem.getTaskManager().addFreeRTOSTask(mqttTask);
     }
 
@@ -238,7 +260,7 @@ void setup() {
   }
 
   if (userConfig.packetLogger.active) {
-    packetLoggerTask = new PacketLoggerTask(2, 1, true, LoRaSystem, "packets.log", toPacketLogger);
+    packetLoggerTask = new PacketLoggerTask(2, 1, true, LoRaSystem, "packets.log", *packetBus);
     LoRaSystem.getTaskManager().addFreeRTOSTask(packetLoggerTask);
     LoRaSystem.setPacketLogger(packetLoggerTask);
   }
@@ -269,9 +291,62 @@ void setup() {
 
 volatile bool syslogSet = false;
 
+#if ENABLE_STATS_DUMP == 1 // See platformio.ini
+#define STATS_DUMP_MS 60000
+
+uint32_t lastStats = 0;
+
+/**
+ * @brief Logs the performance counters of every module (most are also in the status record and the MQTT status).
+ */
+void dumpStats() {
+  APP_LOGD(MODULE_NAME, "Station table: %u/%u stations, %u evicted.", stationTable->getCount(), stationTable->getCapacity(), stationTable->getEvictions());
+  APP_LOGD(MODULE_NAME, "Packet pool: %u/%u in use (high-water %u), %u acquired, %u exhausted. Heap: %u free, %u min free, %u largest block.", packetPool->getInUse(), packetPool->getSize(), packetPool->getHighWater(), packetPool->getAcquireCount(), packetPool->getExhaustedCount(), ESP.getFreeHeap(), ESP.getMinFreeHeap(), ESP.getMaxAllocHeap());
+  for (size_t i = 0; i < packetBus->getSubscriberCount(); i++) {
+    const PacketBus::Subscriber *sub = packetBus->getSubscriber(i);
+    APP_LOGD(MODULE_NAME, "Packet bus: %s lag %u, received %u, dropped %u.", sub->getName(), sub->getLag(), sub->getReceivedCount(), sub->getDropCount());
+  }
+  if (modemTask != NULL) {
+    APP_LOGD(MODULE_NAME, "RX decode: %u frames, %uus mean, %uus max.", modemTask->getDecodeTime().getCount(), modemTask->getDecodeTime().getMean(), modemTask->getDecodeTime().getMax());
+    APP_LOGD(MODULE_NAME, "TX to RX turnaround: %u transmissions, %uus mean, %uus max.", modemTask->getTxTurnaround().getCount(), modemTask->getTxTurnaround().getMean(), modemTask->getTxTurnaround().getMax());
+    APP_LOGD(MODULE_NAME, "RX RSSI (dBm): %s.", modemTask->getRssiHistogram().toString().c_str());
+    APP_LOGD(MODULE_NAME, "RX SNR (dB): %s.", modemTask->getSnrHistogram().toString().c_str());
+  }
+  if (txScheduler != NULL) {
+    APP_LOGD(MODULE_NAME, "TX wait: digi %u frames %ums mean %ums max, message %u frames %ums mean %ums max, beacon %u frames %ums mean %ums max.", txScheduler->getWaitTime(TxScheduler::Digi).getCount(), txScheduler->getWaitTime(TxScheduler::Digi).getMean(), txScheduler->getWaitTime(TxScheduler::Digi).getMax(), txScheduler->getWaitTime(TxScheduler::Message).getCount(), txScheduler->getWaitTime(TxScheduler::Message).getMean(), txScheduler->getWaitTime(TxScheduler::Message).getMax(), txScheduler->getWaitTime(TxScheduler::Beacon).getCount(), txScheduler->getWaitTime(TxScheduler::Beacon).getMean(), txScheduler->getWaitTime(TxScheduler::Beacon).getMax());
+    APP_LOGD(MODULE_NAME, "TX scheduler: %u busy channel backoffs, %u duty cycle delays, %u frames rejected, %dms airtime budget left.", txScheduler->getBusyCount(), txScheduler->getDutyCycleDelayCount(), txScheduler->getRejectedCount(), txScheduler->getBudget());
+  }
+  if (aprsIsTask != NULL) {
+    APP_LOGD(MODULE_NAME, "APRS-IS uplink: %u packets, %u bytes in %u writes, %u failed writes, %u dropped.", aprsIsTask->getUplinkLines(), aprsIsTask->getUplinkBytes(), aprsIsTask->getUplinkWrites(), aprsIsTask->getUplinkFailures(), aprsIsTask->getDropCount());
+    APP_LOGD(MODULE_NAME, "APRS-IS connection: %u logins in %ums mean, %ums max, %u failures, %u idle timeouts. Last server byte %ums ago, last heartbeat %ums ago.", aprsIsTask->getConnectLatency().getCount(), aprsIsTask->getConnectLatency().getMean(), aprsIsTask->getConnectLatency().getMax(), aprsIsTask->getConnectFailures(), aprsIsTask->getIdleTimeouts(), aprsIsTask->getServerIdleTime(), aprsIsTask->getHeartbeatAge());
+    APP_LOGD(MODULE_NAME, "APRS-IS downlink: %u lines, %u bytes, %u too long, read in %uus mean, %uus max.", aprsIsTask->getDownlinkLines(), aprsIsTask->getDownlinkBytes(), aprsIsTask->getDownlinkOverflows(), aprsIsTask->getDownlinkTime().getMean(), aprsIsTask->getDownlinkTime().getMax());
+    APP_LOGD(MODULE_NAME, "APRS-IS to RF: %u messages gated, %u rate limited.", aprsIsTask->getGatedToRf(), aprsIsTask->getRateLimited());
+    APP_LOGD(MODULE_NAME, "APRS-IS spool: %u packets spooled, %u replayed, %u expired, %u segments dropped, %u bytes waiting.", aprsIsTask->getSpool().getPushedCount(), aprsIsTask->getSpoolReplayed(), aprsIsTask->getSpoolExpired(), aprsIsTask->getSpool().getDroppedSegments(), aprsIsTask->getSpool().getSize());
+  }
+  if (mqttTask != NULL) {
+    APP_LOGD(MODULE_NAME, "MQTT: %u packets published, %u bytes, %u failed, %u dropped.", mqttTask->getPublished(), mqttTask->getPublishedBytes(), mqttTask->getPublishFailures(), mqttTask->getDropCount());
+    APP_LOGD(MODULE_NAME, "MQTT encoding: %s, %u packets, %uus mean, %uus max, %u bytes mean, %u bytes max, %u bytes mean in JSON.", mqttTask->isMsgPack() ? "msgpack" : "json", mqttTask->getSerializeTime().getCount(), mqttTask->getSerializeTime().getMean(), mqttTask->getSerializeTime().getMax(), mqttTask->getPayloadSize().getMean(), mqttTask->getPayloadSize().getMax(), mqttTask->isMsgPack() ? mqttTask->getJsonSize().getMean() : mqttTask->getPayloadSize().getMean());
+    APP_LOGD(MODULE_NAME, "MQTT buffer: %u packets buffered, %u replayed, %u lost, %u waiting in %u/%u bytes, %u bytes spooled.", mqttTask->getBuffered(), mqttTask->getReplayed(), mqttTask->getBufferDropped(), mqttTask->getBuffer().getCount(), mqttTask->getBuffer().getUsed(), mqttTask->getBuffer().getSize(), mqttTask->getSpool().getSize());
+  }
+  if (packetLoggerTask != NULL) {
+    APP_LOGD(MODULE_NAME, "Packet logger: %u lines, %u bytes written, %u write errors. %uus mean, %uus max per line, %u writes of %uus mean, %uus max.", packetLoggerTask->getLoggedLines(), packetLoggerTask->getWrittenBytes(), packetLoggerTask->getWriteErrors(), packetLoggerTask->getLineTime().getMean(), packetLoggerTask->getLineTime().getMax(), packetLoggerTask->getFlushTime().getCount(), packetLoggerTask->getFlushTime().getMean(), packetLoggerTask->getFlushTime().getMax());
+  }
+  if (routerTask != NULL) {
+    APP_LOGD(MODULE_NAME, "Dupe check: %u duplicates dropped, %u unique packets, %u evicted early from %u entries.", routerTask->getDupeCache().getHits(), routerTask->getDupeCache().getMisses(), routerTask->getDupeCache().getEarlyEvictions(), routerTask->getDupeCache().getSize());
+  }
+}
+#endif
+
 void loop() {
   esp_task_wdt_reset();
 
+#if ENABLE_STATS_DUMP == 1
+  if (millis() - lastStats >= STATS_DUMP_MS) {
+    lastStats = millis();
+    dumpStats();
+  }
+#endif
+
   if (LoRaSystem.isWifiOrEthConnected() && LoRaSystem.getUserConfig()->syslog.active && !syslogSet) {
     logger.setSyslogServer(LoRaSystem.getUserConfig()->syslog.server, LoRaSystem.getUserConfig()->syslog.port, LoRaSystem.getUserConfig()->callsign);
     APP_LOGI(MODULE_NAME, "System connected after a restart to the network, syslog server set");
@@ -289,3 +364,30 @@ void sntp_sync_callback_fn(timeval *timeVal) {
   strftime(strftime_buf, 32, "%c", currentTime);
   APP_ISR_LOGI("SNTP", "SNTP set time to %s", strftime_buf);
 }
+
+// Called by the MQTT task, the counters are read the same way as for the statistics logged by loop()
+void mqtt_status_callback_fn(JsonObject status) {
+  JsonObject queues  = status["queues"];
+  JsonObject packets = status["packets"];
+  if (modemTask != NULL) {
+    packets["rx"]         = modemTask->getRxCount();
+    packets["rx_corrupt"] = modemTask->getRxCorruptCount();
+    packets["tx"]         = modemTask->getTxCount();
+  }
+  if (txScheduler != NULL) {
+    queues["tx_digi"]      = txScheduler->getQueueLength(TxScheduler::Digi);
+    queues["tx_message"]   = txScheduler->getQueueLength(TxScheduler::Message);
+    queues["tx_beacon"]    = txScheduler->getQueueLength(TxScheduler::Beacon);
+    packets["tx_rejected"] = txScheduler->getRejectedCount();
+  }
+  if (routerTask != NULL) {
+    packets["duplicates"]           = routerTask->getDupeCache().getHits();
+    packets["dupe_early_evictions"] = routerTask->getDupeCache().getEarlyEvictions();
+  }
+  if (aprsIsTask != NULL) {
+    packets["to_aprs_is"]      = aprsIsTask->getUplinkLines();
+    packets["aprs_is_dropped"] = aprsIsTask->getDropCount();
+    packets["aprs_is_spooled"] = aprsIsTask->getSpool().getPushedCount();
+    packets["to_rf"]           = aprsIsTask->getGatedToRf();
+  }
+}
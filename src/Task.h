@@ -17,6 +17,7 @@ enum TaskNames {
   TaskWeb,
   TaskWebClient,
   TaskPacketLogger,
+  TaskReplay,
   TaskSize,
 };
 
@@ -34,5 +35,6 @@ enum TaskNames {
 #define TASK_WEB           "WebTask"
 #define TASK_PACKET_LOGGER "PacketLoggerTask"
 #define TASK_DISPLAY       "DisplayTask"
+#define TASK_REPLAY        "ReplayTask"
 
 #endif
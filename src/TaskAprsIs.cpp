@@ -1,11 +1,60 @@
+#include <SPIFFS.h>
+#include <algorithm>
+#include <esp_timer.h>
 #include <logger.h>
+#include <lwip/sockets.h>
 
 #include "System.h"
 #include "Task.h"
 #include "TaskAprsIs.h"
 #include "project_configuration.h"
 
-AprsIsTask::AprsIsTask(UBaseType_t priority, BaseType_t coreId, const bool displayOnScreen, System &system, QueueHandle_t &toAprsIs) : FreeRTOSTask(TASK_APRS_IS, TaskAprsIs, priority, 2048, coreId, displayOnScreen), _toAprsIs(toAprsIs), _system(system) {
+#define APRS_IS_POLL_MS     100  // Maximum time between two reads of the downlink
+#define APRS_IS_UPLINK_SIZE 1024 // A batch is sent as soon as it reaches this size
+
+#define APRS_IS_CONNECT_TIMEOUT_MS 5000    // TCP connection
+#define APRS_IS_LOGIN_TIMEOUT_MS   10000   // From the login line to the logresp line
+#define APRS_IS_BACKOFF_MIN_MS     1000    // Delay before the first reconnection
+#define APRS_IS_BACKOFF_MAX_MS     300000  // The delay doubles after each failure up to this value
+#define APRS_IS_FAILBACK_MS        900000  // Time after which a backup server is left to probe the others again
+#define APRS_IS_STATUS_MS          1000    // Refresh period of the state info while connected
+#define APRS_IS_DNS_CACHE_MS       3600000 // Time the address of a server is used by the probes before it is looked up again
+
+#define APRS_IS_SPOOL_DIR          "/spool"
+#define APRS_IS_SPOOL_SEGMENT_SIZE 4096 // One flash sector
+
+/**
+ * @brief     Length of the complete lines within the first written bytes of a batch: a line cut by a failed write is lost with
+ *            the connection, it has to be sent again.
+ */
+static size_t getSentLength(const String &batch, size_t written, uint32_t *lines) {
+  size_t sent = 0;
+  int    end;
+  *lines      = 0;
+  while ((end = batch.indexOf("\r\n", sent)) >= 0 && (size_t)end + 2 <= written) {
+    sent = end + 2;
+    (*lines)++;
+  }
+  return sent;
+}
+
+AprsIsTask::AprsIsTask(UBaseType_t priority, BaseType_t coreId, const bool displayOnScreen, System &system, PacketBus &bus, TxScheduler *scheduler) : FreeRTOSTask(TASK_APRS_IS, TaskAprsIs, priority, 3072, coreId, displayOnScreen), _bus(bus), _system(system), _scheduler(scheduler), _toRf(scheduler != NULL && system.getStationTable() != NULL && system.getUserConfig()->aprs_is.messages_to_rf && system.getUserConfig()->lora.tx_enable), _toAprsIs(bus.subscribe(TASK_APRS_IS, PacketBus::ToAprsIs)), _gatedToRf(0), _rateLimited(0), _loggingIn(false), _loggedIn(false), _connectStart(0), _nextAttempt(0), _backoff(0), _connectFailures(0), _probed(false), _probing(false), _probeStart(0), _current(0), _connectedSince(0), _idleTimeouts(0), _lastStatus(0), _spool(SPIFFS, APRS_IS_SPOOL_DIR, APRS_IS_SPOOL_SEGMENT_SIZE, system.getUserConfig()->aprs_is.spool_size * 1024 / APRS_IS_SPOOL_SEGMENT_SIZE), _spoolEnabled(system.getUserConfig()->aprs_is.spool_size > 0), _replayCredit(0), _lastReplay(0), _spoolReplayed(0), _spoolExpired(0), _uplinkLines(0), _uplinkBytes(0), _uplinkWrites(0), _uplinkFailures(0), _downlinkLines(0), _downlinkBytes(0) {
+  Server primary;
+  primary.host      = system.getUserConfig()->aprs_is.server;
+  primary.port      = system.getUserConfig()->aprs_is.port;
+  primary.probeTime = 0;
+  primary.socket    = -1;
+  primary.resolved  = false;
+  _servers.push_back(primary);
+  for (const Configuration::APRS_IS::Server &backup : system.getUserConfig()->aprs_is.backups) {
+    Server server;
+    server.host      = backup.server;
+    server.port      = backup.port;
+    server.probeTime = 0;
+    server.socket    = -1;
+    server.resolved  = false;
+    _servers.push_back(server);
+  }
   start();
 }
 
@@ -14,52 +63,582 @@ AprsIsTask::~AprsIsTask() {
 
 void AprsIsTask::worker() {
   _aprs_is.setup(_system.getUserConfig()->callsign, _system.getUserConfig()->aprs_is.passcode, "ESP32-APRS-IS", "0.2");
+  _uplink.reserve(APRS_IS_UPLINK_SIZE + 256);
+
+  if (_spoolEnabled && (!SPIFFS.begin() || !_spool.begin())) {
+    APP_LOGE(getName(), "Could not open the spool, packets will be lost while APRS-IS can not be reached.");
+    _spoolEnabled = false;
+  }
+  if (_spoolEnabled && !_spool.isEmpty()) {
+    APP_LOGI(getName(), "%u bytes left in the spool by the previous run.", _spool.getSize());
+  }
 
   while (!_system.isWifiOrEthConnected()) {
-    vTaskDelay(1000 / portTICK_PERIOD_MS);
+    spool(pdMS_TO_TICKS(1000));
   }
 
   for (;;) {
     if (!_system.isWifiOrEthConnected()) {
-      vTaskDelay(1000 / portTICK_PERIOD_MS);
+      if (_loggingIn || _loggedIn) {
+        connectionFailed("network lost");
+      }
+      spool(pdMS_TO_TICKS(1000));
       continue;
     }
-    if (!_aprs_is.connected()) {
+    if (_loggedIn && !_aprs_is.connected()) {
+      connectionFailed("connection lost");
+    }
+    if (_loggedIn && _current > 0 && millis() - _connectedSince >= APRS_IS_FAILBACK_MS) {
+      // Not a failure: the preferred servers may be reachable again
+      APP_LOGI(getName(), "Leaving backup server %s to probe the servers again.", _servers[_current].host.c_str());
+      _aprs_is.disconnect();
+      _loggedIn = false;
+      _probed   = false;
+    }
+    if (!_loggedIn) {
       if (!connect()) {
-        _stateInfo = "not connected";
-        _state     = Error;
-        vTaskDelay(1000 / portTICK_PERIOD_MS);
+        // Never blocks for long, the uplink packets are spooled in the meantime
+        spool(pdMS_TO_TICKS(APRS_IS_POLL_MS));
         continue;
       }
-      _stateInfo = "connected";
+      _stateInfo = String("connected to ") + _servers[_current].host;
       _state     = Okay;
     }
 
-    _aprs_is.getAPRSMessage();
+    readDownlink();
+
+    // A connection dropped by a router on the way still looks open, but the server heartbeat stops
+    uint32_t idleTimeout = _system.getUserConfig()->aprs_is.idle_timeout * 1000;
+    if (idleTimeout > 0 && getServerIdleTime() >= idleTimeout) {
+      _idleTimeouts++;
+      connectionFailed("server silent");
+      continue;
+    }
+
+    // Wake up as soon as a packet is published, then drain everything queued into a single write
+    Packet  *packet = _bus.receive(_toAprsIs, pdMS_TO_TICKS(APRS_IS_POLL_MS));
+    uint32_t lines  = 0;
+    while (packet != NULL) {
+      _uplink += encode(packet);
+      _uplink += "\r\n";
+      lines++;
+      packet->release();
+      packet = (_uplink.length() < APRS_IS_UPLINK_SIZE) ? _bus.receive(_toAprsIs, 0) : NULL;
+    }
+
+    if (lines > 0) {
+      size_t written = _aprs_is.sendRaw(_uplink.c_str(), _uplink.length());
+      if (written == _uplink.length()) {
+        _uplinkLines += lines;
+        _uplinkBytes += _uplink.length();
+        _uplinkWrites++;
+      } else {
+        uint32_t sentLines;
+        size_t   sent = getSentLength(_uplink, written, &sentLines);
+        APP_LOGE(getName(), "Could not send %u of %u packets to APRS-IS", lines - sentLines, lines);
+        _uplinkLines += sentLines;
+        _uplinkBytes += sent;
+        _uplinkFailures++;
+        spoolBatch(sent);
+      }
+      // The String keeps its buffer for the next batch
+      _uplink = "";
+    }
+
+    if (replaySpool() || lines > 0 || millis() - _lastStatus >= APRS_IS_STATUS_MS) {
+      _stateInfo = String("connected to ") + _servers[_current].host + ", " + _uplinkLines + " packets sent in " + _uplinkWrites + " writes, " + getDropCount() + " dropped";
+      if (_spoolEnabled && !_spool.isEmpty()) {
+        _stateInfo += String(", ") + _spool.getSize() + " bytes spooled";
+      }
+      _stateInfo += String(", server heard ") + getServerIdleTime() / 1000 + "s ago";
+      _lastStatus = millis();
+    }
+  }
+}
 
-    if (uxQueueMessagesWaiting(_toAprsIs) > 0) {
-      APRSMessage *msg;
-      xQueueReceive(_toAprsIs, &msg, 0);
-      _aprs_is.sendMessage(msg->encode() + "\n");
-      delete msg;
+void AprsIsTask::readDownlink() {
+  int64_t     start = esp_timer_get_time();
+  uint32_t    lines = 0;
+  const char *line;
+  size_t      length;
+  while (_aprs_is.readLine(&line, &length)) {
+    lines++;
+    _downlinkBytes += length;
+    if (_toRf && line[0] != '#') {
+      gateToRf(line, length);
     }
+  }
+
+  if (lines > 0) {
+    _downlinkLines += lines;
+    _downlinkTime.add(esp_timer_get_time() - start);
+  }
+}
+
+/**
+ * @brief     Copies a callsign that is not NUL terminated, without its trailing spaces.
+ *
+ * @return    false if it does not fit in a Station callsign.
+ */
+static bool copyCallsign(char *callsign, const char *text, size_t length) {
+  while (length > 0 && text[length - 1] == ' ') {
+    length--;
+  }
+  if (length >= Station::CALLSIGN_SIZE) {
+    return false;
+  }
+  memcpy(callsign, text, length);
+  callsign[length] = '\0';
+  return true;
+}
+
+void AprsIsTask::gateToRf(const char *line, size_t length) {
+  // Only messages are gated: "SOURCE>DEST,PATH::ADDRESSEE:text", the addressee being padded to 9 characters
+  const char *separator = strchr(line, '>');
+  const char *body      = (separator != NULL) ? strchr(separator, ':') : NULL;
+  if (body == NULL) {
+    return;
+  }
+  body++;
+  if ((size_t)(line + length - body) < 11 || body[0] != ':' || body[10] != ':') {
+    return;
+  }
 
-    vTaskDelay(1000);
+  // Most lines stop here, the station table lookup does not allocate
+  StationTable *stations = _system.getStationTable();
+  uint32_t      now      = millis();
+  uint32_t      window   = _system.getUserConfig()->aprs_is.heard_window * 60000;
+  char          addressee[Station::CALLSIGN_SIZE];
+  char          sender[Station::CALLSIGN_SIZE];
+  if (!copyCallsign(addressee, body + 1, 9) || !stations->wasHeard(addressee, now, window)) {
+    return;
   }
+
+  // The sender must not be able to reach the addressee directly, and must allow its packets on RF
+  if (copyCallsign(sender, line, separator - line) && stations->wasHeard(sender, now, window)) {
+    return;
+  }
+  const char *keywords[] = {"TCPXX", "NOGATE", "RFONLY"};
+  for (const char *keyword : keywords) {
+    const char *found = strstr(line, keyword);
+    if (found != NULL && found < body) {
+      return;
+    }
+  }
+
+  if (!stations->gate(addressee, now, _system.getUserConfig()->aprs_is.message_interval * 1000)) {
+    _rateLimited++;
+    APP_LOGD(getName(), "IS->RF: rate limited => %s", line);
+    return;
+  }
+
+  Packet *packet = _system.getPacketPool()->acquire();
+  if (packet == NULL) {
+    APP_LOGE(getName(), "IS->RF: packet pool exhausted, message dropped");
+    return;
+  }
+
+  // Third-party format: "}SOURCE>DEST,TCPIP,CALLSIGN*:body", the original path is replaced
+  const char *headerEnd = separator;
+  while (*headerEnd != ',' && *headerEnd != ':') {
+    headerEnd++;
+  }
+  String callsign = _system.getUserConfig()->callsign;
+  String header   = String(line).substring(0, headerEnd - line);
+  packet->msg.setSource(callsign);
+  packet->msg.setDestination("APLG01");
+  packet->msg.setPath("WIDE1-1");
+  packet->msg.getBody()->setData("}" + header + ",TCPIP," + callsign + "*:" + body);
+
+  APP_LOGI(getName(), "IS->RF: %s", packet->msg.toString().c_str());
+  if (!_scheduler->enqueue(packet, TxScheduler::Message)) {
+    APP_LOGE(getName(), "IS->RF: TX queue full, message dropped");
+    packet->release();
+    return;
+  }
+  _gatedToRf++;
+}
+
+void AprsIsTask::spool(TickType_t timeout) {
+  if (!_spoolEnabled) {
+    // The packets wait on the bus until it overwrites them
+    vTaskDelay(timeout);
+    return;
+  }
+
+  Packet *packet = _bus.receive(_toAprsIs, timeout);
+  while (packet != NULL) {
+    if (!_spool.push(encode(packet), time(NULL))) {
+      APP_LOGW(getName(), "Could not spool packet.");
+    }
+    packet->release();
+    packet = _bus.receive(_toAprsIs, 0);
+  }
+}
+
+void AprsIsTask::spoolBatch(size_t sent) {
+  if (!_spoolEnabled) {
+    return;
+  }
+
+  time_t now   = time(NULL);
+  int    start = sent;
+  int    end;
+  while ((end = _uplink.indexOf("\r\n", start)) >= 0) {
+    _spool.push(_uplink.substring(start, end), now);
+    start = end + 2;
+  }
+}
+
+bool AprsIsTask::replaySpool() {
+  uint32_t now = millis();
+  if (!_spoolEnabled || _spool.isEmpty()) {
+    _replayCredit = 0;
+    _lastReplay   = now;
+    return false;
+  }
+
+  // Token bucket: the spooled packets are sent at spool_rate per second on top of the live traffic, in bursts of at most one second
+  float rate    = _system.getUserConfig()->aprs_is.spool_rate;
+  _replayCredit = std::min(_replayCredit + (now - _lastReplay) * rate / 1000, std::max(rate, 1.0f));
+  _lastReplay   = now;
+  if (_replayCredit < 1) {
+    return false;
+  }
+
+  time_t   oldest = time(NULL) - (time_t)_system.getUserConfig()->aprs_is.spool_max_age * 60;
+  uint32_t lines  = 0;
+  String   line;
+  time_t   timestamp;
+  while (lines < (uint32_t)_replayCredit && _uplink.length() < APRS_IS_UPLINK_SIZE && _spool.read(line, &timestamp)) {
+    if (timestamp < oldest) {
+      _spoolExpired++;
+      continue;
+    }
+    _uplink += line;
+    _uplink += "\r\n";
+    lines++;
+  }
+
+  if (lines > 0) {
+    size_t written = _aprs_is.sendRaw(_uplink.c_str(), _uplink.length());
+    if (written != _uplink.length()) {
+      // The lines sent are read again to commit them, the others are kept in the spool, the connection will be reset
+      uint32_t sentLines;
+      _uplinkBytes += getSentLength(_uplink, written, &sentLines);
+      APP_LOGE(getName(), "Could not send %u of %u spooled packets to APRS-IS", lines - sentLines, lines);
+      _uplinkLines += sentLines;
+      _uplinkFailures++;
+      _spoolReplayed += sentLines;
+      _replayCredit -= sentLines;
+      _spool.rewind();
+      for (uint32_t read = 0; read < sentLines && _spool.read(line, &timestamp);) {
+        if (timestamp >= oldest) {
+          read++;
+        }
+      }
+      _spool.commit();
+      _uplink = "";
+      return true;
+    }
+    _uplinkLines += lines;
+    _uplinkBytes += _uplink.length();
+    _uplinkWrites++;
+    _spoolReplayed += lines;
+    _replayCredit -= lines;
+    _uplink = "";
+  }
+  _spool.commit();
+  return true;
+}
+
+uint32_t AprsIsTask::getDownlinkLines() const {
+  return _downlinkLines;
+}
+
+uint32_t AprsIsTask::getDownlinkBytes() const {
+  return _downlinkBytes;
+}
+
+uint32_t AprsIsTask::getDownlinkOverflows() const {
+  return _aprs_is.getOverflowCount();
+}
+
+const RunningStats &AprsIsTask::getDownlinkTime() const {
+  return _downlinkTime;
+}
+
+uint32_t AprsIsTask::getGatedToRf() const {
+  return _gatedToRf;
+}
+
+uint32_t AprsIsTask::getRateLimited() const {
+  return _rateLimited;
+}
+
+const Spool &AprsIsTask::getSpool() const {
+  return _spool;
+}
+
+uint32_t AprsIsTask::getSpoolReplayed() const {
+  return _spoolReplayed;
+}
+
+uint32_t AprsIsTask::getSpoolExpired() const {
+  return _spoolExpired;
+}
+
+uint32_t AprsIsTask::getUplinkLines() const {
+  return _uplinkLines;
+}
+
+uint32_t AprsIsTask::getUplinkBytes() const {
+  return _uplinkBytes;
+}
+
+uint32_t AprsIsTask::getUplinkWrites() const {
+  return _uplinkWrites;
+}
+
+uint32_t AprsIsTask::getUplinkFailures() const {
+  return _uplinkFailures;
+}
+
+uint32_t AprsIsTask::getDropCount() const {
+  return _toAprsIs->getDropCount();
 }
 
 bool AprsIsTask::connect() {
-  APP_LOGI(getName(), "connecting to APRS-IS server: %s on port: %d", _system.getUserConfig()->aprs_is.server.c_str(), _system.getUserConfig()->aprs_is.port);
-  APRS_IS::ConnectionStatus status = _aprs_is.connect(_system.getUserConfig()->aprs_is.server, _system.getUserConfig()->aprs_is.port);
-  if (status == APRS_IS::ERROR_CONNECTION) {
-    APP_LOGE(getName(), "Something went wrong on connecting! Is the server reachable?");
-    APP_LOGE(getName(), "Connection failed.");
+  if (!_loggingIn) {
+    if ((int32_t)(millis() - _nextAttempt) < 0) {
+      return false;
+    }
+
+    const String &filter = _system.getUserConfig()->aprs_is.filter;
+    if (!_probed && _servers.size() > 1) {
+      if (!_probing) {
+        startProbes();
+        _stateInfo = String("probing ") + _servers.size() + " servers";
+      }
+      int socket = pollProbes();
+      if (socket < 0) {
+        return false;
+      }
+      // The fastest probe connection becomes the APRS-IS connection
+      APP_LOGI(getName(), "APRS-IS server %s accepted the connection in %ums, logging in", _servers[_current].host.c_str(), _servers[_current].probeTime);
+      _stateInfo = String("logging in to ") + _servers[_current].host;
+      _aprs_is.connect(socket, filter);
+    } else {
+      const Server &server = _servers[_current];
+      APP_LOGI(getName(), "connecting to APRS-IS server: %s on port: %d", server.host.c_str(), server.port);
+      _stateInfo    = String("connecting to ") + server.host;
+      _connectStart = millis();
+
+      APRS_IS::ConnectionStatus status;
+      if (filter.isEmpty()) {
+        status = _aprs_is.connect(server.host, server.port, APRS_IS_CONNECT_TIMEOUT_MS);
+      } else {
+        status = _aprs_is.connect(server.host, server.port, filter, APRS_IS_CONNECT_TIMEOUT_MS);
+      }
+      if (status != APRS_IS::IN_PROGRESS) {
+        connectionFailed("server unreachable");
+        return false;
+      }
+    }
+    _loggingIn = true;
+  }
+
+  switch (_aprs_is.pollLogin(APRS_IS_LOGIN_TIMEOUT_MS)) {
+  case APRS_IS::IN_PROGRESS:
+    return false;
+  case APRS_IS::SUCCESS:
+    break;
+  case APRS_IS::ERROR_PASSCODE:
+    connectionFailed("user can not be verified with passcode");
+    return false;
+  case APRS_IS::ERROR_TIMEOUT:
+    connectionFailed("no login response");
     return false;
-  } else if (status == APRS_IS::ERROR_PASSCODE) {
-    APP_LOGE(getName(), "User can not be verified with passcode!");
-    APP_LOGE(getName(), "Connection failed.");
+  default:
+    connectionFailed("connection closed during login");
     return false;
   }
-  APP_LOGI(getName(), "Connected to APRS-IS server!");
+
+  _connectLatency.add(millis() - _connectStart);
+  _loggingIn      = false;
+  _loggedIn       = true;
+  _backoff        = 0;
+  _connectedSince = millis();
+  APP_LOGI(getName(), "Connected to APRS-IS server %s in %ums!", _servers[_current].host.c_str(), _connectLatency.getLast());
   return true;
 }
+
+void AprsIsTask::startProbes() {
+  _probing      = true;
+  _probeStart   = millis();
+  _connectStart = _probeStart;
+
+  // Non-blocking connections to every server at once, the time to accept one is a good estimate of the round trip time
+  for (Server &server : _servers) {
+    server.probeTime = UINT32_MAX;
+    server.socket    = -1;
+
+    // The lookups block: only the first round, the expired addresses and the servers that failed their last probe wait for them
+    if (!server.resolved || millis() - server.resolvedAt >= APRS_IS_DNS_CACHE_MS) {
+      server.resolved = WiFi.hostByName(server.host.c_str(), server.address);
+      if (!server.resolved) {
+        APP_LOGD(getName(), "Probed APRS-IS server %s: unknown host.", server.host.c_str());
+        continue;
+      }
+      server.resolvedAt = millis();
+    }
+    int socket = ::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (socket < 0) {
+      continue;
+    }
+    fcntl(socket, F_SETFL, fcntl(socket, F_GETFL, 0) | O_NONBLOCK);
+
+    struct sockaddr_in address = {};
+    address.sin_family         = AF_INET;
+    address.sin_addr.s_addr    = (uint32_t)server.address;
+    address.sin_port           = htons(server.port);
+    if (::connect(socket, (struct sockaddr *)&address, sizeof(address)) < 0 && errno != EINPROGRESS) {
+      APP_LOGD(getName(), "Probed APRS-IS server %s: unreachable.", server.host.c_str());
+      server.resolved = false;
+      close(socket);
+      continue;
+    }
+    server.socket = socket;
+  }
+}
+
+int AprsIsTask::pollProbes() {
+  fd_set writable;
+  int    maxSocket = -1;
+  FD_ZERO(&writable);
+  for (const Server &server : _servers) {
+    if (server.socket >= 0) {
+      FD_SET(server.socket, &writable);
+      maxSocket = std::max(maxSocket, server.socket);
+    }
+  }
+
+  struct timeval noWait = {0, 0};
+  uint32_t       now    = millis();
+  if (maxSocket >= 0 && select(maxSocket + 1, NULL, &writable, NULL, &noWait) > 0) {
+    for (Server &server : _servers) {
+      if (server.socket < 0 || !FD_ISSET(server.socket, &writable)) {
+        continue;
+      }
+      int       error;
+      socklen_t length = sizeof(error);
+      if (getsockopt(server.socket, SOL_SOCKET, SO_ERROR, &error, &length) == 0 && error == 0) {
+        server.probeTime = now - _probeStart;
+      } else {
+        close(server.socket);
+        server.socket   = -1;
+        server.resolved = false;
+      }
+      APP_LOGD(getName(), "Probed APRS-IS server %s: %ums.", server.host.c_str(), server.probeTime);
+    }
+  }
+
+  // The first server to accept wins, lowest index on a tie
+  Server *fastest = NULL;
+  bool    pending = false;
+  for (Server &server : _servers) {
+    if (server.probeTime != UINT32_MAX) {
+      if (fastest == NULL || server.probeTime < fastest->probeTime) {
+        fastest = &server;
+      }
+    } else if (server.socket >= 0) {
+      pending = true;
+    }
+  }
+  bool timeout = now - _probeStart >= APRS_IS_CONNECT_TIMEOUT_MS;
+  if (fastest == NULL && pending && !timeout) {
+    return -1;
+  }
+
+  // The servers still connecting are slower than the winner but may be reachable, they come next in the configured order
+  int socket = (fastest != NULL) ? fastest->socket : -1;
+  for (Server &server : _servers) {
+    if (server.socket >= 0 && server.socket != socket) {
+      close(server.socket);
+      if (server.probeTime == UINT32_MAX && fastest != NULL && !timeout) {
+        server.probeTime = APRS_IS_CONNECT_TIMEOUT_MS;
+      }
+    }
+    server.socket = -1;
+  }
+  std::stable_sort(_servers.begin(), _servers.end(), [](const Server &a, const Server &b) { return a.probeTime < b.probeTime; });
+  _probing = false;
+  _probed  = true;
+  _current = 0;
+
+  if (socket < 0) {
+    connectionFailed("no server reachable");
+  }
+  return socket;
+}
+
+void AprsIsTask::connectionFailed(const char *reason) {
+  _aprs_is.disconnect();
+  _loggingIn = false;
+  _loggedIn  = false;
+  _connectFailures++;
+
+  if (_current + 1 < _servers.size() && _servers[_current + 1].probeTime != UINT32_MAX) {
+    // Fail over to the next fastest server right away
+    _current++;
+    _nextAttempt = millis();
+    APP_LOGE(getName(), "APRS-IS connection failed: %s. Trying %s.", reason, _servers[_current].host.c_str());
+    _stateInfo = String("not connected (") + reason + "), trying " + _servers[_current].host;
+    _state     = Error;
+    return;
+  }
+
+  // Every server failed, probe them again after the backoff
+  _probed = false;
+  // Jittered exponential backoff: the delay doubles after each failure and half of it is random, so that many iGates losing the
+  // same server do not all come back at the same time
+  _backoff       = (_backoff == 0) ? APRS_IS_BACKOFF_MIN_MS : std::min<uint32_t>(_backoff * 2, APRS_IS_BACKOFF_MAX_MS);
+  uint32_t delay = _backoff / 2 + random(_backoff / 2 + 1);
+  _nextAttempt   = millis() + delay;
+
+  APP_LOGE(getName(), "APRS-IS connection failed: %s. Retrying in %us.", reason, delay / 1000);
+  _stateInfo = String("not connected (") + reason + "), retrying in " + delay / 1000 + "s";
+  _state     = Error;
+}
+
+const RunningStats &AprsIsTask::getConnectLatency() const {
+  return _connectLatency;
+}
+
+uint32_t AprsIsTask::getConnectFailures() const {
+  return _connectFailures;
+}
+
+uint32_t AprsIsTask::getServerIdleTime() const {
+  return _loggedIn ? millis() - _aprs_is.getLastReceived() : 0;
+}
+
+uint32_t AprsIsTask::getHeartbeatAge() const {
+  return _loggedIn ? millis() - _aprs_is.getLastHeartbeat() : 0;
+}
+
+uint32_t AprsIsTask::getIdleTimeouts() const {
+  return _idleTimeouts;
+}
+
+String AprsIsTask::encode(Packet *packet) const {
+  if (packet->origin != Packet::RF) {
+    return packet->msg.encode();
+  }
+
+  String path = packet->msg.getPath();
+  if (!path.isEmpty()) {
+    path += ",";
+  }
+  return packet->msg.getSource() + ">" + packet->msg.getDestination() + "," + path + "qAO," + _system.getUserConfig()->callsign + ":" + packet->msg.getBody()->encode();
+}
@@ -3,21 +3,194 @@
 
 #include <APRS-IS.h>
 #include <APRSMessage.h>
+#include <PacketBus.h>
+#include <PacketPool.h>
+#include <RunningStats.h>
+#include <Spool.h>
 #include <TaskManager.h>
+#include <TxScheduler.h>
+#include <vector>
 
 class AprsIsTask : public FreeRTOSTask {
 public:
-  explicit AprsIsTask(UBaseType_t priority, BaseType_t coreId, const bool displayOnScreen, System &system, QueueHandle_t &toAprsIs);
+  /**
+   * @param[in] scheduler Scheduler of the modem, NULL if the iGate can not transmit. Messages are only gated to RF if set.
+   */
+  explicit AprsIsTask(UBaseType_t priority, BaseType_t coreId, const bool displayOnScreen, System &system, PacketBus &bus, TxScheduler *scheduler);
   virtual ~AprsIsTask();
 
   void worker() override;
 
+  uint32_t getUplinkLines() const;
+  uint32_t getUplinkBytes() const;
+  uint32_t getUplinkWrites() const;
+  uint32_t getUplinkFailures() const;
+
+  /**
+   * @brief Packets lost because the bus overwrote them before the task could send them.
+   */
+  uint32_t getDropCount() const;
+
+  /**
+   * @brief Time (in ms) from the start of the TCP connection to the login response, for each successful connection.
+   */
+  const RunningStats &getConnectLatency() const;
+  uint32_t            getConnectFailures() const;
+
+  /**
+   * @brief Time (in ms) since the last byte received from the server, 0 when not connected.
+   */
+  uint32_t getServerIdleTime() const;
+
+  /**
+   * @brief Time (in ms) since the last server comment line, 0 when not connected.
+   */
+  uint32_t getHeartbeatAge() const;
+
+  /**
+   * @brief Connections closed because the server stayed silent for longer than idle_timeout.
+   */
+  uint32_t getIdleTimeouts() const;
+
+  uint32_t getDownlinkLines() const;
+  uint32_t getDownlinkBytes() const;
+
+  /**
+   * @brief Lines received from the server that were too long for the receive buffer.
+   */
+  uint32_t getDownlinkOverflows() const;
+
+  /**
+   * @brief Time (in us) spent reading the downlink, for each poll that received something.
+   */
+  const RunningStats &getDownlinkTime() const;
+
+  uint32_t getGatedToRf() const;
+
+  /**
+   * @brief Messages not gated to RF because another one was gated to the same station less than message_interval ago.
+   */
+  uint32_t getRateLimited() const;
+
+  const Spool &getSpool() const;
+  uint32_t     getSpoolReplayed() const;
+  uint32_t     getSpoolExpired() const;
+
 private:
   APRS_IS _aprs_is;
 
-  QueueHandle_t &_toAprsIs;
-  System        &_system;
-  bool           connect();
+  PacketBus             &_bus;
+  System                &_system;
+  TxScheduler           *_scheduler;
+  bool                   _toRf;
+  PacketBus::Subscriber *_toAprsIs;
+  uint32_t               _gatedToRf;
+  uint32_t               _rateLimited;
+
+  /**
+   * @brief     Steps the connection state machine. Never blocks longer than the TCP connection timeout.
+   *
+   * @return    true once logged in.
+   */
+  bool connect();
+  void connectionFailed(const char *reason);
+
+  /**
+   * @brief     Starts a non-blocking TCP connection to every server.
+   */
+  void startProbes();
+
+  /**
+   * @brief     Never blocks. Once a server accepted the connection or every probe failed, sorts the servers from the fastest.
+   *
+   * @return    The socket connected to the fastest server, which becomes _current, or -1 if no server accepted yet. The other
+   *            probe connections are closed.
+   */
+  int pollProbes();
+
+  struct Server {
+    String    host;
+    int       port;
+    uint32_t  probeTime;  // ms, UINT32_MAX if the server could not be reached
+    int       socket;     // Probe connection in progress, -1 if none
+    IPAddress address;    // Kept between the probe rounds, the lookups block
+    bool      resolved;   // False until the first lookup and after a failed probe
+    uint32_t  resolvedAt; // millis()
+  };
+
+  bool         _loggingIn;
+  bool         _loggedIn;
+  uint32_t     _connectStart; // millis()
+  uint32_t     _nextAttempt;  // millis() of the next connection attempt
+  uint32_t     _backoff;      // ms, 0 after a successful connection
+  uint32_t     _connectFailures;
+  RunningStats _connectLatency;
+
+  std::vector<Server> _servers; // The configured server and its backups, sorted by probeTime once probed
+  bool                _probed;
+  bool                _probing;
+  uint32_t            _probeStart;     // millis()
+  size_t              _current;        // Server in use or being tried
+  uint32_t            _connectedSince; // millis()
+  uint32_t            _idleTimeouts;
+  uint32_t            _lastStatus; // millis() of the last state info refresh
+
+  /**
+   * @brief     Reads every complete line received from the server without blocking.
+   */
+  void readDownlink();
+
+  /**
+   * @brief     Gates a line received from APRS-IS to RF if it is a message for a station heard on RF recently.
+   */
+  void gateToRf(const char *line, size_t length);
+
+  /**
+   * @brief     Waits at most timeout for packets to send and appends them to the spool. Used while APRS-IS can not be reached.
+   */
+  void spool(TickType_t timeout);
+
+  /**
+   * @brief     Appends the lines of the batch that could not be sent to the spool.
+   *
+   * @param[in] sent Length of the complete lines sent before the write failed, they are not spooled.
+   */
+  void spoolBatch(size_t sent);
+
+  /**
+   * @brief     Sends the spooled packets allowed by the replay rate. Packets older than spool_max_age are discarded.
+   *
+   * @return    true if the spool was not empty.
+   */
+  bool replaySpool();
+
+  Spool    _spool;
+  bool     _spoolEnabled;
+  float    _replayCredit; // Packets that can be sent from the spool
+  uint32_t _lastReplay;   // millis()
+  uint32_t _spoolReplayed;
+  uint32_t _spoolExpired;
+
+  String   _uplink; // Lines of the current batch, sent in a single write
+  uint32_t _uplinkLines;
+  uint32_t _uplinkBytes;
+  uint32_t _uplinkWrites;
+  uint32_t _uplinkFailures;
+
+  uint32_t     _downlinkLines;
+  uint32_t     _downlinkBytes;
+  RunningStats _downlinkTime;
+
+  /**
+   * @brief     Encodes a packet as an APRS-IS line.
+   *
+   * Packets heard on RF get the "qAO,<callsign>" q-construct appended to their path.
+   *
+   * @param[in] packet The packet to encode.
+   *
+   * @return    String: the line to send, without line terminator.
+   */
+  String encode(Packet *packet) const;
 };
 
 #endif
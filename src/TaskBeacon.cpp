@@ -7,7 +7,6 @@
 #include "System.h"
 #include "Task.h"
 #include "TaskBeacon.h"
-#include "TaskDisplay.h"
 #include "project_configuration.h"
 
 OneButton         BeaconTask::_userButton;
@@ -17,8 +16,8 @@ uint              BeaconTask::_instances;
 TaskHandle_t      beaconTaskhandle = NULL;
 SemaphoreHandle_t buttonSemaphore;
 
-BeaconTask::BeaconTask(UBaseType_t priority, BaseType_t coreId, const bool displayOnScreen, System &system, QueueHandle_t &toModem, QueueHandle_t &toAprsIs, QueueHandle_t &toDisplay)
-    : FreeRTOSTask(TASK_BEACON, TaskBeacon, priority, 2048, coreId, displayOnScreen), _toModem(toModem), _toAprsIs(toAprsIs), _toDisplay(toDisplay), _system(system), _ss(1), _useGps(false) /*, _beaconMsgReady(false), _aprsBeaconSent(false)*/, _lastBeaconSentTime(0), _beaconPeriod(pdMS_TO_TICKS(_system.getUserConfig()->beacon.timeout * 60 * 1000)), _fast_pace_start_time(0) {
+BeaconTask::BeaconTask(UBaseType_t priority, BaseType_t coreId, const bool displayOnScreen, System &system, TxScheduler &scheduler, PacketBus &bus)
+    : FreeRTOSTask(TASK_BEACON, TaskBeacon, priority, 2048, coreId, displayOnScreen), _scheduler(scheduler), _bus(bus), _system(system), _ss(1), _useGps(false) /*, _beaconMsgReady(false), _aprsBeaconSent(false)*/, _lastBeaconSentTime(0), _beaconPeriod(pdMS_TO_TICKS(_system.getUserConfig()->beacon.timeout * 60 * 1000)), _fast_pace_start_time(0) {
   start();
 }
 
@@ -84,16 +83,20 @@ void BeaconTask::worker() {
       _lastBeaconSentTime = xTaskGetTickCount();
       if (_system.getUserConfig()->aprs_is.active) {
         // Prepare APRS message to send to APRS-is
-        APRSMessage *ipMsg = new APRSMessage(_beaconMsg);
-        xQueueSendToBack(_toAprsIs, &ipMsg, pdMS_TO_TICKS(100));
+        Packet *ipPacket = _system.getPacketPool()->acquire();
+        if (ipPacket != NULL) {
+          ipPacket->msg = _beaconMsg;
+          _bus.publish(ipPacket, PacketBus::ToAprsIs | PacketBus::IpBeacon);
+          ipPacket->release();
+        } else {
+          APP_LOGE(getName(), "Packet pool exhausted, IP beacon dropped");
+        }
 
         // Log
         time(&now);
         localtime_r(&now, &timeInfo);
         strftime(timeStr, 9, "%T", &timeInfo);
         APP_LOGI(getName(), "[IP Beacon][%s] %s", timeStr, _beaconMsg.encode().c_str());
-        TextFrame *frame = new TextFrame("IP BEACON", _beaconMsg.toString());
-        xQueueSendToBack(_toDisplay, &frame, pdMS_TO_TICKS(100));
 
         // Wait at least 30s before RF
         if (_system.getUserConfig()->digi.beacon) {
@@ -102,16 +105,23 @@ void BeaconTask::worker() {
       }
       if (_system.getUserConfig()->digi.beacon) {
         // Prepare APRS message to send to RF
-        APRSMessage *rfMsg = new APRSMessage(_beaconMsg);
-        xQueueSendToBack(_toModem, &rfMsg, pdMS_TO_TICKS(100));
+        Packet *rfPacket = _system.getPacketPool()->acquire();
+        if (rfPacket != NULL) {
+          rfPacket->msg = _beaconMsg;
+          _bus.publish(rfPacket, PacketBus::RfBeacon);
+          if (!_scheduler.enqueue(rfPacket, TxScheduler::Beacon)) {
+            APP_LOGE(getName(), "TX queue full, RF beacon dropped");
+            rfPacket->release();
+          }
+        } else {
+          APP_LOGE(getName(), "Packet pool exhausted, RF beacon dropped");
+        }
 
         // Log
         time(&now);
         localtime_r(&now, &timeInfo);
         strftime(timeStr, 9, "%T", &timeInfo);
         APP_LOGI(getName(), "[RF Beacon][%s] %s", timeStr, _beaconMsg.encode().c_str());
-        TextFrame *frame = new TextFrame("RF BEACON", _beaconMsg.toString());
-        xQueueSendToBack(_toDisplay, &frame, pdMS_TO_TICKS(100));
       }
       _stateInfo   = "Beacon Sent";
       _send_update = false;
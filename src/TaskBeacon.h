@@ -3,22 +3,23 @@
 
 #include <APRSMessage.h>
 #include <OneButton.h>
+#include <PacketBus.h>
 #include <TaskMQTT.h>
 #include <TaskManager.h>
 #include <TinyGPS++.h>
+#include <TxScheduler.h>
 
 #include "Timer.h"
 
 class BeaconTask : public FreeRTOSTask {
 public:
-  BeaconTask(UBaseType_t priority, BaseType_t coreId, const bool displayOnScreen, System &system, QueueHandle_t &toModem, QueueHandle_t &toAprsIs, QueueHandle_t &toDisplay);
+  BeaconTask(UBaseType_t priority, BaseType_t coreId, const bool displayOnScreen, System &system, TxScheduler &scheduler, PacketBus &bus);
 
   void worker() override;
 
 private:
-  QueueHandle_t &_toModem;
-  QueueHandle_t &_toAprsIs;
-  QueueHandle_t &_toDisplay;
+  TxScheduler &_scheduler;
+  PacketBus   &_bus;
 
   APRSMessage _beaconMsg;
   Timer       _beacon_timer;
@@ -7,7 +7,7 @@
 #include "TaskDisplay.h"
 #include "project_configuration.h"
 
-DisplayTask::DisplayTask(UBaseType_t priority, BaseType_t coreId, const bool displayOnScreen, System &system, QueueHandle_t &toDisplay, const char *version) : FreeRTOSTask(TASK_DISPLAY, TaskDisplay, priority, 2048, coreId, displayOnScreen), _toDisplay(toDisplay), _displaySaveMode(false), _version(version), _system(system), _disp(NULL) {
+DisplayTask::DisplayTask(UBaseType_t priority, BaseType_t coreId, const bool displayOnScreen, System &system, PacketBus &bus, const char *version) : FreeRTOSTask(TASK_DISPLAY, TaskDisplay, priority, 2048, coreId, displayOnScreen), _bus(bus), _toDisplay(bus.subscribe(TASK_DISPLAY, PacketBus::RfReceived | PacketBus::IpBeacon | PacketBus::RfBeacon)), _displaySaveMode(false), _version(version), _system(system), _disp(NULL) {
   start();
 }
 
@@ -53,15 +53,27 @@ void DisplayTask::worker() {
     if (_system.getUserConfig()->display.overwritePin != 0 && !digitalRead(_system.getUserConfig()->display.overwritePin)) {
       activateDisplay();
     }
-    TextFrame *frame;
-    bool       res = xQueueReceive(_toDisplay, &frame, pdMS_TO_TICKS(500));
-    if (res) {
+    uint32_t topics;
+    Packet  *packet = _bus.receive(_toDisplay, pdMS_TO_TICKS(500), &topics);
+    if (packet != NULL) {
+      const char *header = "LoRa";
+      if (topics & PacketBus::IpBeacon) {
+        header = "IP BEACON";
+      } else if (topics & PacketBus::RfBeacon) {
+        header = "RF BEACON";
+      }
+      TextFrame frame(header, packet->msg.toString());
+      packet->release();
+
+      if (_system.getStationTable() != NULL) {
+        _stateInfo = _system.getUserConfig()->callsign + ", " + _system.getStationTable()->getCount() + " heard";
+      }
+
       Bitmap bitmap(_disp);
-      frame->draw(bitmap);
+      frame.draw(bitmap);
       _disp->display(&bitmap);
 
       vTaskDelay(pdMS_TO_TICKS(2000));
-      delete frame;
     } else {
       if (_disp->isDisplayOn()) {
         Bitmap bitmap(_disp);
@@ -2,6 +2,7 @@
 #define TASK_DISPLAY_H_
 
 #include <Arduino.h>
+#include <PacketBus.h>
 #include <SSD1306.h>
 #include <TaskManager.h>
 
@@ -14,7 +15,7 @@ class StatusFrame;
 
 class DisplayTask : public FreeRTOSTask {
 public:
-  DisplayTask(UBaseType_t priority, BaseType_t coreId, const bool displayOnScreen, System &system, QueueHandle_t &toDisplay, const char *version);
+  DisplayTask(UBaseType_t priority, BaseType_t coreId, const bool displayOnScreen, System &system, PacketBus &bus, const char *version);
   virtual ~DisplayTask();
 
   void worker() override;
@@ -30,9 +31,10 @@ public:
   void activateDisplay();
 
 private:
-  QueueHandle_t &_toDisplay;
-  bool           _displaySaveMode;
-  const char    *_version;
+  PacketBus             &_bus;
+  PacketBus::Subscriber *_toDisplay;
+  bool                   _displaySaveMode;
+  const char            *_version;
 
   Timer _displaySaveModeTimer;
   Timer _frameTimeout;
@@ -1,4 +1,6 @@
-#include <ArduinoJson.h>
+#include <SPIFFS.h>
+#include <algorithm>
+#include <esp_timer.h>
 #include <logger.h>
 
 #include "System.h"
@@ -6,7 +8,15 @@
 #include "TaskMQTT.h"
 #include "project_configuration.h"
 
-MQTTTask::MQTTTask(UBaseType_t priority, BaseType_t coreId, const bool displayOnScreen, System &system, QueueHandle_t &toMQTT) : FreeRTOSTask(TASK_MQTT, TaskMQTT, priority, 3072, coreId, displayOnScreen), _system(system), _toMQTT(toMQTT), _MQTT(_client) {
+#define MQTT_POLL_MS      1000 // Maximum time between two calls to the MQTT client loop
+#define MQTT_RECONNECT_MS 1000 // Delay between two connection attempts
+#define MQTT_DOC_SIZE     768  // Header fields, reception metrics and a full length APRS body
+#define MQTT_STATUS_SIZE  2048 // Status record, with one entry per task and per bus subscriber
+
+#define MQTT_SPOOL_DIR          "/mqtt"
+#define MQTT_SPOOL_SEGMENT_SIZE 4096 // One flash sector
+
+MQTTTask::MQTTTask(UBaseType_t priority, BaseType_t coreId, const bool displayOnScreen, System &system, PacketBus &bus, StatusCallback statusCallback) : FreeRTOSTask(TASK_MQTT, TaskMQTT, priority, 3072, coreId, displayOnScreen), _system(system), _bus(bus), _toMQTT(bus.subscribe(TASK_MQTT, PacketBus::RfReceived)), _MQTT(_client), _nextAttempt(0), _msgPack(system.getUserConfig()->mqtt.format == "msgpack"), _statusCallback(statusCallback), _lastStatus(0), _topic(), _sourceTopic(), _doc(MQTT_DOC_SIZE), _ring(std::max<size_t>(system.getUserConfig()->mqtt.buffer_size * 1024, 1)), _spool(SPIFFS, MQTT_SPOOL_DIR, MQTT_SPOOL_SEGMENT_SIZE, system.getUserConfig()->mqtt.spool_size * 1024 / MQTT_SPOOL_SEGMENT_SIZE), _spoolEnabled(system.getUserConfig()->mqtt.spool_size > 0), _replayCredit(0), _liveCredit(0), _lastReplay(0), _published(0), _publishedBytes(0), _publishFailures(0), _buffered(0), _replayed(0), _bufferDropped(0) {
   start();
   APP_LOGI(getName(), "MQTT class created.");
 }
@@ -14,50 +24,394 @@ MQTTTask::MQTTTask(UBaseType_t priority, BaseType_t coreId, const bool displayOn
 void MQTTTask::worker() {
   _MQTT.setServer(_system.getUserConfig()->mqtt.server.c_str(), _system.getUserConfig()->mqtt.port);
 
+  _topic = _system.getUserConfig()->mqtt.topic;
+  if (!_topic.endsWith("/")) {
+    _topic += "/";
+  }
+  _topic += _system.getUserConfig()->callsign;
+  if (_msgPack) {
+    // MQTT 3.1.1 has no content type, the subscribers tell the encodings apart by their topic
+    _topic += "/msgpack";
+  }
+
+  if (_spoolEnabled && (!SPIFFS.begin() || !_spool.begin())) {
+    APP_LOGE(getName(), "Could not open the spool, only the RAM buffer is used while the broker can not be reached.");
+    _spoolEnabled = false;
+  }
+  if (_spoolEnabled && !_spool.isEmpty()) {
+    APP_LOGI(getName(), "%u bytes left in the spool by the previous run.", _spool.getSize());
+  }
+
   for (;;) {
-    if (!_system.isWifiOrEthConnected()) {
-      vTaskDelay(1000 / portTICK_PERIOD_MS);
-      continue;
-    }
+    bool online = _system.isWifiOrEthConnected() && connect();
+
+    // Wake up as soon as a packet is published, then handle everything queued. The bus is read even while the broker can not be
+    // reached, so that the packets are buffered instead of being overwritten on the bus.
+    Packet  *packet = _bus.receive(_toMQTT, pdMS_TO_TICKS(MQTT_POLL_MS));
+    uint32_t count  = 0;
+    while (packet != NULL) {
+      const String *topic;
+      size_t        length = serialize(packet, &topic);
+      packet->release();
+      count++;
 
-    if (!_MQTT.connected()) {
-      if (!_MQTT.connect(_system.getUserConfig()->callsign.c_str(), _system.getUserConfig()->mqtt.name.c_str(), _system.getUserConfig()->mqtt.password.c_str())) {
-        APP_LOGI(getName(), "Could not connect to MQTT broker.");
-        vTaskDelay(1000);
-        continue;
-      } else {
-        APP_LOGI(getName(), "Connected to MQTT broker as: %s", _system.getUserConfig()->callsign.c_str());
+      // Behind the buffered packets to keep the order. While connected, each one queued that way adds to the replay credit, so
+      // that the backlog drains at replay_rate whatever the live traffic.
+      bool behind = !isBufferEmpty();
+      if (length > 0 && (!online || behind || !send(topic->c_str(), _payload, length))) {
+        buffer(*topic, length);
+        if (online && behind) {
+          _liveCredit++;
+        }
       }
+      packet = _bus.receive(_toMQTT, 0);
     }
 
-    if (uxQueueMessagesWaiting(_toMQTT) > 0) {
-      APRSMessage *msg;
-      xQueueReceive(_toMQTT, &msg, pdMS_TO_TICKS(0));
+    if (online) {
+      replayBuffer();
 
-      DynamicJsonDocument data(300);
-      data["source"]      = msg->getSource();
-      data["destination"] = msg->getDestination();
-      data["path"]        = msg->getPath();
-      data["type"]        = msg->getType().toString();
-      String body         = msg->getBody()->encode();
-      body.replace("\n", "");
-      data["data"] = body;
+      uint32_t statusInterval = _system.getUserConfig()->mqtt.status_interval * 1000;
+      if (statusInterval > 0 && millis() - _lastStatus >= statusInterval) {
+        _lastStatus = millis();
+        publishStatus();
+      }
 
-      String r;
-      serializeJson(data, r);
+      _MQTT.loop();
+    }
 
-      String topic = String(_system.getUserConfig()->mqtt.topic);
-      if (!topic.endsWith("/")) {
-        topic = topic + "/";
+    if (count > 0) {
+      _stateInfo = String(_published) + " packets published, " + _publishFailures + " failed, " + getDropCount() + " dropped";
+      if (!isBufferEmpty()) {
+        _stateInfo += String(", ") + _ring.getCount() + " buffered";
+        if (_spoolEnabled && !_spool.isEmpty()) {
+          _stateInfo += String(" and ") + _spool.getSize() + " bytes spooled";
+        }
       }
-      topic = topic + _system.getUserConfig()->callsign;
-      APP_LOGD(getName(), "Send MQTT with topic: '%s', data: %s", topic.c_str(), r.c_str());
-      _MQTT.publish(topic.c_str(), r.c_str());
-      delete msg;
     }
+  }
+}
+
+bool MQTTTask::connect() {
+  if (_MQTT.connected()) {
+    return true;
+  }
+  if ((int32_t)(millis() - _nextAttempt) < 0) {
+    return false;
+  }
+
+  if (!_MQTT.connect(_system.getUserConfig()->callsign.c_str(), _system.getUserConfig()->mqtt.name.c_str(), _system.getUserConfig()->mqtt.password.c_str())) {
+    APP_LOGI(getName(), "Could not connect to MQTT broker.");
+    _nextAttempt = millis() + MQTT_RECONNECT_MS;
+    return false;
+  }
+  APP_LOGI(getName(), "Connected to MQTT broker as: %s", _system.getUserConfig()->callsign.c_str());
+  return true;
+}
+
+size_t MQTTTask::serialize(Packet *packet, const String **topic) {
+  APRSMessage *msg = &packet->msg;
+
+  // The reception time is part of the payload, so buffered packets keep it when they are published later
+  int64_t start = esp_timer_get_time();
+  buildDocument(packet, _doc);
+
+  size_t length = _msgPack ? measureMsgPack(_doc) : measureJson(_doc);
+  if (_doc.overflowed() || length >= sizeof(_payload)) {
+    APP_LOGE(getName(), "Packet from %s too large to be published.", msg->getSource().c_str());
+    _publishFailures++;
+    return 0;
+  }
+  if (_msgPack) {
+    serializeMsgPack(_doc, _payload, sizeof(_payload));
+  } else {
+    serializeJson(_doc, _payload, sizeof(_payload));
+  }
+  _serializeTime.add(esp_timer_get_time() - start);
+  _payloadSize.add(length);
+  if (_msgPack) {
+    // Not timed, only to compare the encodings
+    _jsonSize.add(measureJson(_doc));
+  }
+
+  *topic = &_topic;
+  if (_system.getUserConfig()->mqtt.per_source) {
+    // Assigning keeps the buffer of the previous topic
+    _sourceTopic = _topic;
+    _sourceTopic += "/";
+    _sourceTopic += msg->getSource();
+    *topic = &_sourceTopic;
+  }
+  return length;
+}
+
+void MQTTTask::buildDocument(Packet *packet, JsonDocument &doc) {
+  APRSMessage *msg = &packet->msg;
+  doc.clear();
+  doc["source"]      = msg->getSource();
+  doc["destination"] = msg->getDestination();
+  doc["path"]        = msg->getPath();
+  doc["type"]        = msg->getType().toString();
+  String body        = msg->getBody()->encode();
+  body.replace("\n", "");
+  doc["data"] = body;
+  if (packet->origin == Packet::RF || packet->origin == Packet::Replay) {
+    doc["rssi"]       = packet->rx.rssi;
+    doc["snr"]        = packet->rx.snr;
+    doc["freq_error"] = packet->rx.freqError;
+    doc["sf"]         = packet->rx.spreadingFactor;
+    doc["rx_time"]    = (unsigned long)packet->rx.rxTime;
+  }
+}
+
+bool MQTTTask::send(const char *topic, const char *payload, size_t length) {
+  if (_msgPack) {
+    APP_LOGD(getName(), "Send MQTT with topic: '%s', %u bytes", topic, length);
+  } else {
+    APP_LOGD(getName(), "Send MQTT with topic: '%s', data: %s", topic, payload);
+  }
+
+  // Streamed to the client: the payload is not copied into the PubSubClient buffer, whose size would limit it
+  if (!_MQTT.beginPublish(topic, length, _system.getUserConfig()->mqtt.retain) || _MQTT.write((const uint8_t *)payload, length) != length || !_MQTT.endPublish()) {
+    _publishFailures++;
+    return false;
+  }
+  _published++;
+  _publishedBytes += length;
+  return true;
+}
+
+void MQTTTask::buffer(const String &topic, size_t length) {
+  size_t recordLength = topic.length() + 1 + length;
+  if (recordLength >= sizeof(_record)) {
+    _bufferDropped++;
+    return;
+  }
+  _buffered++;
+
+  // Make room by moving the oldest records out of the ring, _record is used as scratch buffer until the new record is built
+  while (!_ring.hasRoom(recordLength) && !_ring.isEmpty()) {
+    size_t oldest = _ring.peek(_record, sizeof(_record));
+    _ring.pop();
+    spill(_record, oldest);
+  }
+
+  memcpy(_record, topic.c_str(), topic.length());
+  _record[topic.length()] = '\t';
+  memcpy(_record + topic.length() + 1, _payload, length);
+  _record[recordLength] = '\0';
+  if (!_ring.push(_record, recordLength)) {
+    // Larger than the whole ring
+    spill(_record, recordLength);
+  }
+}
+
+void MQTTTask::spill(const char *record, size_t length) {
+  if (!_spoolEnabled) {
+    _bufferDropped++;
+    return;
+  }
+
+  const char *payload = (const char *)memchr(record, '\t', length) + 1;
+  if (payload[0] == '{') {
+    if (!_spool.push(record, time(NULL))) {
+      _bufferDropped++;
+    }
+    return;
+  }
 
-    _MQTT.loop();
+  // The spool stores lines of text, MessagePack payloads are written in hexadecimal
+  static const char digits[] = "0123456789abcdef";
+  String            line;
+  line.reserve(payload - record + 2 * (record + length - payload));
+  for (const char *c = record; c < payload; c++) {
+    line += *c;
+  }
+  for (const char *c = payload; c < record + length; c++) {
+    line += digits[(uint8_t)*c >> 4];
+    line += digits[(uint8_t)*c & 0x0F];
+  }
+  if (!_spool.push(line, time(NULL))) {
+    _bufferDropped++;
+  }
+}
 
-    vTaskDelay(pdMS_TO_TICKS(1000));
+void MQTTTask::replayBuffer() {
+  uint32_t now = millis();
+  if (isBufferEmpty()) {
+    _replayCredit = 0;
+    _liveCredit   = 0;
+    _lastReplay   = now;
+    return;
   }
+
+  // Token bucket: the buffered packets are published at replay_rate per second, in bursts of at most one second, plus one for
+  // every live packet queued behind them
+  float rate    = _system.getUserConfig()->mqtt.replay_rate;
+  _replayCredit = std::min(_replayCredit + (now - _lastReplay) * rate / 1000, std::max(rate, 1.0f));
+  _lastReplay   = now;
+
+  uint32_t credit = (uint32_t)_replayCredit + _liveCredit;
+  uint32_t count  = 0;
+  String   line;
+  time_t   timestamp;
+  while (_spoolEnabled && count < credit && _spool.read(line, &timestamp)) {
+    int separator = line.indexOf('\t');
+    if (separator <= 0) {
+      _spool.commit();
+      continue;
+    }
+    line.setCharAt(separator, '\0');
+    const char *payload = line.c_str() + separator + 1;
+    size_t      length  = line.length() - separator - 1;
+    if (payload[0] != '{') {
+      length  = decodeHex(payload, length);
+      payload = _payload;
+    }
+    if (!send(line.c_str(), payload, length)) {
+      // Kept in the spool, the connection will be reset
+      _spool.rewind();
+      break;
+    }
+    _spool.commit();
+    count++;
+  }
+
+  while ((!_spoolEnabled || _spool.isEmpty()) && count < credit && !_ring.isEmpty()) {
+    size_t length    = _ring.peek(_record, sizeof(_record));
+    char  *separator = strchr(_record, '\t');
+    if (separator == NULL || length >= sizeof(_record)) {
+      _ring.pop();
+      continue;
+    }
+    *separator = '\0';
+    if (!send(_record, separator + 1, length - (separator + 1 - _record))) {
+      break;
+    }
+    _ring.pop();
+    count++;
+  }
+
+  // The credit of the live packets is used first, it does not expire
+  uint32_t live = std::min(count, _liveCredit);
+  _liveCredit -= live;
+  _replayCredit -= count - live;
+  _replayed += count;
+}
+
+size_t MQTTTask::decodeHex(const char *hex, size_t length) {
+  size_t size = std::min(length / 2, sizeof(_payload));
+  for (size_t i = 0; i < size; i++) {
+    char digits[3] = {hex[2 * i], hex[2 * i + 1], '\0'};
+    _payload[i]    = (char)strtoul(digits, NULL, 16);
+  }
+  return size;
+}
+
+bool MQTTTask::isBufferEmpty() const {
+  return _ring.isEmpty() && (!_spoolEnabled || _spool.isEmpty());
+}
+
+uint32_t MQTTTask::getPublished() const {
+  return _published;
+}
+
+uint32_t MQTTTask::getPublishedBytes() const {
+  return _publishedBytes;
+}
+
+uint32_t MQTTTask::getPublishFailures() const {
+  return _publishFailures;
+}
+
+uint32_t MQTTTask::getDropCount() const {
+  return _toMQTT->getDropCount();
+}
+
+uint32_t MQTTTask::getBuffered() const {
+  return _buffered;
+}
+
+uint32_t MQTTTask::getReplayed() const {
+  return _replayed;
+}
+
+uint32_t MQTTTask::getBufferDropped() const {
+  return _bufferDropped;
+}
+
+void MQTTTask::publishStatus() {
+  // Once per interval, allocated here rather than kept for the lifetime of the task
+  DynamicJsonDocument status(MQTT_STATUS_SIZE);
+  status["uptime"]         = (uint32_t)(esp_timer_get_time() / 1000000);
+  status["free_heap"]      = ESP.getFreeHeap();
+  status["min_free_heap"]  = ESP.getMinFreeHeap();
+  status["max_alloc_heap"] = ESP.getMaxAllocHeap();
+  if (WiFi.status() == WL_CONNECTED) {
+    status["wifi_rssi"] = WiFi.RSSI();
+  }
+
+  // Bytes of stack never used by each task since it started
+  JsonObject stacks = status.createNestedObject("stack_free");
+  for (FreeRTOSTask *task : _system.getTaskManager().getFreeRTOSTasks()) {
+    if (task->handle != NULL) {
+      stacks[task->getName()] = uxTaskGetStackHighWaterMark(task->handle);
+    }
+  }
+
+  JsonObject queues  = status.createNestedObject("queues");
+  JsonObject packets = status.createNestedObject("packets");
+  uint32_t   dropped = 0;
+  for (size_t i = 0; i < _bus.getSubscriberCount(); i++) {
+    const PacketBus::Subscriber *sub = _bus.getSubscriber(i);
+    queues[sub->getName()]           = sub->getLag();
+    dropped += sub->getDropCount();
+  }
+  queues["packet_pool"]     = _system.getPacketPool()->getInUse();
+  queues["mqtt_buffer"]     = _ring.getCount();
+  packets["bus_dropped"]    = dropped;
+  packets["pool_exhausted"] = _system.getPacketPool()->getExhaustedCount();
+  packets["mqtt_published"] = _published;
+  packets["mqtt_lost"]      = _bufferDropped;
+
+  if (_statusCallback != NULL) {
+    _statusCallback(status.as<JsonObject>());
+  }
+
+  String topic  = _topic + "/status";
+  size_t length = _msgPack ? measureMsgPack(status) : measureJson(status);
+  char  *buffer = new char[length + 1];
+  if (_msgPack) {
+    serializeMsgPack(status, buffer, length + 1);
+  } else {
+    serializeJson(status, buffer, length + 1);
+  }
+  // Not counted with the packets
+  if (!_MQTT.beginPublish(topic.c_str(), length, _system.getUserConfig()->mqtt.retain) || _MQTT.write((const uint8_t *)buffer, length) != length || !_MQTT.endPublish()) {
+    APP_LOGW(getName(), "Could not publish the status.");
+  }
+  delete[] buffer;
+}
+
+bool MQTTTask::isMsgPack() const {
+  return _msgPack;
+}
+
+const RunningStats &MQTTTask::getSerializeTime() const {
+  return _serializeTime;
+}
+
+const RunningStats &MQTTTask::getPayloadSize() const {
+  return _payloadSize;
+}
+
+const RunningStats &MQTTTask::getJsonSize() const {
+  return _jsonSize;
+}
+
+const RecordRing &MQTTTask::getBuffer() const {
+  return _ring;
+}
+
+const Spool &MQTTTask::getSpool() const {
+  return _spool;
 }
@@ -2,21 +2,152 @@
 #define TASK_MQTT_H_
 
 #include <APRSMessage.h>
+#include <ArduinoJson.h>
+#include <PacketBus.h>
+#include <PacketPool.h>
 #include <PubSubClient.h>
+#include <RecordRing.h>
+#include <RunningStats.h>
+#include <Spool.h>
 #include <TaskManager.h>
 #include <WiFi.h>
 
 class MQTTTask : public FreeRTOSTask {
 public:
-  MQTTTask(UBaseType_t priority, BaseType_t coreId, const bool displayOnScreen, System &system, QueueHandle_t &toMQTT);
+  /**
+   * @brief Adds the fields only known by its owner (the counters of the other tasks) to a status record.
+   */
+  typedef void (*StatusCallback)(JsonObject status);
+
+  MQTTTask(UBaseType_t priority, BaseType_t coreId, const bool displayOnScreen, System &system, PacketBus &bus, StatusCallback statusCallback = NULL);
 
   void worker() override;
 
+  uint32_t getPublished() const;
+  uint32_t getPublishedBytes() const;
+  uint32_t getPublishFailures() const;
+
+  /**
+   * @brief Packets dropped because the task did not read the bus fast enough.
+   */
+  uint32_t getDropCount() const;
+
+  /**
+   * @brief Packets kept while the broker could not be reached, and the ones published afterwards.
+   */
+  uint32_t getBuffered() const;
+  uint32_t getReplayed() const;
+
+  /**
+   * @brief Packets lost because the buffer (and the spool, if enabled) was full.
+   */
+  uint32_t getBufferDropped() const;
+
+  bool isMsgPack() const;
+
+  /**
+   * @brief     Builds the document published for a packet: its header fields, its body and, if it was received, its reception
+   *            metrics. Shared with the host benchmark of the encodings.
+   */
+  static void buildDocument(Packet *packet, JsonDocument &doc);
+
+  /**
+   * @brief Time (in us) to build and encode the payload of each packet.
+   */
+  const RunningStats &getSerializeTime() const;
+
+  /**
+   * @brief Size (in bytes) of each payload, and of the same payload in JSON when MessagePack is used.
+   */
+  const RunningStats &getPayloadSize() const;
+  const RunningStats &getJsonSize() const;
+
+  const RecordRing &getBuffer() const;
+  const Spool      &getSpool() const;
+
 private:
-  System        &_system;
-  WiFiClient     _client;
-  QueueHandle_t &_toMQTT;
-  PubSubClient   _MQTT;
+  static constexpr size_t PAYLOAD_SIZE = 512;
+  static constexpr size_t RECORD_SIZE  = PAYLOAD_SIZE + 128; // "<topic>\t<payload>"
+
+  bool connect();
+
+  /**
+   * @brief     Serializes a packet into the payload buffer.
+   *
+   * @param[out] topic The topic to publish the packet to.
+   *
+   * @return    The length of the payload, 0 if the packet is too large.
+   */
+  size_t serialize(Packet *packet, const String **topic);
+
+  /**
+   * @brief     Streams a payload to the broker.
+   */
+  bool send(const char *topic, const char *payload, size_t length);
+
+  /**
+   * @brief     Keeps the payload to publish it once the broker is back. When the RAM buffer is full its oldest packets are moved
+   *            to the spool, or dropped if the spool is disabled.
+   */
+  void buffer(const String &topic, size_t length);
+
+  /**
+   * @brief     Moves a record to the spool.
+   */
+  void spill(const char *record, size_t length);
+
+  /**
+   * @brief     Decodes a MessagePack payload read from the spool into the payload buffer.
+   *
+   * @return    The length of the payload.
+   */
+  size_t decodeHex(const char *hex, size_t length);
+
+  /**
+   * @brief     Publishes the buffered packets allowed by the replay rate, oldest first.
+   */
+  void replayBuffer();
+
+  bool isBufferEmpty() const;
+
+  /**
+   * @brief     Publishes the health of the system to <topic>/status.
+   */
+  void publishStatus();
+
+  System                &_system;
+  WiFiClient             _client;
+  PacketBus             &_bus;
+  PacketBus::Subscriber *_toMQTT;
+  PubSubClient           _MQTT;
+  uint32_t               _nextAttempt; // millis() of the next connection attempt
+  const bool             _msgPack;
+  StatusCallback         _statusCallback;
+  uint32_t               _lastStatus; // millis()
+
+  String              _topic;       // Built once, the configuration does not change
+  String              _sourceTopic; // _topic followed by the source of the packet
+  DynamicJsonDocument _doc;         // Reused for every packet
+  char                _payload[PAYLOAD_SIZE];
+  RunningStats        _serializeTime;
+  RunningStats        _payloadSize;
+  RunningStats        _jsonSize;
+
+  // Everything in the spool was buffered before what is in the ring
+  RecordRing _ring;
+  Spool      _spool;
+  bool       _spoolEnabled;
+  char       _record[RECORD_SIZE];
+  float      _replayCredit; // Packets that can be published from the buffer
+  uint32_t   _liveCredit;   // Live packets queued behind the buffer while connected, published on top of _replayCredit
+  uint32_t   _lastReplay;   // millis()
+
+  uint32_t _published;
+  uint32_t _publishedBytes;
+  uint32_t _publishFailures;
+  uint32_t _buffered;
+  uint32_t _replayed;
+  uint32_t _bufferDropped;
 };
 
 #endif
@@ -3,6 +3,8 @@
 #include <SPIFFS.h>
 #include <WiFiMulti.h>
 #include <ctime>
+#include <esp_system.h>
+#include <esp_timer.h>
 #include <esp_https_server.h>
 #include <logger.h>
 #include <queue>
@@ -13,7 +15,23 @@
 #include "TaskPacketLogger.h"
 #include "project_configuration.h"
 
-PacketLoggerTask::PacketLoggerTask(UBaseType_t priority, BaseType_t coreId, const bool displayOnScreen, System &system, const String filename, QueueHandle_t &toPacketLogger) : FreeRTOSTask(TASK_PACKET_LOGGER, TaskPacketLogger, priority, 3072, coreId, displayOnScreen), _counter(0), _curr_tail_length(0), _total_count(0), _filename(filename), _tail(""), _system(system), _toPacketLogger(toPacketLogger) {
+#define LOG_FLUSH_SIZE 2048 // Bytes buffered before they are written, a multiple of the SPIFFS page size
+#define LOG_FLUSH_MS   5000 // Maximum time a line stays in RAM
+#define LOG_INDEX_STEP 32   // Records between two entries of the binary log index
+
+PacketLoggerTask *PacketLoggerTask::_instance = NULL;
+
+PacketLoggerTask::PacketLoggerTask(UBaseType_t priority, BaseType_t coreId, const bool displayOnScreen, System &system, const String filename, PacketBus &bus) : FreeRTOSTask(TASK_PACKET_LOGGER, TaskPacketLogger, priority, 4096, coreId, displayOnScreen), _counter(0), _curr_tail_length(0), _total_count(0), _filename(filename), _tail(""), _system(system), _bus(bus), _toPacketLogger(bus.subscribe(TASK_PACKET_LOGGER, PacketBus::RfReceived | PacketBus::RfCorrupt)), _fileMutex(xSemaphoreCreateMutex()), _binary(system.getUserConfig()->packetLogger.format == "binary"), _binaryLog(NULL), _bufferedSince(0), _writtenBytes(0), _writeErrors(0) {
+  if (_binary) {
+    // Room for one more record after LOG_FLUSH_SIZE, so that the buffer is only written by writeBuffer()
+    _binaryLog = new BinaryLog(SPIFFS, LOG_INDEX_STEP, LOG_FLUSH_SIZE + 512);
+    if (_filename.endsWith(".log")) {
+      _filename.remove(_filename.length() - 4);
+    }
+    _filename += ".bin";
+  } else {
+    _writeBuffer.reserve(LOG_FLUSH_SIZE + 256);
+  }
   _nb_lines        = _system.getUserConfig()->packetLogger.nb_lines;
   _nb_files        = _system.getUserConfig()->packetLogger.nb_files;
   _max_tail_length = std::min<size_t>(system.getUserConfig()->packetLogger.tail_length, _nb_lines);
@@ -21,6 +39,13 @@ PacketLoggerTask::PacketLoggerTask(UBaseType_t priority, BaseType_t coreId, cons
 }
 
 PacketLoggerTask::~PacketLoggerTask() {
+  flush();
+  _file.close();
+  delete _binaryLog;
+  vSemaphoreDelete(_fileMutex);
+  if (_instance == this) {
+    _instance = NULL;
+  }
 }
 
 void PacketLoggerTask::worker() {
@@ -39,6 +64,132 @@ void PacketLoggerTask::worker() {
     return;
   }
 
+  bool opened = _binary ? openBinaryLog() : openTsvLog();
+  if (!opened) {
+    return; // _state and _stateInfo were set by the failed step
+  }
+  // The lines still in RAM are written before a restart
+  _instance = this;
+  esp_register_shutdown_handler(shutdownHandler);
+
+  _stateInfo = "Running";
+  for (;;) {
+    // Wait untill we have an entry to add to log, or until the buffer must be written
+    TickType_t timeout = portMAX_DELAY;
+    if (getBuffered() > 0) {
+      uint32_t age = millis() - _bufferedSince;
+      timeout      = (age < LOG_FLUSH_MS) ? pdMS_TO_TICKS(LOG_FLUSH_MS - age) : 0;
+    }
+    uint32_t topics;
+    Packet  *packet = _bus.receive(_toPacketLogger, timeout, &topics);
+    if (packet == NULL) {
+      flush();
+      continue;
+    }
+    int64_t start = esp_timer_get_time();
+
+    struct tm timeInfo;
+    gmtime_r(&packet->rx.rxTime, &timeInfo);
+
+    if (_counter >= _nb_lines) {
+      // The buffered lines belong to the file being rotated
+      xSemaphoreTake(_fileMutex, portMAX_DELAY);
+      writeBuffer();
+      bool rotated;
+      if (_binary) {
+        // Sequence numbers keep increasing across files
+        uint32_t nextSeq = _binaryLog->getNextSeq();
+        _binaryLog->close();
+        rotated = rotate() && _binaryLog->create("/" + _filename, nextSeq);
+      } else {
+        _file.close();
+        rotated = rotate();
+        if (rotated) {
+          _file   = SPIFFS.open("/" + _filename, "a");
+          rotated = _file;
+        }
+      }
+      xSemaphoreGive(_fileMutex);
+      if (!rotated) {
+        packet->release();
+        while (true) {
+          vTaskDelay(portMAX_DELAY);
+        }
+      }
+      _counter = 0;
+    }
+
+    int   lineLength;
+    char *line = NULL;
+    char  timestamp[21];
+    strftime(timestamp, sizeof(timestamp), "%FT%TZ", &timeInfo);
+    const char fmt[] = "%zu" /* counter */ SEPARATOR "%s" /* timestamp*/ SEPARATOR "%s" /* callsign */ SEPARATOR //
+                       "%s" /* target */ SEPARATOR "%s" /* path */ SEPARATOR "%s" /* data */ SEPARATOR           //
+                       "%.1f" /* RSSI */ SEPARATOR "%.1f" /* SNR */ SEPARATOR "%.1f\n" /* freq_error */;
+
+    /* Create line buffer */
+    if (_binary) {
+      line = formatRecord(packet, topics & PacketBus::RfCorrupt);
+    } else if (topics & PacketBus::RfCorrupt) {
+      lineLength = snprintf(nullptr, 0, fmt, _counter, timestamp, " ", //
+                            " ", " ", "INVALID PACKET", packet->rx.rssi, packet->rx.snr, packet->rx.freqError);
+      if (lineLength > 0) {
+        line = new char[lineLength + 1];
+        if (line != NULL) {
+          snprintf(line, lineLength + 1, fmt, _counter, timestamp, " ", //
+                   " ", " ", "INVALID PACKET", packet->rx.rssi, packet->rx.snr, packet->rx.freqError);
+        }
+      }
+    } else {
+      APRSMessage *msg = &packet->msg;
+      lineLength       = snprintf(nullptr, 0, fmt, _counter, timestamp, msg->getSource().c_str(),                         //
+                                  msg->getDestination().c_str(), msg->getPath().c_str(), msg->getRawBody().c_str(), //
+                                  packet->rx.rssi, packet->rx.snr, packet->rx.freqError);
+      if (lineLength > 0) {
+        line = new char[lineLength + 1];
+        if (line != NULL) {
+          snprintf(line, lineLength + 1, fmt, _counter, timestamp, msg->getSource().c_str(),               //
+                   msg->getDestination().c_str(), msg->getPath().c_str(), msg->getRawBody().c_str(), //
+                   packet->rx.rssi, packet->rx.snr, packet->rx.freqError);
+        }
+      }
+    }
+
+    /* print the line to file and tail */
+    if (line != NULL) {
+      /* remove oldest line from _tail if it already is the max length */
+      if (_curr_tail_length >= _max_tail_length) {
+        _tail = _tail.substring(_tail.indexOf("\n") + 1);
+      } else {
+        _curr_tail_length++;
+      }
+      _tail += line;
+
+      xSemaphoreTake(_fileMutex, portMAX_DELAY);
+      if (getBuffered() == 0) {
+        _bufferedSince = millis();
+      }
+      if (!_binary) {
+        _writeBuffer += line;
+      } else if (!_binaryLog->append(_record)) {
+        _writeErrors++;
+      }
+      if (getBuffered() >= LOG_FLUSH_SIZE) {
+        writeBuffer();
+      }
+      xSemaphoreGive(_fileMutex);
+      delete[] line;
+    }
+
+    packet->release();
+    _counter++;
+    _total_count++;
+    _lineTime.add(esp_timer_get_time() - start);
+    _stateInfo = "Logged " + String(_total_count) + " packets since the device started";
+  }
+}
+
+bool PacketLoggerTask::openTsvLog() {
   File csv_file;
   if (!SPIFFS.exists("/" + _filename)) {
     APP_LOGD(getName(), "CSV file did not exist. Creating it...");
@@ -47,7 +198,7 @@ void PacketLoggerTask::worker() {
       APP_LOGD(getName(), "Could not create the file...");
       _state     = Error;
       _stateInfo = "File error";
-      return;
+      return false;
     }
     csv_file.println(HEADER);
     csv_file.close();
@@ -57,7 +208,7 @@ void PacketLoggerTask::worker() {
       APP_LOGD(getName(), "Could not open the csv file to read it.");
       _state     = Error;
       _stateInfo = "File error";
-      return;
+      return false;
     }
     if (csv_file.size() < HEADER.length()) {
       APP_LOGD(getName(), "File size is %d, which is less than header length. Recreating file.", csv_file.size());
@@ -69,7 +220,7 @@ void PacketLoggerTask::worker() {
         APP_LOGE(getName(), "Could not re-open file after having removed it...");
         _state     = Error;
         _stateInfo = "File error";
-        return;
+        return false;
       }
       csv_file.println(HEADER);
       csv_file.close();
@@ -90,7 +241,7 @@ void PacketLoggerTask::worker() {
             APP_LOGE(getName(), "Could not re-open file after having removed it...");
             _state     = Error;
             _stateInfo = "File error";
-            return;
+            return false;
           }
           csv_file.println(HEADER);
           parse_number = false;
@@ -116,90 +267,180 @@ void PacketLoggerTask::worker() {
       getTail(false);
     }
   }
-  _stateInfo = "Running";
-  logEntry entry;
-  for (;;) {
-    // Wait untill we have an entry to add to log
-    xQueueReceive(_toPacketLogger, &entry, portMAX_DELAY);
+  _file = SPIFFS.open("/" + _filename, "a");
+  if (!_file) {
+    APP_LOGE(getName(), "Could not open csv file to log packets...");
+    _stateInfo = "Could not open csv file to log packets";
+    _state     = Error;
+    return false;
+  }
+  return true;
+}
 
-    struct tm timeInfo;
-    gmtime_r(&entry.rxTime, &timeInfo);
+bool PacketLoggerTask::openBinaryLog() {
+  String path = "/" + _filename;
+  if (_binaryLog->open(path)) {
+    _counter = _binaryLog->getCount();
+    APP_LOGD(getName(), "Binary log holds %u packets, next sequence number is %u.", _counter, _binaryLog->getNextSeq());
+    getTail(false);
+    return true;
+  }
 
-    if (_counter >= _nb_lines) {
-      if (!rotate()) {
-        while (true) {
-          vTaskDelay(portMAX_DELAY);
-        }
-      }
-      _counter = 0;
+  // Never reuse a sequence number of the history, even when the log is missing or too damaged to hold one
+  uint32_t nextSeq = _binaryLog->getNextSeq();
+  uint32_t historySeq;
+  if (_nb_files > 0 && BinaryLog::findNextSeq(SPIFFS, path + ".0", &historySeq)) {
+    nextSeq = std::max(nextSeq, historySeq);
+  }
+  if (SPIFFS.exists(path)) {
+    // Damaged by a power loss: keep it in the history, the records before the damage can still be read
+    APP_LOGW(getName(), "Binary log is damaged, starting a new one at %u.", nextSeq);
+    if (!rotate()) {
+      _state = Error;
+      return false;
     }
-    csv_file = SPIFFS.open("/" + _filename, "a");
-    if (!csv_file) {
-      APP_LOGE(getName(), "Could not open csv file to log packets...");
-      _stateInfo = "Could not open csv file to log packets";
-      _state     = Error;
+  }
+  if (!_binaryLog->create(path, nextSeq)) {
+    APP_LOGE(getName(), "Could not create the binary log...");
+    _state     = Error;
+    _stateInfo = "File error";
+    return false;
+  }
+  _counter = 0;
+  return true;
+}
+
+char *PacketLoggerTask::formatRecord(Packet *packet, bool corrupt) {
+  _record.seq         = _binaryLog->getNextSeq();
+  _record.rxTime      = packet->rx.rxTime;
+  _record.rssi        = packet->rx.rssi;
+  _record.snr         = packet->rx.snr;
+  _record.freqError   = packet->rx.freqError;
+  _record.crcOk       = !corrupt;
+  _record.frameLength = 0;
+  if (!corrupt) {
+    String frame        = packet->msg.encode();
+    _record.frameLength = std::min<size_t>(frame.length(), BinaryLog::MAX_FRAME);
+    memcpy(_record.frame, frame.c_str(), _record.frameLength);
+  }
+  _record.frame[_record.frameLength] = '\0';
+
+  char   buffer[BinaryLog::MAX_FRAME + 128];
+  size_t length = BinaryLog::toTsv(_record, buffer, sizeof(buffer));
+  char  *line   = new char[length + 1];
+  memcpy(line, buffer, length);
+  line[length] = '\0';
+  return line;
+}
+
+void PacketLoggerTask::flush() {
+  xSemaphoreTake(_fileMutex, portMAX_DELAY);
+  writeBuffer();
+  xSemaphoreGive(_fileMutex);
+}
+
+void PacketLoggerTask::writeBuffer() {
+  if (_binary) {
+    size_t buffered = _binaryLog->getBuffered();
+    if (buffered == 0) {
       return;
     }
 
-    int   lineLength;
-    char *line = NULL;
-    char  timestamp[21];
-    strftime(timestamp, sizeof(timestamp), "%FT%TZ", &timeInfo);
-    const char fmt[] = "%zu" /* counter */ SEPARATOR "%s" /* timestamp*/ SEPARATOR "%s" /* callsign */ SEPARATOR //
-                       "%s" /* target */ SEPARATOR "%s" /* path */ SEPARATOR "%s" /* data */ SEPARATOR           //
-                       "%.1f" /* RSSI */ SEPARATOR "%.1f" /* SNR */ SEPARATOR "%.1f\n" /* freq_error */;
+    int64_t start = esp_timer_get_time();
+    bool    ok    = _binaryLog->flush();
+    _flushTime.add(esp_timer_get_time() - start);
 
-    /* Create line buffer */
-    if (entry.msg == NULL) {
-      lineLength = snprintf(nullptr, 0, fmt, _counter, timestamp, " ", //
-                            " ", " ", "INVALID PACKET", entry.rssi, entry.snr, entry.freq_error);
-      if (lineLength > 0) {
-        line = new char[lineLength + 1];
-        if (line != NULL) {
-          snprintf(line, lineLength + 1, fmt, _counter, timestamp, " ", //
-                   " ", " ", "INVALID PACKET", entry.rssi, entry.snr, entry.freq_error);
-        }
-      }
+    if (!ok) {
+      APP_LOGE(getName(), "Could not write %u bytes to the binary log.", buffered);
+      _writeErrors++;
     } else {
-      lineLength = snprintf(nullptr, 0, fmt, _counter, timestamp, entry.msg->getSource().c_str(),                               //
-                            entry.msg->getDestination().c_str(), entry.msg->getPath().c_str(), entry.msg->getRawBody().c_str(), //
-                            entry.rssi, entry.snr, entry.freq_error);
-      if (lineLength > 0) {
-        line = new char[lineLength + 1];
-        if (line != NULL) {
-          snprintf(line, lineLength + 1, fmt, _counter, timestamp, entry.msg->getSource().c_str(),                     //
-                   entry.msg->getDestination().c_str(), entry.msg->getPath().c_str(), entry.msg->getRawBody().c_str(), //
-                   entry.rssi, entry.snr, entry.freq_error);
-        }
-      }
+      _writtenBytes += buffered;
     }
+    return;
+  }
 
-    /* print the line to file and tail */
-    if (line != NULL) {
-      /* remove oldest line from _tail if it already is the max length */
-      if (_curr_tail_length >= _max_tail_length) {
-        _tail = _tail.substring(_tail.indexOf("\n") + 1);
-      } else {
-        _curr_tail_length++;
-      }
-      _tail += line;
-      csv_file.print(line);
-      delete line;
-    }
+  if (_writeBuffer.isEmpty() || !_file) {
+    return;
+  }
+
+  int64_t start   = esp_timer_get_time();
+  size_t  written = _file.write((const uint8_t *)_writeBuffer.c_str(), _writeBuffer.length());
+  _file.flush();
+  _flushTime.add(esp_timer_get_time() - start);
+
+  if (written != _writeBuffer.length()) {
+    APP_LOGE(getName(), "Could only write %u of %u bytes to the log file.", written, _writeBuffer.length());
+    _writeErrors++;
+  }
+  _writtenBytes += written;
+  // Keeps the buffer of the String
+  _writeBuffer = "";
+}
 
-    if (entry.msg != NULL) {
-      delete entry.msg;
+void PacketLoggerTask::shutdownHandler() {
+  // The logger task may be holding the mutex while the restart happens, do not wait for it
+  if (_instance != NULL && xSemaphoreTake(_instance->_fileMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+    _instance->writeBuffer();
+    _instance->_file.close();
+    if (_instance->_binaryLog != NULL) {
+      _instance->_binaryLog->close();
     }
-    csv_file.close();
-    _counter++;
-    _total_count++;
-    _stateInfo = "Logged " + String(_total_count) + " packets since the device started";
+    xSemaphoreGive(_instance->_fileMutex);
   }
 }
 
+size_t PacketLoggerTask::getBuffered() const {
+  return _binary ? _binaryLog->getBuffered() : _writeBuffer.length();
+}
+
+uint32_t PacketLoggerTask::getLoggedLines() const {
+  return _total_count;
+}
+
+uint32_t PacketLoggerTask::getWrittenBytes() const {
+  return _writtenBytes;
+}
+
+uint32_t PacketLoggerTask::getWriteErrors() const {
+  return _writeErrors;
+}
+
+const RunningStats &PacketLoggerTask::getFlushTime() const {
+  return _flushTime;
+}
+
+const RunningStats &PacketLoggerTask::getLineTime() const {
+  return _lineTime;
+}
+
 bool PacketLoggerTask::rotate() {
+  if (!rotateFiles("") || (_binary && !rotateFiles(".idx"))) {
+    return false;
+  }
+  if (_binary) {
+    // The caller creates the new binary log
+    return true;
+  }
+
+  File csv_file = SPIFFS.open("/" + _filename, "w", true);
+  if (!csv_file) {
+    _stateInfo = String("(") + __FILE__ + ":" + __LINE__ + ") Could not open file.";
+    return false;
+  }
+  csv_file.println(HEADER);
+  csv_file.close();
+
+  return true;
+}
+
+bool PacketLoggerTask::rotateFiles(const char *suffix) {
+  // "/packets.log" goes to "/packets.log.0", "/packets.bin.idx" to "/packets.bin.0.idx"
+  char target_file[32] = {0};
+  char origin_file[32] = {0};
+  snprintf(origin_file, 32, "/%s%s", _filename.c_str(), suffix);
+
   if (_nb_files == 0) {
-    if (SPIFFS.remove("/" + _filename) == ESP_OK) {
+    if (!SPIFFS.exists(origin_file) || SPIFFS.remove(origin_file)) {
       return true;
     } else {
       _stateInfo = String("(") + __FILE__ + ":" + __LINE__ + ") Could not remove file.";
@@ -208,9 +449,7 @@ bool PacketLoggerTask::rotate() {
   }
 
   // Remove oldest file if it exists
-  char target_file[32] = {0};
-  char origin_file[32] = {0};
-  snprintf(origin_file, 32, "/%s.%zu", _filename.c_str(), _nb_files - 1);
+  snprintf(origin_file, 32, "/%s.%zu%s", _filename.c_str(), _nb_files - 1, suffix);
 
   if (SPIFFS.exists(origin_file)) {
     if (SPIFFS.remove(origin_file) == true) {
@@ -223,8 +462,8 @@ bool PacketLoggerTask::rotate() {
   }
 
   for (int i = _nb_files - 1; i > 0; i--) {
-    snprintf(origin_file, 32, "/%s.%d", _filename.c_str(), i - 1);
-    snprintf(target_file, 32, "/%s.%d", _filename.c_str(), i);
+    snprintf(origin_file, 32, "/%s.%d%s", _filename.c_str(), i - 1, suffix);
+    snprintf(target_file, 32, "/%s.%d%s", _filename.c_str(), i, suffix);
     if (SPIFFS.exists(origin_file)) {
       if (SPIFFS.rename(origin_file, target_file) == false) {
         APP_LOGE(getName(), "Error while renaming file %s to %s.", origin_file, target_file);
@@ -236,23 +475,18 @@ bool PacketLoggerTask::rotate() {
     }
   }
 
-  snprintf(origin_file, 32, "/%s", _filename.c_str());
-  snprintf(target_file, 32, "/%s.0", _filename.c_str());
+  snprintf(origin_file, 32, "/%s%s", _filename.c_str(), suffix);
+  snprintf(target_file, 32, "/%s.0%s", _filename.c_str(), suffix);
 
+  if (*suffix != '\0' && !SPIFFS.exists(origin_file)) {
+    // Lost index, the history is still readable without it
+    return true;
+  }
   if (!SPIFFS.rename(origin_file, target_file)) {
     APP_LOGE(getName(), "Error while renaming file %s to %s.", origin_file, target_file);
     _stateInfo = String("(") + __FILE__ + ":" + __LINE__ + ") Could not rename file.";
     return false;
   }
-
-  File csv_file = SPIFFS.open(origin_file, "w", true);
-  if (!csv_file) {
-    _stateInfo = String("(") + __FILE__ + ":" + __LINE__ + ") Could not open file.";
-    return false;
-  }
-  csv_file.println(HEADER);
-  csv_file.close();
-
   return true;
 }
 
@@ -262,6 +496,25 @@ String PacketLoggerTask::getTail(bool use_cache) {
   }
 
   _tail.clear();
+  _curr_tail_length = 0;
+
+  if (_binary) {
+    // Constant time: one index read and less than LOG_INDEX_STEP records skipped
+    BinaryLog::Reader reader(SPIFFS);
+    uint32_t          length = min<uint>(_max_tail_length, _counter);
+    if (!reader.open("/" + _filename) || !reader.seek(_binaryLog->getNextSeq() - length)) {
+      return _tail;
+    }
+    BinaryLog::Record record;
+    char              line[BinaryLog::MAX_FRAME + 128];
+    while (reader.next(record)) {
+      if (BinaryLog::toTsv(record, line, sizeof(line)) > 0) {
+        _tail += line;
+        _curr_tail_length++;
+      }
+    }
+    return _tail;
+  }
 
   File csv_file = SPIFFS.open("/" + _filename, "r");
   if (!csv_file) {
@@ -294,10 +547,39 @@ String PacketLoggerTask::getTail(bool use_cache) {
 }
 
 bool PacketLoggerTask::getFullLogs(httpd_req_t *req) {
+  // The download must include the lines still in RAM
+  flush();
+
   httpd_resp_set_type(req, "text/plain");
   httpd_resp_set_hdr(req, "Content-Disposition", "attachment; filename=\"packets.log\"");
   httpd_resp_sendstr_chunk(req, HEADER.c_str());
 
+  if (_binary) {
+    // "?from=<sequence number>" and "?since=<UNIX time>" skip the older packets without reading them
+    uint32_t from  = 0;
+    uint32_t since = 0;
+    char     query[64];
+    char     value[16];
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK) {
+      if (httpd_query_key_value(query, "from", value, sizeof(value)) == ESP_OK) {
+        from = strtoul(value, NULL, 10);
+      }
+      if (httpd_query_key_value(query, "since", value, sizeof(value)) == ESP_OK) {
+        since = strtoul(value, NULL, 10);
+      }
+    }
+
+    char file[32];
+    for (int i = _nb_files - 1; i >= 0; i--) {
+      snprintf(file, sizeof(file), "/%s.%d", _filename.c_str(), i);
+      sendBinaryLog(req, file, from, since);
+    }
+    snprintf(file, sizeof(file), "/%s", _filename.c_str());
+    sendBinaryLog(req, file, from, since);
+    httpd_resp_sendstr_chunk(req, NULL);
+    return true;
+  }
+
   size_t counter = 0;
   File   csv_file;
   String log_line;
@@ -338,8 +620,22 @@ bool PacketLoggerTask::getFullLogs(httpd_req_t *req) {
   return true;
 }
 
-logEntry::logEntry() : msg(NULL), rxTime(0), rssi(0), snr(0), freq_error(0) {
-}
+void PacketLoggerTask::sendBinaryLog(httpd_req_t *req, const char *path, uint32_t from, uint32_t since) {
+  BinaryLog::Reader reader(SPIFFS);
+  if (!reader.open(path)) {
+    return;
+  }
+  // A failed seek means that every packet of this file is older
+  if ((from > 0 && !reader.seek(from)) || (since > 0 && !reader.seekTime(since))) {
+    return;
+  }
 
-logEntry::logEntry(APRSMessage *msg, time_t rxTime, float rssi, float snr, float freq_error) : msg(msg), rxTime(rxTime), rssi(rssi), snr(snr), freq_error(freq_error) {
+  // Records keep their sequence number, unlike the TSV lines no renumbering is needed
+  BinaryLog::Record record;
+  char              line[BinaryLog::MAX_FRAME + 128];
+  while (reader.next(record)) {
+    if (BinaryLog::toTsv(record, line, sizeof(line)) > 0) {
+      httpd_resp_sendstr_chunk(req, line);
+    }
+  }
 }
@@ -2,10 +2,14 @@
 #define PACKET_LOGGER_H_
 
 #include <APRSMessage.h>
+#include <BinaryLog.h>
 #include <FS.h>
+#include <PacketBus.h>
+#include <RunningStats.h>
 #include <TaskManager.h>
 #include <WiFiMulti.h>
 #include <esp_https_server.h>
+#include <freertos/semphr.h>
 #include <queue>
 #include <stdio.h>
 
@@ -14,7 +18,7 @@
 class PacketLoggerTask : public FreeRTOSTask {
 
 public:
-  PacketLoggerTask(UBaseType_t priority, BaseType_t coreId, const bool displayOnScreen, System &system, const String filename, QueueHandle_t &queueHandle);
+  PacketLoggerTask(UBaseType_t priority, BaseType_t coreId, const bool displayOnScreen, System &system, const String filename, PacketBus &bus);
   virtual ~PacketLoggerTask();
 
   void worker() override;
@@ -22,8 +26,49 @@ public:
   String getTail(bool use_cache = true);
   bool   getFullLogs(httpd_req_t *req);
 
+  /**
+   * @brief     Writes the lines buffered in RAM to the log file. Can be called from any task.
+   */
+  void flush();
+
+  uint32_t getLoggedLines() const;
+  uint32_t getWrittenBytes() const;
+  uint32_t getWriteErrors() const;
+
+  /**
+   * @brief     Time (in us) of each write of the buffer to the file.
+   */
+  const RunningStats &getFlushTime() const;
+
+  /**
+   * @brief     Time (in us) to log each line, including the writes it triggered.
+   */
+  const RunningStats &getLineTime() const;
+
 private:
+  bool openTsvLog();
+  bool openBinaryLog();
   bool rotate();
+  bool rotateFiles(const char *suffix);
+
+  /**
+   * @brief     Fills _record with a packet and returns its TSV line for the tail (allocated with new[]).
+   */
+  char *formatRecord(Packet *packet, bool corrupt);
+
+  /**
+   * @brief     Streams a binary log file as TSV, starting at the given sequence number or time (if not 0).
+   */
+  void sendBinaryLog(httpd_req_t *req, const char *path, uint32_t from, uint32_t since);
+
+  size_t getBuffered() const;
+
+  /**
+   * @brief     Writes the buffer to the file, _fileMutex must be held.
+   */
+  void writeBuffer();
+
+  static void shutdownHandler();
 
   size_t         _nb_lines;
   size_t         _nb_files;
@@ -34,19 +79,24 @@ private:
   String         _filename;
   String         _tail;
   const String   HEADER = String("NUMBER" SEPARATOR "TIMESTAMP" SEPARATOR "CALLSIGN" SEPARATOR "TARGET" SEPARATOR "PATH" SEPARATOR "DATA" SEPARATOR "RSSI" SEPARATOR "SNR" SEPARATOR "FREQ_ERROR\n");
-  System        &_system;
-  QueueHandle_t &_toPacketLogger;
-};
+  System                &_system;
+  PacketBus             &_bus;
+  PacketBus::Subscriber *_toPacketLogger;
 
-struct logEntry {
-  logEntry();
-  logEntry(APRSMessage *msg, time_t rxTime, float rssi, float snr, float freq_error);
+  // The file stays open, lines are appended to the buffer and written in a single call once it is large or old enough
+  SemaphoreHandle_t _fileMutex;
+  File              _file;
+  String            _writeBuffer;
+  bool              _binary;    // packet_logger.format is "binary", _binaryLog replaces _file and _writeBuffer
+  BinaryLog        *_binaryLog; // Only allocated in binary mode
+  BinaryLog::Record _record;
+  uint32_t          _bufferedSince; // millis() of the oldest buffered line
+  uint32_t          _writtenBytes;
+  uint32_t          _writeErrors;
+  RunningStats      _flushTime;
+  RunningStats      _lineTime;
 
-  APRSMessage *msg;
-  time_t       rxTime;
-  float        rssi;
-  float        snr;
-  float        freq_error;
+  static PacketLoggerTask *_instance; // For the shutdown handler
 };
 
 #endif
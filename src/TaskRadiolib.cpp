@@ -1,32 +1,47 @@
 #include <Task.h>
 #include <ctime>
+#include <esp_timer.h>
 #include <logger.h>
 
 #include "System.h"
 #include "Task.h"
-#include "TaskDisplay.h"
-#include "TaskPacketLogger.h"
 #include "TaskRadiolib.h"
 
 int transmissionState = RADIOLIB_ERR_NONE;
 
-static xTaskHandle       taskToNotify      = NULL; // Used for direct-to-task notification when waiting for tx to complete
-static SemaphoreHandle_t radioIRQSemaphore = NULL; // Used by the task when waiting for an RX event to occur
+static SemaphoreHandle_t radioIRQSemaphore = NULL; // Given on every radio interrupt, RX or TX done
 static volatile bool     enableInterrupt   = true; // Need to catch interrupt or not.
+static volatile int64_t  lastIrqTime       = 0;    // esp_timer timestamp (us) of the last radio interrupt
+
+// Bits of RegModemStat telling that a LoRa frame is being received
+#define MODEM_STATUS_SIGNAL_DETECTED     0x01
+#define MODEM_STATUS_SIGNAL_SYNCHRONIZED 0x02
+#define MODEM_STATUS_HEADER_VALID        0x08
+
+#define TX_TIMEOUT_MARGIN_MS 1000 // Added to the airtime of a frame before giving up on its TX done interrupt
+
+static const uint8_t frameHeader[] = {'<', 0xff, 0x01};               // Header of the LoRa APRS frames
+static uint8_t       rxBuffer[RADIOLIB_SX127X_MAX_PACKET_LENGTH + 1]; // FIFO content, +1 for the NUL terminator
+
+// Maps each byte to its printable replacement
+static struct SanitizeTable {
+  SanitizeTable() {
+    for (size_t i = 0; i < sizeof(map); i++) {
+      map[i] = (i < ' ') ? ' ' : i;
+    }
+  }
+  uint8_t map[256];
+} sanitizeTable;
 
 static void radioCallback() {
   BaseType_t higherPriorityAwoken = pdFALSE;
-  if (taskToNotify == NULL) {
-    xSemaphoreGiveFromISR(radioIRQSemaphore, &higherPriorityAwoken);
-    portYIELD_FROM_ISR(higherPriorityAwoken);
-  } else {
-    vTaskNotifyGiveFromISR(taskToNotify, &higherPriorityAwoken);
-    portYIELD_FROM_ISR(higherPriorityAwoken);
-  }
+  lastIrqTime                     = esp_timer_get_time();
+  xSemaphoreGiveFromISR(radioIRQSemaphore, &higherPriorityAwoken);
+  portYIELD_FROM_ISR(higherPriorityAwoken);
 }
 
-RadiolibTask::RadiolibTask(UBaseType_t priority, BaseType_t coreId, const bool displayOnScreen, System &system, QueueHandle_t &fromModem, QueueHandle_t &toModem, QueueHandle_t &toPacketLogger, QueueHandle_t &toDisplay)
-    : FreeRTOSTask(TASK_RADIOLIB, TaskRadiolib, priority, 2560, coreId, displayOnScreen), module(NULL), radio(NULL), _system(system), config(system.getUserConfig()->lora), rxEnable(true), txEnable(config.tx_enable), _fromModem(fromModem), _toModem(toModem), _toPacketLogger(toPacketLogger), _toDisplay(toDisplay) {
+RadiolibTask::RadiolibTask(UBaseType_t priority, BaseType_t coreId, const bool displayOnScreen, System &system, PacketBus &bus, TxScheduler &scheduler)
+    : FreeRTOSTask(TASK_RADIOLIB, TaskRadiolib, priority, 2560, coreId, displayOnScreen), module(NULL), radio(NULL), _system(system), config(system.getUserConfig()->lora), rxEnable(true), txEnable(config.tx_enable), _bus(bus), _scheduler(scheduler), _rssiHistogram(-140, 10, 12), _snrHistogram(-20, 2.5, 16), _rxCount(0), _rxCorruptCount(0), _transmitting(false), _txDeadline(0), _txCount(0) {
   start();
 }
 
@@ -47,9 +62,7 @@ void RadiolibTask::worker() {
   float freqMHz = (float)config.frequencyRx / 1000000;
   float BWkHz   = (float)config.signalBandwidth / 1000;
 
-  const uint16_t preambleLength = 8;
-
-  int16_t state = radio->begin(freqMHz, BWkHz, config.spreadingFactor, config.codingRate4, RADIOLIB_SX127X_SYNC_WORD, config.power, preambleLength, config.gainRx);
+  int16_t state = radio->begin(freqMHz, BWkHz, config.spreadingFactor, config.codingRate4, RADIOLIB_SX127X_SYNC_WORD, config.power, LORA_PREAMBLE_LENGTH, config.gainRx);
   if (state != RADIOLIB_ERR_NONE) {
     switch (state) {
     case RADIOLIB_ERR_INVALID_FREQUENCY:
@@ -102,17 +115,16 @@ void RadiolibTask::worker() {
 
   portMUX_TYPE mutex = portMUX_INITIALIZER_UNLOCKED;
   taskENTER_CRITICAL(&mutex);
-  xQueueReset(_toModem);
-  UBaseType_t queueSetSize = 1; /* Queue size + 1 for the binary semaphore */
+  UBaseType_t queueSetSize = 1; /* 1 for the radio IRQ semaphore */
   if (_system.getUserConfig()->lora.tx_enable) {
-    queueSetSize += uxQueueSpacesAvailable(_toModem);
+    queueSetSize += 1; /* 1 for the semaphore signaling frames to transmit */
   }
 
   QueueSetHandle_t modemQueueSet = xQueueCreateSet(queueSetSize);
   bool             queueResult   = pdTRUE;
 
   if (_system.getUserConfig()->lora.tx_enable) {
-    queueResult &= xQueueAddToSet(_toModem, modemQueueSet);
+    queueResult &= xQueueAddToSet(_scheduler.getSignal(), modemQueueSet);
   }
 
   queueResult &= xQueueAddToSet(radioIRQSemaphore, modemQueueSet);
@@ -142,105 +154,182 @@ void RadiolibTask::worker() {
 
   _stateInfo = "";
 
+  _rxData.reserve(RADIOLIB_SX127X_MAX_PACKET_LENGTH);
+  _nextFrame.reserve(RADIOLIB_SX127X_MAX_PACKET_LENGTH);
+
   QueueSetMemberHandle_t activatedMember;
+  TickType_t             txWait = portMAX_DELAY; // Time until the scheduler may allow the next transmission
 
   for (;;) {
 
-    activatedMember = xQueueSelectFromSet(modemQueueSet, portMAX_DELAY);
+    if (_transmitting) {
+      // Only wake up on timeout if the TX done interrupt never comes
+      int64_t left = _txDeadline - esp_timer_get_time();
+      txWait       = (left > 0) ? pdMS_TO_TICKS(left / 1000) + 1 : 0;
+    }
+
+    activatedMember = xQueueSelectFromSet(modemQueueSet, txWait);
     time(&now);
     localtime_r(&now, &timeInfo);
     strftime(timeStr, sizeof(timeStr), "%T", &timeInfo);
-    if (activatedMember == radioIRQSemaphore) {
+    if (activatedMember == radioIRQSemaphore && _transmitting) {
+      xSemaphoreTake(radioIRQSemaphore, 0);
+      _transmitting = false;
+      if (transmissionState != RADIOLIB_ERR_NONE) {
+        APP_LOGE(getName(), "[%s] transmitFlag failed, code %d", timeStr, transmissionState);
+      } else {
+        _txCount++;
+        APP_LOGI(getName(), "[%s] TX done", timeStr);
+      }
+
+      if (_nextFrame.length() > 0) {
+        // Back-to-back frame, it was encoded while the previous one was sent
+        transmitNext(timeStr);
+      } else {
+        restartRX(timeStr);
+        if (rxEnable) {
+          _txTurnaround.add((uint32_t)(esp_timer_get_time() - lastIrqTime));
+          APP_LOGD(getName(), "[%s] Back to RX %uus after TX done", timeStr, _txTurnaround.getLast());
+        }
+      }
+
+    } else if (activatedMember == radioIRQSemaphore) {
       xSemaphoreTake(radioIRQSemaphore, 0);
-      String str;
-      int    state = radio->readData(str);
+      int64_t decodeStart = esp_timer_get_time();
+      size_t  length      = radio->getPacketLength();
+      int     state       = radio->readData(rxBuffer, length);
+      rxBuffer[length]    = '\0';
+
+      // Each metric is an SPI access, read them once for every consumer of the packet
+      RxMetadata rx;
+      rx.irqTime         = lastIrqTime;
+      rx.rxTime          = now;
+      rx.rssi            = radio->getRSSI();
+      rx.snr             = radio->getSNR();
+      rx.freqError       = radio->getFrequencyError();
+      rx.spreadingFactor = config.spreadingFactor;
+      rx.crcOk           = (state != RADIOLIB_ERR_CRC_MISMATCH);
+      if (state == RADIOLIB_ERR_NONE || state == RADIOLIB_ERR_CRC_MISMATCH) {
+        _rssiHistogram.add(rx.rssi);
+        _snrHistogram.add(rx.snr);
+      }
 
       if (state == RADIOLIB_ERR_CRC_MISMATCH) {
+        _rxCorruptCount++;
         // Log an error
         APP_LOGI(getName(), "[%s] Received corrupt packet (CRC check failed)", timeStr);
-        logEntry entry(NULL, now, radio->getRSSI(), radio->getSNR(), radio->getFrequencyError());
-        xQueueSend(_toPacketLogger, &entry, pdMS_TO_TICKS(100));
+        Packet *packet = _system.getPacketPool()->acquire();
+        if (packet != NULL) {
+          packet->origin = Packet::RF;
+          packet->rx     = rx;
+          _bus.publish(packet, PacketBus::RfCorrupt);
+          packet->release();
+        }
       } else if (state != RADIOLIB_ERR_NONE) {
         APP_LOGE(getName(), "[%s] readData failed, code %d", timeStr, state);
       } else {
-        if (str.substring(0, 3) != "<\xff\x01") {
-          APP_LOGD(getName(), "[%s] Unknown packet '%s' with RSSI %.0fdBm, SNR %.2fdB and FreqErr %fHz", timeStr, str.c_str(), radio->getRSSI(), radio->getSNR(), -radio->getFrequencyError());
+        _rxCount++;
+        const char *text = extractText(rxBuffer, length);
+        if (text == NULL) {
+          APP_LOGD(getName(), "[%s] Unknown packet '%s' with RSSI %.0fdBm, SNR %.2fdB and FreqErr %fHz", timeStr, (const char *)rxBuffer, rx.rssi, rx.snr, -rx.freqError);
         } else {
-          String msgData = str.substring(3);
-
-          // Replace all non-printable chars by spaces
-          for (char c = 0; c < ' '; c++) {
-            msgData.replace(String(c), " ");
+          // The String keeps its buffer between packets, assigning to it does not allocate once it is large enough
+          _rxData = text;
+
+          // Create the packet, it is shared by reference between the router, the logger, the display and MQTT
+          Packet *packet = _system.getPacketPool()->acquire();
+          if (packet == NULL) {
+            APP_LOGE(getName(), "[%s] Packet pool exhausted, received packet dropped", timeStr);
+          } else {
+            packet->origin = Packet::RF;
+            packet->rx     = rx;
+            packet->msg.decode(_rxData);
+            _decodeTime.add((uint32_t)(esp_timer_get_time() - decodeStart));
+
+            // Dispatch the packet, the bus never blocks the modem
+            _bus.publish(packet, PacketBus::RfReceived);
+
+            // Log the packet received in serial terminal
+            APP_LOGI(getName(), "[%s] Received packet '%s' with RSSI %.0fdBm, SNR %.2fdB and FreqErr %fHz", timeStr, packet->msg.toString().c_str(), rx.rssi, rx.snr, -rx.freqError);
+            packet->release();
           }
-
-          // Create the packets
-          APRSMessage *modemMsg = new APRSMessage();
-          modemMsg->decode(msgData);
-          APRSMessage *loggerMsg = new APRSMessage(*modemMsg);
-          logEntry     log(loggerMsg, now, radio->getRSSI(), radio->getSNR(), radio->getFrequencyError());
-
-          // Dispatch the packets
-          xQueueSend(_fromModem, &modemMsg, pdMS_TO_TICKS(100));
-          xQueueSend(_toPacketLogger, &log, pdMS_TO_TICKS(100));
-
-          // Log the packet received in serial terminal
-          APP_LOGI(getName(), "[%s] Received packet '%s' with RSSI %.0fdBm, SNR %.2fdB and FreqErr %fHz", timeStr, modemMsg->toString().c_str(), radio->getRSSI(), radio->getSNR(), -radio->getFrequencyError());
-
-          // Display the received packet on screen
-          TextFrame *frame = new TextFrame("LoRa", modemMsg->toString().c_str());
-          xQueueSendToBack(_toDisplay, &frame, pdTICKS_TO_MS(100));
         }
       }
-      if (rxEnable) {
-        int state = startRX(RADIOLIB_SX127X_RXCONTINUOUS);
-        if (state != RADIOLIB_ERR_NONE) {
-          APP_LOGE(getName(), "[%s] startRX failed, code %d", now, state);
-          rxEnable = false;
+      restartRX(timeStr);
+
+    } else if (activatedMember == _scheduler.getSignal()) {
+      /* The signal will not be in the set if tx is not enabled */
+      xSemaphoreTake(_scheduler.getSignal(), 0);
+    } else if (_transmitting && esp_timer_get_time() >= _txDeadline) {
+      APP_LOGE(getName(), "[%s] TX error: TX done interrupt not received", timeStr);
+      _transmitting = false;
+      _nextFrame    = "";
+      restartRX(timeStr);
+    } else {
+      // No member woken up, a backoff or the duty cycle delay expired
+    }
+
+    if (_transmitting) {
+      // Encode the next frame while the modem sends the current one, so it goes out as soon as the current one is done
+      if (_nextFrame.length() == 0 && _scheduler.hasPending() && _scheduler.getDelay(millis()) == 0) {
+        encodeNext(timeStr);
+      }
+    } else {
+      txWait = portMAX_DELAY;
+      if (txEnable && _scheduler.hasPending()) {
+        uint32_t delay = _scheduler.getDelay(millis());
+        if (delay == 0 && isChannelBusy()) {
+          delay = _scheduler.backoff(millis());
+          APP_LOGD(getName(), "[%s] Channel busy, transmission delayed by %ums", timeStr, delay);
+        }
+
+        if (delay > 0) {
+          txWait = pdMS_TO_TICKS(delay);
+        } else if (encodeNext(timeStr)) {
+          transmitNext(timeStr);
         }
       }
+    }
+  }
+}
 
-    } else if (activatedMember == _toModem) {
-      /* _toModem will not be in the set if tx is not enabled*/
-      APRSMessage *msg;
-      xQueueReceive(_toModem, &msg, 0);
+const char *RadiolibTask::extractText(uint8_t *frame, size_t length) {
+  if (length < sizeof(frameHeader) || memcmp(frame, frameHeader, sizeof(frameHeader)) != 0) {
+    return NULL;
+  }
+  // Replace all non-printable chars by spaces, in place and in a single pass. It also removes any NUL from the text.
+  for (size_t i = sizeof(frameHeader); i < length; i++) {
+    frame[i] = sanitizeTable.map[frame[i]];
+  }
+  return (const char *)&frame[sizeof(frameHeader)];
+}
 
-      APP_LOGD(getName(), "[%s] Transmitting packet '%s'", timeStr, msg->toString().c_str());
+const RunningStats &RadiolibTask::getDecodeTime() const {
+  return _decodeTime;
+}
 
-      // Transmit packet
-      int16_t state = startTX("<\xff\x01" + msg->encode());
-      if (state != RADIOLIB_ERR_NONE) {
-        APP_LOGE(getName(), "[%s] startTX failed, code %d", timeStr, state);
-        txEnable = false;
-      } else {
+const RunningStats &RadiolibTask::getTxTurnaround() const {
+  return _txTurnaround;
+}
 
-        /* Wait 10s max for tx to complete */
-        uint32_t txDone = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(10000));
-        time(&now);
-        localtime_r(&now, &timeInfo);
-        strftime(timeStr, sizeof(timeStr), "%T", &timeInfo);
-        if (txDone != 1) {
-          APP_LOGE(getName(), "TX error: Tx not finished after waiting 10s.");
-        } else if (transmissionState != RADIOLIB_ERR_NONE) {
-          APP_LOGE(getName(), "[%s] transmitFlag failed, code %d", timeStr, transmissionState);
-        } else {
-          APP_LOGI(getName(), "[%s] TX done", timeStr);
-        }
-      }
+const Histogram &RadiolibTask::getRssiHistogram() const {
+  return _rssiHistogram;
+}
 
-      if (rxEnable) {
-        int state = startRX(RADIOLIB_SX127X_RXCONTINUOUS);
-        if (state != RADIOLIB_ERR_NONE) {
-          APP_LOGE(getName(), "[%s] startRX failed, code %d", timeStr, state);
-          rxEnable = false;
-        }
-      }
+const Histogram &RadiolibTask::getSnrHistogram() const {
+  return _snrHistogram;
+}
 
-      delete msg;
+uint32_t RadiolibTask::getRxCount() const {
+  return _rxCount;
+}
 
-    } else {
-      // No member woken up
-    }
-  }
+uint32_t RadiolibTask::getRxCorruptCount() const {
+  return _rxCorruptCount;
+}
+
+uint32_t RadiolibTask::getTxCount() const {
+  return _txCount;
 }
 
 int16_t RadiolibTask::startRX(uint8_t mode) {
@@ -250,10 +339,62 @@ int16_t RadiolibTask::startRX(uint8_t mode) {
       return state;
     }
   }
-  taskToNotify = NULL;
   return radio->startReceive(0, mode);
 }
 
+void RadiolibTask::restartRX(const char *timeStr) {
+  if (rxEnable) {
+    int state = startRX(RADIOLIB_SX127X_RXCONTINUOUS);
+    if (state != RADIOLIB_ERR_NONE) {
+      APP_LOGE(getName(), "[%s] startRX failed, code %d", timeStr, state);
+      rxEnable = false;
+    }
+  }
+}
+
+bool RadiolibTask::encodeNext(const char *timeStr) {
+  Packet *packet = _scheduler.dequeue(millis());
+  if (packet == NULL) {
+    return false;
+  }
+
+  APP_LOGD(getName(), "[%s] Transmitting packet '%s'", timeStr, packet->msg.toString().c_str());
+  _nextFrame = "<\xff\x01";
+  _nextFrame += packet->msg.encode();
+  packet->release();
+  return true;
+}
+
+void RadiolibTask::transmitNext(const char *timeStr) {
+  int16_t state = startTX(_nextFrame);
+  if (state != RADIOLIB_ERR_NONE) {
+    APP_LOGE(getName(), "[%s] startTX failed, code %d", timeStr, state);
+    txEnable = false;
+    restartRX(timeStr);
+  } else {
+    _transmitting = true;
+    _txDeadline   = esp_timer_get_time() + (int64_t)(_scheduler.getAirtime(_nextFrame.length()) + TX_TIMEOUT_MARGIN_MS) * 1000;
+  }
+  // The frame is in the modem FIFO, the String keeps its buffer for the next one
+  _nextFrame = "";
+}
+
+bool RadiolibTask::isChannelBusy() {
+  // The modem only listens on the RX frequency, it knows nothing about the TX one
+  if (!rxEnable || config.frequencyTx != config.frequencyRx) {
+    return false;
+  }
+
+  // CAD would take the modem out of continuous RX and lose the frame being received, the modem status tells the same
+  int16_t status = radio->getModemStatus();
+  if (status > 0 && (status & (MODEM_STATUS_SIGNAL_DETECTED | MODEM_STATUS_SIGNAL_SYNCHRONIZED | MODEM_STATUS_HEADER_VALID)) != 0) {
+    return true;
+  }
+
+  // Non-LoRa traffic or a LoRa frame below the detection threshold, 0 when the threshold is disabled
+  return config.busyRssi != 0 && radio->getRSSI(false) > config.busyRssi;
+}
+
 int16_t RadiolibTask::startTX(String &str) {
   if (config.frequencyTx != config.frequencyRx) {
     int16_t state = radio->setFrequency((float)config.frequencyTx / 1000000);
@@ -262,7 +403,7 @@ int16_t RadiolibTask::startTX(String &str) {
     }
   }
 
+  // A failed start is handled by the caller at once, instead of waiting for a TX done interrupt that never comes
   transmissionState = radio->startTransmit(str);
-  taskToNotify      = handle;
-  return RADIOLIB_ERR_NONE;
+  return transmissionState;
 }
@@ -2,18 +2,64 @@
 #define TASK_LORA_H_
 
 #include <APRS-Decoder.h>
+#include <Histogram.h>
+#include <PacketBus.h>
 #include <RadioLib.h>
+#include <RunningStats.h>
+#include <TxScheduler.h>
 
 #include "TaskManager.h"
 #include "project_configuration.h"
 
+#define LORA_PREAMBLE_LENGTH 8
+
 class RadiolibTask : public FreeRTOSTask {
 public:
-  RadiolibTask(UBaseType_t priority, BaseType_t coreId, const bool displayOnScreen, System &system, QueueHandle_t &fromModem, QueueHandle_t &toModem, QueueHandle_t &toPacketLogger, QueueHandle_t &_toDisplay);
+  RadiolibTask(UBaseType_t priority, BaseType_t coreId, const bool displayOnScreen, System &system, PacketBus &bus, TxScheduler &scheduler);
   virtual ~RadiolibTask();
 
   void worker() override;
 
+  /**
+   * @brief Time (in us) spent reading and decoding each valid frame, from the FIFO read to the decoded APRSMessage.
+   */
+  const RunningStats &getDecodeTime() const;
+
+  /**
+   * @brief Time (in us) between the TX done interrupt and the modem being back in RX.
+   */
+  const RunningStats &getTxTurnaround() const;
+
+  /**
+   * @brief RSSI (10dB bins from -140dBm) and SNR (2.5dB bins from -20dB) of the frames received, corrupt ones included.
+   */
+  const Histogram &getRssiHistogram() const;
+  const Histogram &getSnrHistogram() const;
+
+  /**
+   * @brief Frames read from the modem with a valid CRC, whatever their content.
+   */
+  uint32_t getRxCount() const;
+
+  /**
+   * @brief Frames received with a CRC error.
+   */
+  uint32_t getRxCorruptCount() const;
+
+  /**
+   * @brief Frames whose TX done interrupt was received.
+   */
+  uint32_t getTxCount() const;
+
+  /**
+   * @brief     Checks the LoRa APRS header of a frame read from the FIFO and replaces its non-printable chars by spaces, in place.
+   *
+   * @param[in] frame The FIFO content, NUL terminated (frame[length] is '\0').
+   *
+   * @return    The text of the frame, after its header, or NULL if it is not a LoRa APRS frame.
+   */
+  static const char *extractText(uint8_t *frame, size_t length);
+
 private:
   Module *module;
   SX1278 *radio;
@@ -23,13 +69,28 @@ private:
 
   bool rxEnable, txEnable;
 
-  QueueHandle_t &_fromModem;
-  QueueHandle_t &_toModem;
-  QueueHandle_t &_toPacketLogger;
-  QueueHandle_t &_toDisplay;
+  PacketBus   &_bus;
+  TxScheduler &_scheduler;
+
+  String       _rxData;
+  RunningStats _decodeTime;
+  Histogram    _rssiHistogram;
+  Histogram    _snrHistogram;
+  uint32_t     _rxCount;
+  uint32_t     _rxCorruptCount;
+
+  bool         _transmitting;
+  int64_t      _txDeadline; // esp_timer time (us) after which the TX done interrupt is considered lost
+  String       _nextFrame;  // Frame encoded while the previous one is being sent
+  RunningStats _txTurnaround;
+  uint32_t     _txCount;
 
   int16_t startRX(uint8_t mode);
   int16_t startTX(String &str);
+  bool    isChannelBusy();
+  void    restartRX(const char *timeStr);
+  bool    encodeNext(const char *timeStr);
+  void    transmitNext(const char *timeStr);
 };
 
 #endif
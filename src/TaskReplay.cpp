@@ -0,0 +1,122 @@
+#include <SPIFFS.h>
+#include <ctime>
+#include <esp_timer.h>
+#include <logger.h>
+
+#include "System.h"
+#include "Task.h"
+#include "TaskPacketLogger.h"
+#include "TaskReplay.h"
+#include "project_configuration.h"
+
+#define REPLAY_FILE       "/replay.log"
+#define REPLAY_FIELDS     9   // Number of columns of the packet logger format
+#define REPLAY_FRAME_SIZE 256 // Largest LoRa frame
+
+ReplayTask::ReplayTask(UBaseType_t priority, BaseType_t coreId, const bool displayOnScreen, System &system, PacketBus &bus, float speed) : FreeRTOSTask(TASK_REPLAY, TaskReplay, priority, 3072, coreId, displayOnScreen), _system(system), _bus(bus), _speed(speed) {
+  start();
+}
+
+ReplayTask::~ReplayTask() {
+}
+
+void ReplayTask::worker() {
+  if (!SPIFFS.begin()) {
+    APP_LOGE(getName(), "Could not start SPIFFS...");
+    _state     = Error;
+    _stateInfo = "SPIFFS error";
+    return;
+  }
+
+  File trace = SPIFFS.open(REPLAY_FILE, "r");
+  if (!trace) {
+    APP_LOGE(getName(), "Could not open %s.", REPLAY_FILE);
+    _state     = Error;
+    _stateInfo = "No trace to replay";
+    return;
+  }
+
+  // Let the other tasks subscribe to the bus before publishing anything
+  vTaskDelay(pdMS_TO_TICKS(5000));
+
+  _frame.reserve(REPLAY_FRAME_SIZE);
+  _stateInfo = "Replaying " REPLAY_FILE;
+
+  size_t  count    = 0;
+  time_t  previous = 0;
+  int64_t start    = esp_timer_get_time();
+  while (trace.available()) {
+    String line = trace.readStringUntil('\n');
+    time_t timestamp;
+    if (!publishLine(line, &timestamp)) {
+      continue;
+    }
+
+    if (_speed > 0 && previous != 0 && timestamp > previous) {
+      vTaskDelay(pdMS_TO_TICKS((timestamp - previous) * 1000 / _speed));
+    }
+    previous = timestamp;
+    count++;
+  }
+  trace.close();
+
+  uint32_t elapsed = (esp_timer_get_time() - start) / 1000;
+  APP_LOGI(getName(), "Replayed %u packets in %ums.", count, elapsed);
+  _stateInfo = String("Replayed ") + count + " packets in " + elapsed + "ms";
+  for (;;) {
+    vTaskDelay(portMAX_DELAY);
+  }
+}
+
+bool ReplayTask::publishLine(const String &line, time_t *timestamp) {
+  String fields[REPLAY_FIELDS];
+  int    start = 0;
+  for (size_t i = 0; i < REPLAY_FIELDS; i++) {
+    int end = line.indexOf(SEPARATOR, start);
+    if (end < 0) {
+      end = line.length();
+    }
+    fields[i] = line.substring(start, end);
+    fields[i].trim();
+    start = end + 1;
+  }
+
+  // Skips the header and truncated lines
+  struct tm timeInfo = {};
+  if (sscanf(fields[1].c_str(), "%d-%d-%dT%d:%d:%dZ", &timeInfo.tm_year, &timeInfo.tm_mon, &timeInfo.tm_mday, &timeInfo.tm_hour, &timeInfo.tm_min, &timeInfo.tm_sec) != 6) {
+    return false;
+  }
+  timeInfo.tm_year -= 1900;
+  timeInfo.tm_mon -= 1;
+  *timestamp = mktime(&timeInfo);
+
+  Packet *packet = _system.getPacketPool()->acquire();
+  if (packet == NULL) {
+    APP_LOGE(getName(), "Packet pool exhausted, replayed packet dropped");
+    return true;
+  }
+
+  packet->origin             = Packet::Replay;
+  packet->rx.irqTime         = esp_timer_get_time();
+  packet->rx.rxTime          = time(NULL);
+  packet->rx.rssi            = fields[6].toFloat();
+  packet->rx.snr             = fields[7].toFloat();
+  packet->rx.freqError       = fields[8].toFloat();
+  packet->rx.spreadingFactor = _system.getUserConfig()->lora.spreadingFactor;
+  packet->rx.crcOk           = (fields[5] != "INVALID PACKET");
+
+  if (packet->rx.crcOk) {
+    // Same decoding as a received frame
+    _frame = fields[2] + ">" + fields[3];
+    if (fields[4].length() > 0) {
+      _frame += "," + fields[4];
+    }
+    _frame += ":" + fields[5];
+    packet->msg.decode(_frame);
+    _bus.publish(packet, PacketBus::RfReceived);
+  } else {
+    _bus.publish(packet, PacketBus::RfCorrupt);
+  }
+  packet->release();
+  return true;
+}
@@ -0,0 +1,34 @@
+#ifndef TASK_REPLAY_H_
+#define TASK_REPLAY_H_
+
+#include <PacketBus.h>
+#include <TaskManager.h>
+
+/**
+ * @brief Replays a packet trace in the packet logger format as if it was received by the modem.
+ *
+ * Only started when built with -DENABLE_PACKET_REPLAY=1 (see platformio.ini). The trace is read from /replay.log, each packet is decoded and
+ * published on the bus like a received frame, so that the router, the logger, MQTT and the display can be benchmarked without
+ * RF traffic. Replayed packets are never gated to APRS-IS nor transmitted, and leave the dupe cache and the station table alone;
+ * they are published to the MQTT broker and written to packets.log like received ones.
+ */
+class ReplayTask : public FreeRTOSTask {
+public:
+  /**
+   * @param[in] speed Replay speed relative to the timestamps of the trace, 0 to publish the packets as fast as possible.
+   */
+  ReplayTask(UBaseType_t priority, BaseType_t coreId, const bool displayOnScreen, System &system, PacketBus &bus, float speed);
+  virtual ~ReplayTask();
+
+  void worker() override;
+
+private:
+  bool publishLine(const String &line, time_t *timestamp);
+
+  System    &_system;
+  PacketBus &_bus;
+  float      _speed;
+  String     _frame;
+};
+
+#endif
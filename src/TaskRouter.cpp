@@ -1,12 +1,31 @@
+#include <esp_timer.h>
 #include <logger.h>
 
 #include "System.h"
 #include "Task.h"
-#include "TaskMQTT.h"
 #include "TaskRouter.h"
 #include "project_configuration.h"
 
-RouterTask::RouterTask(UBaseType_t priority, BaseType_t coreId, const bool displayOnScreen, System &system, QueueHandle_t &fromModem, QueueHandle_t &toModem, QueueHandle_t &toAprsIs, QueueHandle_t &toMQTT) : FreeRTOSTask(TASK_ROUTER, TaskRouter, priority, 2048, coreId, displayOnScreen), _system(system), _fromModem(fromModem), _toModem(toModem), _toAprsIs(toAprsIs), _toMQTT(toMQTT) {
+#define DUPE_CACHE_MIN      32   // Entries
+#define DUPE_CACHE_MAX      512  // Entries, 6 kB
+#define DUPE_MIN_FRAME      24   // Bytes, LoRa APRS header and the shortest useful packet
+#define ROUTER_STACK_SIZE   4096 // Bytes, a digipeated packet goes through APRSMessage copies, DigiPath and the logs
+#define ROUTER_STACK_MARGIN 512  // Bytes of stack never used under which a warning is logged
+
+/**
+ * @brief     Number of packets the channel can carry during the dupe check window: frames do not overlap on the RX frequency, so
+ *            no entry is replaced before the end of its window.
+ */
+static size_t getDupeCacheSize(const TxScheduler &scheduler, uint32_t window_ms) {
+  size_t size = window_ms / std::max<uint32_t>(scheduler.getAirtime(DUPE_MIN_FRAME), 1) + 1;
+  return std::min<size_t>(std::max<size_t>(size, DUPE_CACHE_MIN), DUPE_CACHE_MAX);
+}
+
+RouterTask::RouterTask(UBaseType_t priority, BaseType_t coreId, const bool displayOnScreen, System &system, PacketBus &bus, TxScheduler &scheduler) : FreeRTOSTask(TASK_ROUTER, TaskRouter, priority, ROUTER_STACK_SIZE, coreId, displayOnScreen), _system(system), _bus(bus), _fromModem(bus.subscribe(TASK_ROUTER, PacketBus::RfReceived)), _scheduler(scheduler), _dupeCache(getDupeCacheSize(scheduler, system.getUserConfig()->dupeCheck.window * 1000), system.getUserConfig()->dupeCheck.window * 1000), _stackLeft(ROUTER_STACK_SIZE) {
+  _digiRules.callsign  = _system.getUserConfig()->callsign.c_str();
+  _digiRules.maxHops   = _system.getUserConfig()->digi.max_hops;
+  _digiRules.fillIn    = _system.getUserConfig()->digi.fill_in;
+  _digiRules.traceWide = _system.getUserConfig()->digi.trace_wide;
   start();
 }
 
@@ -14,62 +33,124 @@ RouterTask::~RouterTask() {
 }
 
 void RouterTask::worker() {
+  _stateInfo = "Waiting for packets";
   for (;;) {
-    while (uxQueueMessagesWaiting(_fromModem) > 0) {
-      APRSMessage *fromModemMsg;
-      xQueueReceive(_fromModem, &fromModemMsg, 0);
-
-      if (_system.getUserConfig()->mqtt.active) {
-        APRSMessage *mqttMsg = new APRSMessage(*fromModemMsg);
-        xQueueSendToBack(_toMQTT, &mqttMsg, pdMS_TO_TICKS(100));
-      }
-
-      if (_system.getUserConfig()->aprs_is.active && fromModemMsg->getSource() != _system.getUserConfig()->callsign) {
-        APRSMessage *aprsIsMsg = new APRSMessage(*fromModemMsg);
-        String       path      = aprsIsMsg->getPath();
+    // Block until the modem publishes a packet, it is forwarded as soon as it arrives
+    Packet *packet = _bus.receive(_fromModem, portMAX_DELAY);
+    if (packet != NULL) {
+      APRSMessage *fromModemMsg = &packet->msg;
+
+      // A packet heard both directly and through another digipeater must only be gated and repeated once. Replayed packets leave
+      // the dupe cache and the station table alone: they must not drop real frames nor make APRS-IS messages gated to RF.
+      bool     replayed = packet->origin == Packet::Replay;
+      uint32_t hash     = DupeCache::hash(fromModemMsg->getSource(), fromModemMsg->getDestination(), fromModemMsg->getRawBody());
+      if (!replayed && _dupeCache.check(hash, millis())) {
+        APP_LOGI(getName(), "Duplicate packet dropped: %s", fromModemMsg->toString().c_str());
+      } else {
+        // Parsed once, for the station table and the digipeater
+        DigiPath path;
+        bool     pathValid = path.parse(fromModemMsg->getPath().c_str());
+        if (!replayed) {
+          updateStation(packet, pathValid ? path.getLastDigipeater() : NULL);
+        }
 
-        if (!(path.indexOf("RFONLY") != -1 || path.indexOf("NOGATE") != -1 || path.indexOf("TCPIP") != -1)) {
-          if (!path.isEmpty()) {
-            path += ",";
+        if (_system.getUserConfig()->aprs_is.active && fromModemMsg->getSource() != _system.getUserConfig()->callsign) {
+          String rawPath = fromModemMsg->getPath();
+
+          if (!(rawPath.indexOf("RFONLY") != -1 || rawPath.indexOf("NOGATE") != -1 || rawPath.indexOf("TCPIP") != -1)) {
+            // The q-construct is appended by AprsIsTask when the packet is encoded, the packet itself is shared
+            APP_LOGI(getName(), "APRS-IS: %s", fromModemMsg->toString().c_str());
+            if (!replayed) {
+              _bus.publish(packet, PacketBus::ToAprsIs);
+            }
+          } else {
+            APP_LOGI(getName(), "APRS-IS: no forward => RFonly");
           }
-
-          aprsIsMsg->setPath(path + "qAO," + _system.getUserConfig()->callsign);
-
-          APP_LOGI(getName(), "APRS-IS: %s", aprsIsMsg->toString().c_str());
-          xQueueSendToBack(_toAprsIs, &aprsIsMsg, pdMS_TO_TICKS(100));
         } else {
-          APP_LOGI(getName(), "APRS-IS: no forward => RFonly");
-        }
-      } else {
-        if (!_system.getUserConfig()->aprs_is.active) {
-          APP_LOGI(getName(), "APRS-IS: disabled");
+          if (!_system.getUserConfig()->aprs_is.active) {
+            APP_LOGI(getName(), "APRS-IS: disabled");
+          }
+
+          if (fromModemMsg->getSource() == _system.getUserConfig()->callsign) {
+            APP_LOGI(getName(), "APRS-IS: no forward => own packet received");
+          }
         }
 
-        if (fromModemMsg->getSource() == _system.getUserConfig()->callsign) {
-          APP_LOGI(getName(), "APRS-IS: no forward => own packet received");
+        if (_system.getUserConfig()->digi.active && fromModemMsg->getSource() != _system.getUserConfig()->callsign) {
+          DigiPath::Result result = pathValid ? path.process(_digiRules) : DigiPath::Invalid;
+
+          if (result == DigiPath::Digipeat) {
+            // The digipeated frame has its own path, so it needs its own packet
+            Packet *digiPacket = _system.getPacketPool()->acquire();
+            if (digiPacket == NULL) {
+              APP_LOGE(getName(), "DIGI: packet pool exhausted, frame dropped");
+            } else {
+              char newPath[DigiPath::MAX_HOPS * (DigiPath::HOP_SIZE + 1)];
+              path.format(newPath, sizeof(newPath));
+              digiPacket->msg = *fromModemMsg;
+              digiPacket->msg.setPath(newPath);
+
+              APP_LOGI(getName(), "DIGI: %s", digiPacket->msg.toString().c_str());
+
+              if (replayed) {
+                // Replayed packets go through the whole processing but are never transmitted
+                digiPacket->release();
+              } else if (!_scheduler.enqueue(digiPacket, TxScheduler::Digi)) {
+                APP_LOGE(getName(), "DIGI: TX queue full, frame dropped");
+                digiPacket->release();
+              }
+            }
+          } else {
+            APP_LOGD(getName(), "DIGI: not repeated => %s", DigiPath::toString(result));
+          }
         }
       }
 
-      if (_system.getUserConfig()->digi.active && fromModemMsg->getSource() != _system.getUserConfig()->callsign) {
-        APRSMessage *digiMsg = new APRSMessage(*fromModemMsg);
-
-        String path = digiMsg->getPath();
-
-        // simple loop check
-        if (path.indexOf("WIDE1-1") >= 0 && path.indexOf(_system.getUserConfig()->callsign) == -1) {
-          // fixme
-          digiMsg->setPath(_system.getUserConfig()->callsign + "*");
-
-          APP_LOGI(getName(), "DIGI: %s", digiMsg->toString().c_str());
+      _latency.add((uint32_t)(esp_timer_get_time() - packet->rx.irqTime));
+      packet->release();
 
-          xQueueSendToBack(_toModem, &digiMsg, pdMS_TO_TICKS(100));
+      // Each new deepest path through the router is reported, the status record of MQTT only samples the stack usage
+      UBaseType_t stackLeft = uxTaskGetStackHighWaterMark(NULL);
+      if (stackLeft < _stackLeft) {
+        _stackLeft = stackLeft;
+        if (stackLeft < ROUTER_STACK_MARGIN) {
+          APP_LOGW(getName(), "Only %u bytes of stack never used", stackLeft);
+        } else {
+          APP_LOGD(getName(), "%u bytes of stack never used", stackLeft);
         }
       }
-      delete fromModemMsg;
+
+      APP_LOGD(getName(), "Packet handed off %uus after RX interrupt", _latency.getLast());
+      _stateInfo = String("Routed ") + _latency.getCount() + " packets, latency " + _latency.getMean() / 1000 + "ms avg / " + _latency.getMax() / 1000 + "ms max, " + _dupeCache.getHits() + " dupes";
     }
+  }
+}
 
-    vTaskDelay(pdMS_TO_TICKS(1000));
+void RouterTask::updateStation(Packet *packet, const char *via) {
+  String source = packet->msg.getSource();
+  if (source == _system.getUserConfig()->callsign || source.length() >= Station::CALLSIGN_SIZE) {
+    return;
+  }
 
-    _stateInfo = "Router done ";
+  Station heard;
+  strcpy(heard.callsign, source.c_str());
+  if (via != NULL) {
+    strncpy(heard.via, via, Station::CALLSIGN_SIZE - 1);
+    heard.via[Station::CALLSIGN_SIZE - 1] = '\0';
+  } else {
+    heard.via[0] = '\0';
   }
+  heard.lastHeard   = millis();
+  heard.rssi        = packet->rx.rssi;
+  heard.snr         = packet->rx.snr;
+  heard.hasPosition = StationTable::parsePosition(packet->msg.getRawBody().c_str(), &heard.latitude, &heard.longitude);
+  _system.getStationTable()->update(heard);
+}
+
+const RunningStats &RouterTask::getLatency() const {
+  return _latency;
+}
+
+const DupeCache &RouterTask::getDupeCache() const {
+  return _dupeCache;
 }
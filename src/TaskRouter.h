@@ -2,21 +2,49 @@
 #define TASK_ROUTER_H_
 
 #include <APRSMessage.h>
+#include <DigiPath.h>
+#include <DupeCache.h>
+#include <PacketBus.h>
+#include <PacketPool.h>
+#include <RunningStats.h>
+#include <StationTable.h>
 #include <TaskManager.h>
+#include <TxScheduler.h>
 
 class RouterTask : public FreeRTOSTask {
 public:
-  RouterTask(UBaseType_t priority, BaseType_t coreId, const bool displayOnScreen, System &system, QueueHandle_t &fromModem, QueueHandle_t &toModem, QueueHandle_t &toAprsIs, QueueHandle_t &toMQTT);
+  RouterTask(UBaseType_t priority, BaseType_t coreId, const bool displayOnScreen, System &system, PacketBus &bus, TxScheduler &scheduler);
   virtual ~RouterTask();
 
   void worker() override;
 
+  /**
+   * @brief Latency (in us) between the RX interrupt of a packet and its hand-off to the other tasks.
+   */
+  const RunningStats &getLatency() const;
+
+  /**
+   * @brief Cache of the recently routed packets. Hits are the duplicates that were dropped.
+   */
+  const DupeCache &getDupeCache() const;
+
 private:
-  System        &_system;
-  QueueHandle_t &_fromModem;
-  QueueHandle_t &_toModem;
-  QueueHandle_t &_toAprsIs;
-  QueueHandle_t &_toMQTT;
+  /**
+   * @brief     Records the sender of a packet heard on RF in the station table.
+   *
+   * @param[in] via Last digipeater of the packet, NULL if heard directly.
+   */
+  void updateStation(Packet *packet, const char *via);
+
+  System                &_system;
+  PacketBus             &_bus;
+  PacketBus::Subscriber *_fromModem;
+  TxScheduler           &_scheduler;
+
+  RunningStats    _latency;
+  DupeCache       _dupeCache;
+  DigiPath::Rules _digiRules;
+  UBaseType_t     _stackLeft; // Lowest high-water mark of the stack seen so far, in bytes
 };
 
 #endif
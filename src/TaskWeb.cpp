@@ -219,6 +219,7 @@ esp_err_t WebTask::info_page(httpd_req_t *req) {
   }
 
   page.replace("$$TASKLIST$$", tasklist);
+  page.replace("$$STATIONS$$", getStationsTable());
 
   String logs = _system.getPacketLogger()->getTail();
   sanitize(logs);
@@ -235,6 +236,40 @@ esp_err_t WebTask::info_page(httpd_req_t *req) {
   return httpd_resp_send(req, page.c_str(), page.length());
 }
 
+String WebTask::getStationsTable() const {
+  StationTable *table = _system.getStationTable();
+  if (table == NULL) {
+    return "";
+  }
+
+  // Copied at once so that the router is not blocked while the page is built
+  Station *stations = new Station[table->getCapacity()];
+  size_t   count    = table->snapshot(stations, table->getCapacity());
+  uint32_t now      = millis();
+
+  String html = "<table class=\"stations\"><tr><th>Callsign</th><th>Last heard</th><th>Packets</th><th>RSSI</th><th>SNR</th><th>Via</th><th>Position</th></tr>";
+  for (size_t i = 0; i < count; i++) {
+    const Station &station = stations[i];
+    String         callsign(station.callsign);
+    String         via(station.via[0] != '\0' ? station.via : "direct");
+    sanitize(callsign);
+    sanitize(via);
+
+    html += "<tr><td>" + callsign + "</td><td>" + (now - station.lastHeard) / 1000 + "s ago</td><td>" + station.packets + "</td><td>" + String(station.rssi, 0) + "dBm</td><td>" + String(station.snr, 1) + "dB</td><td>" + via + "</td><td>";
+    if (station.hasPosition) {
+      html += String(station.latitude, 4) + ", " + String(station.longitude, 4);
+    }
+    html += "</td></tr>";
+  }
+  html += "</table>";
+  delete[] stations;
+
+  if (count == 0) {
+    return "<p class=\"task ok\">No station heard yet.</p>";
+  }
+  return html;
+}
+
 esp_err_t WebTask::download_packets_logs(httpd_req_t *req) {
   if (!isClientLoggedIn(req)) {
     return redirectToLogin(req);
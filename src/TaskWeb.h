@@ -171,6 +171,11 @@ private:
    */
   static int32_t readRequestUntilCRLF(httpd_req_t *req, uint8_t *buffer, size_t *length);
 
+  /**
+   * @brief     Builds the HTML table of the stations heard on RF, the most recent first.
+   */
+  String getStationsTable() const;
+
   esp_err_t parseAndWriteFirmware(httpd_req_t *req, String boundary_token) const;
   esp_err_t parseAndWriteSPIFFS(httpd_req_t *req, String boundary_token) const;
 
@@ -50,9 +50,44 @@ void ProjectConfigurationManagement::readProjectConfiguration(DynamicJsonDocumen
   if (data.containsKey("aprs_is") && data["aprs_is"].containsKey("server"))
     conf.aprs_is.server = data["aprs_is"]["server"].as<String>();
   conf.aprs_is.port = data["aprs_is"]["port"] | 14580;
+  JsonArray backups = data["aprs_is"]["backups"].as<JsonArray>();
+  for (JsonVariant v : backups) {
+    Configuration::APRS_IS::Server backup;
+    if (v.containsKey("server"))
+      backup.server = v["server"].as<String>();
+    backup.port = v["port"] | conf.aprs_is.port;
+    conf.aprs_is.backups.push_back(backup);
+  }
+  if (data["aprs_is"].containsKey("filter"))
+    conf.aprs_is.filter = data["aprs_is"]["filter"].as<String>();
+  if (data["aprs_is"].containsKey("idle_timeout"))
+    conf.aprs_is.idle_timeout = data["aprs_is"]["idle_timeout"] | 60;
+  if (data["aprs_is"].containsKey("spool_size"))
+    conf.aprs_is.spool_size = data["aprs_is"]["spool_size"] | 64;
+  if (data["aprs_is"].containsKey("spool_rate"))
+    conf.aprs_is.spool_rate = data["aprs_is"]["spool_rate"] | 2.0;
+  if (data["aprs_is"].containsKey("spool_max_age"))
+    conf.aprs_is.spool_max_age = data["aprs_is"]["spool_max_age"] | 30;
+  if (data["aprs_is"].containsKey("messages_to_rf"))
+    conf.aprs_is.messages_to_rf = data["aprs_is"]["messages_to_rf"] | false;
+  if (data["aprs_is"].containsKey("heard_window"))
+    conf.aprs_is.heard_window = data["aprs_is"]["heard_window"] | 30;
+  if (data["aprs_is"].containsKey("message_interval"))
+    conf.aprs_is.message_interval = data["aprs_is"]["message_interval"] | 10;
 
   conf.digi.active = data["digi"]["active"] | false;
   conf.digi.beacon = data["digi"]["beacon"] | false;
+  if (data["digi"].containsKey("max_hops"))
+    conf.digi.max_hops = data["digi"]["max_hops"] | 2;
+  if (data["digi"].containsKey("fill_in"))
+    conf.digi.fill_in = data["digi"]["fill_in"] | true;
+  if (data["digi"].containsKey("trace_wide"))
+    conf.digi.trace_wide = data["digi"]["trace_wide"] | true;
+
+  if (data.containsKey("dupe_check")) {
+    if (data["dupe_check"].containsKey("window"))
+      conf.dupeCheck.window = data["dupe_check"]["window"] | 30;
+  }
 
   conf.lora.frequencyRx     = data["lora"]["frequency_rx"] | 433775000;
   conf.lora.gainRx          = data["lora"]["gain_rx"] | 0;
@@ -62,6 +97,10 @@ void ProjectConfigurationManagement::readProjectConfiguration(DynamicJsonDocumen
   conf.lora.signalBandwidth = data["lora"]["signal_bandwidth"] | 125000;
   conf.lora.codingRate4     = data["lora"]["coding_rate4"] | 5;
   conf.lora.tx_enable       = data["lora"]["tx_enable"] | true;
+  if (data["lora"].containsKey("duty_cycle"))
+    conf.lora.dutyCycle = data["lora"]["duty_cycle"] | 0.0;
+  if (data["lora"].containsKey("busy_rssi"))
+    conf.lora.busyRssi = data["lora"]["busy_rssi"] | 0;
 
   conf.display.alwaysOn     = data["display"]["always_on"] | true;
   conf.display.timeout      = data["display"]["timeout"] | 10;
@@ -95,6 +134,24 @@ void ProjectConfigurationManagement::readProjectConfiguration(DynamicJsonDocumen
     conf.mqtt.password = data["mqtt"]["password"].as<String>();
   if (data["mqtt"].containsKey("topic"))
     conf.mqtt.topic = data["mqtt"]["topic"].as<String>();
+  if (data["mqtt"].containsKey("per_source"))
+    conf.mqtt.per_source = data["mqtt"]["per_source"] | false;
+  if (data["mqtt"].containsKey("retain"))
+    conf.mqtt.retain = data["mqtt"]["retain"] | false;
+  if (data["mqtt"].containsKey("buffer_size"))
+    conf.mqtt.buffer_size = data["mqtt"]["buffer_size"] | 8;
+  if (data["mqtt"].containsKey("spool_size"))
+    conf.mqtt.spool_size = data["mqtt"]["spool_size"] | 0;
+  if (data["mqtt"].containsKey("replay_rate"))
+    conf.mqtt.replay_rate = data["mqtt"]["replay_rate"] | 5.0;
+  if (conf.mqtt.replay_rate <= 0) {
+    // The buffer would never be published again
+    conf.mqtt.replay_rate = 5.0;
+  }
+  if (data["mqtt"].containsKey("format"))
+    conf.mqtt.format = data["mqtt"]["format"].as<String>();
+  if (data["mqtt"].containsKey("status_interval"))
+    conf.mqtt.status_interval = data["mqtt"]["status_interval"] | 60;
 
   conf.syslog.active = data["syslog"]["active"] | false;
   if (data["syslog"].containsKey("server"))
@@ -130,6 +187,8 @@ void ProjectConfigurationManagement::readProjectConfiguration(DynamicJsonDocumen
       conf.packetLogger.nb_files = data["packet_logger"]["files_history"] | 1;
     if (data["packet_logger"].containsKey("tail_length"))
       conf.packetLogger.tail_length = data["packet_logger"]["tail_length"] | 10;
+    if (data["packet_logger"].containsKey("format"))
+      conf.packetLogger.format = data["packet_logger"]["format"].as<String>();
   }
 
   if (data.containsKey("ntp_server"))
@@ -174,8 +233,26 @@ void ProjectConfigurationManagement::writeProjectConfiguration(Configuration &co
   data["aprs_is"]["passcode"]             = conf.aprs_is.passcode;
   data["aprs_is"]["server"]               = conf.aprs_is.server;
   data["aprs_is"]["port"]                 = conf.aprs_is.port;
+  JsonArray backups                       = data["aprs_is"].createNestedArray("backups");
+  for (Configuration::APRS_IS::Server backup : conf.aprs_is.backups) {
+    JsonObject v = backups.createNestedObject();
+    v["server"]  = backup.server;
+    v["port"]    = backup.port;
+  }
+  data["aprs_is"]["filter"]               = conf.aprs_is.filter;
+  data["aprs_is"]["idle_timeout"]         = conf.aprs_is.idle_timeout;
+  data["aprs_is"]["spool_size"]           = conf.aprs_is.spool_size;
+  data["aprs_is"]["spool_rate"]           = conf.aprs_is.spool_rate;
+  data["aprs_is"]["spool_max_age"]        = conf.aprs_is.spool_max_age;
+  data["aprs_is"]["messages_to_rf"]       = conf.aprs_is.messages_to_rf;
+  data["aprs_is"]["heard_window"]         = conf.aprs_is.heard_window;
+  data["aprs_is"]["message_interval"]     = conf.aprs_is.message_interval;
   data["digi"]["active"]                  = conf.digi.active;
   data["digi"]["beacon"]                  = conf.digi.beacon;
+  data["digi"]["max_hops"]                = conf.digi.max_hops;
+  data["digi"]["fill_in"]                 = conf.digi.fill_in;
+  data["digi"]["trace_wide"]              = conf.digi.trace_wide;
+  data["dupe_check"]["window"]            = conf.dupeCheck.window;
   data["lora"]["frequency_rx"]            = conf.lora.frequencyRx;
   data["lora"]["gain_rx"]                 = conf.lora.gainRx;
   data["lora"]["frequency_tx"]            = conf.lora.frequencyTx;
@@ -184,6 +261,8 @@ void ProjectConfigurationManagement::writeProjectConfiguration(Configuration &co
   data["lora"]["signal_bandwidth"]        = conf.lora.signalBandwidth;
   data["lora"]["coding_rate4"]            = conf.lora.codingRate4;
   data["lora"]["tx_enable"]               = conf.lora.tx_enable;
+  data["lora"]["duty_cycle"]              = conf.lora.dutyCycle;
+  data["lora"]["busy_rssi"]               = conf.lora.busyRssi;
   data["display"]["always_on"]            = conf.display.alwaysOn;
   data["display"]["timeout"]              = conf.display.timeout;
   data["display"]["overwrite_pin"]        = conf.display.overwritePin;
@@ -195,15 +274,22 @@ void ProjectConfigurationManagement::writeProjectConfiguration(Configuration &co
     v["name"]     = u.name;
     v["password"] = u.password;
   }
-  data["mqtt"]["active"]   = conf.mqtt.active;
-  data["mqtt"]["server"]   = conf.mqtt.server;
-  data["mqtt"]["port"]     = conf.mqtt.port;
-  data["mqtt"]["name"]     = conf.mqtt.name;
-  data["mqtt"]["password"] = conf.mqtt.password;
-  data["mqtt"]["topic"]    = conf.mqtt.topic;
-  data["syslog"]["active"] = conf.syslog.active;
-  data["syslog"]["server"] = conf.syslog.server;
-  data["syslog"]["port"]   = conf.syslog.port;
+  data["mqtt"]["active"]          = conf.mqtt.active;
+  data["mqtt"]["server"]          = conf.mqtt.server;
+  data["mqtt"]["port"]            = conf.mqtt.port;
+  data["mqtt"]["name"]            = conf.mqtt.name;
+  data["mqtt"]["password"]        = conf.mqtt.password;
+  data["mqtt"]["topic"]           = conf.mqtt.topic;
+  data["mqtt"]["per_source"]      = conf.mqtt.per_source;
+  data["mqtt"]["retain"]          = conf.mqtt.retain;
+  data["mqtt"]["buffer_size"]     = conf.mqtt.buffer_size;
+  data["mqtt"]["spool_size"]      = conf.mqtt.spool_size;
+  data["mqtt"]["replay_rate"]     = conf.mqtt.replay_rate;
+  data["mqtt"]["format"]          = conf.mqtt.format;
+  data["mqtt"]["status_interval"] = conf.mqtt.status_interval;
+  data["syslog"]["active"]        = conf.syslog.active;
+  data["syslog"]["server"]        = conf.syslog.server;
+  data["syslog"]["port"]          = conf.syslog.port;
 
   data["webserver"]["active"]   = conf.web.active;
   data["webserver"]["port"]     = conf.web.port;
@@ -218,6 +304,7 @@ void ProjectConfigurationManagement::writeProjectConfiguration(Configuration &co
   data["packet_logger"]["number_lines"]  = conf.packetLogger.nb_lines;
   data["packet_logger"]["files_history"] = conf.packetLogger.nb_files;
   data["packet_logger"]["tail_length"]   = conf.packetLogger.tail_length;
+  data["packet_logger"]["format"]        = conf.packetLogger.format;
 
   data["ntp_server"] = conf.ntpServer;
 
@@ -60,27 +60,53 @@ public:
 
   class APRS_IS {
   public:
-    APRS_IS() : active(true), passcode(), server("euro.aprs2.net"), port(14580) {
+    APRS_IS() : active(true), passcode(), server("euro.aprs2.net"), port(14580), backups(), filter(), idle_timeout(60), spool_size(64), spool_rate(2), spool_max_age(30), messages_to_rf(false), heard_window(30), message_interval(10) {
     }
 
-    bool   active;
-    String passcode;
-    String server;
-    int    port;
+    class Server {
+    public:
+      String server;
+      int    port;
+    };
+
+    bool              active;
+    String            passcode;
+    String            server;
+    int               port;
+    std::list<Server> backups;       // Used when they answer faster than server or when server can not be reached
+    String            filter;        // Server-side filter, empty for none
+    unsigned int      idle_timeout;  // Seconds, 0 to disable
+    unsigned int      spool_size;    // kB
+    float             spool_rate;    // Packets per second
+    unsigned int      spool_max_age; // Minutes
+    bool              messages_to_rf;
+    unsigned int      heard_window;     // Minutes
+    unsigned int      message_interval; // Seconds
   };
 
   class Digi {
   public:
-    Digi() : active(false), beacon(true) {
+    Digi() : active(false), beacon(true), max_hops(2), fill_in(true), trace_wide(true) {
     }
 
-    bool active;
-    bool beacon;
+    bool         active;
+    bool         beacon;
+    unsigned int max_hops;
+    bool         fill_in;
+    bool         trace_wide;
+  };
+
+  class DupeCheck {
+  public:
+    DupeCheck() : window(30) {
+    }
+
+    unsigned int window;
   };
 
   class LoRa {
   public:
-    LoRa() : frequencyRx(433775000), gainRx(0), frequencyTx(433775000), power(20), spreadingFactor(12), signalBandwidth(125000), codingRate4(5), tx_enable(true) {
+    LoRa() : frequencyRx(433775000), gainRx(0), frequencyTx(433775000), power(20), spreadingFactor(12), signalBandwidth(125000), codingRate4(5), tx_enable(true), dutyCycle(0), busyRssi(0) {
     }
 
     long    frequencyRx;
@@ -91,6 +117,8 @@ public:
     long    signalBandwidth;
     int     codingRate4;
     bool    tx_enable;
+    float   dutyCycle;
+    int     busyRssi;
   };
 
   class Display {
@@ -121,15 +149,22 @@ public:
 
   class MQTT {
   public:
-    MQTT() : active(false), server(""), port(1883), name(""), password(""), topic("LoraAPRS/Data") {
+    MQTT() : active(false), server(""), port(1883), name(""), password(""), topic("LoraAPRS/Data"), per_source(false), retain(false), buffer_size(8), spool_size(0), replay_rate(5), format("json"), status_interval(60) {
     }
 
-    bool   active;
-    String server;
-    int    port;
-    String name;
-    String password;
-    String topic;
+    bool         active;
+    String       server;
+    int          port;
+    String       name;
+    String       password;
+    String       topic;
+    bool         per_source; // Publish to <topic>/<callsign>/<source>
+    bool         retain;
+    unsigned int buffer_size;     // kB of RAM
+    unsigned int spool_size;      // kB of flash
+    float        replay_rate;     // Packets per second
+    String       format;          // "json" or "msgpack"
+    unsigned int status_interval; // Seconds, 0 to disable
   };
 
   class Syslog {
@@ -165,13 +200,14 @@ public:
 
   class PacketLogger {
   public:
-    PacketLogger() : active(true), nb_lines(100), nb_files(1), tail_length(10) {
+    PacketLogger() : active(true), nb_lines(100), nb_files(1), tail_length(10), format("tsv") {
     }
 
     bool         active;
     unsigned int nb_lines;
     unsigned int nb_files;
     unsigned int tail_length;
+    String       format;
   };
 
   Configuration() : callsign("NOCALL-10"), ntpServer("pool.ntp.org"), board("") {
@@ -183,6 +219,7 @@ public:
   Beacon       beacon;
   APRS_IS      aprs_is;
   Digi         digi;
+  DupeCheck    dupeCheck;
   LoRa         lora;
   Display      display;
   Ftp          ftp;
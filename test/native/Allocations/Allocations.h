@@ -0,0 +1,33 @@
+#ifndef ALLOCATIONS_H_
+#define ALLOCATIONS_H_
+
+#include <new>
+#include <stdint.h>
+#include <stdlib.h>
+
+/**
+ * @brief Heap allocations made by the thread of the tests, for the host benchmarks. The firmware ones go through operator new too
+ *        (String, APRSMessage).
+ *
+ * The global operator new and delete are replaced below: only include this header from the test_main.cpp of a benchmark.
+ */
+static thread_local uint32_t allocations = 0;
+
+void *operator new(size_t size) {
+  allocations++;
+  void *p = malloc(size);
+  if (p == NULL) {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+void operator delete(void *p) noexcept {
+  free(p);
+}
+
+void operator delete(void *p, size_t size) noexcept {
+  free(p);
+}
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef CORPUS_H_
+#define CORPUS_H_
+
+/**
+ * @brief APRS frames in the formats heard on the LoRa APRS network, one TNC2 frame per line, for the host benchmarks.
+ *
+ * Positions (plain, compressed, Mic-E, with timestamp), objects, items, status, messages and their acks, telemetry and weather,
+ * sent by trackers, digipeaters and iGates, with the paths they use: the mix of lengths and fields the RX path, the loggers and the
+ * uplink see in practice.
+ */
+static const char corpus[] = R"(F4ABC-9>APLT00,WIDE1-1:!4850.12N/00220.45E>000/000/A=000118 LoRa tracker 4.1V
+F4ABC-9>APLT00,WIDE1-1:!4850.34N/00220.81E>090/032/A=000131 LoRa tracker 4.1V
+F5DEF-7>APLRT1,WIDE1-1:!/5L!!<*e7>7P[ LoRa APRS Tracker
+F5DEF-7>APLRT1,WIDE1-1:!/5L!#<*e9k7P[ LoRa APRS Tracker
+F1GHI-10>APLG01,TCPIP*:!4851.23NL00218.55E&LoRa iGate 433.775MHz
+F1GHI-10>APLG01:>LoRa APRS iGate v2.1.0 - uptime 3d 04:12
+F4JKL-2>APLRG1,WIDE2-1:!4853.00N/00224.10E#LoRa digi 433.775 W2
+F4JKL-2>APLRG1,WIDE2-1:T#112,118,045,032,000,000,00000000
+F4JKL-2>APLRG1::F4JKL-2  :PARM.Vbat,Temp,RSSI
+F4JKL-2>APLRG1::F4JKL-2  :UNIT.V,degC,dBm
+F4JKL-2>APLRG1::F4JKL-2  :EQNS.0,0.05,0,0,0.5,-20,0,-1,0
+F6MNO-5>APDR16,WIDE1-1:=4849.87N/00219.03E$ APRSdroid LoRa
+F6MNO-5>APDR16,F4JKL-2*,WIDE1*:=4849.87N/00219.03E$ APRSdroid LoRa
+F6MNO-5>APDR16,WIDE1-1::F4ABC-9  :Hello from the LoRa network{12
+F4ABC-9>APLT00,WIDE1-1::F6MNO-5  :ack12
+F4PQR>APRS,WIDE1-1:@181034z4852.55N/00226.70E_225/004g009t061r000p000P000h72b10142LoRa WX
+F4PQR>APRS,WIDE1-1:@181044z4852.55N/00226.70E_230/006g011t060r000p000P000h73b10141LoRa WX
+F4STU-12>APLS01,WIDE1-1:;REPEATER *181030z4850.50N/00221.20Er145.600MHz T088 -060 R15k
+F4STU-12>APLS01,WIDE1-1:)AIDV#2!4848.10N/00223.40EA
+F4VWX-9>APOT30,WIDE1-1:`|Zpl!5>/`"4W}_%
+F4VWX-9>APOT30,F4JKL-2*,WIDE1*:`|Zpl!5>/`"4W}_%
+F4VWX-9>APOT30,WIDE1-1:`|Zql{Z>/`"4Y}LoRa Mic-E 13.8V_%
+F1YZA-7>APLRT1,WIDE1-1:!/5L#G<*j_>7P[ Bike 3.9V
+F1YZA-7>APLRT1,WIDE1-1:!/5L#K<*ja?7P[ Bike 3.9V
+F1YZA-7>APLRT1,WIDE1-1:>Riding along the Seine
+F8BCD-11>APRRT,WIDE2-2:!4855.10N/00230.20E^Balloon 12km
+F8BCD-11>APRRT,WIDE2-1:/181036h4855.20N/00230.40EO045/021/A=039852 Balloon
+F4EFG-10>APLG01,TCPIP*:!4846.70NL00216.90E&LoRa iGate + digi
+F4EFG-10>APLG01:T#005,093,027,000,000,000,00000000
+F4EFG-10>APLG01:>https://github.com/lora-aprs/LoRa_APRS_iGate
+F4HIJ>APMI06,WIDE2-1:@181030z4847.45N/00225.12E-WX3in1Plus2.0 U=12.6V,T=18.1C
+F4KLM-1>APLRG1,WIDE1-1:!4844.21N/00212.83E#LoRa APRS Digi Sud-Ouest 23cm antenna
+F4KLM-1>APLRG1,WIDE1-1:T#455,120,044,028,000,000,00000000
+F4NOP-9>APLT00,F4KLM-1*,WIDE1*:!4843.90N/00211.52E[203/047/A=000295
+F4NOP-9>APLT00,WIDE1-1:!4843.62N/00211.03E[210/051/A=000301
+F4QRS-6>APLT00,WIDE1-1:!4858.00N/00201.00E>Test SF12 CR4/5 125kHz
+F4QRS-6>APLT00,WIDE1-1::BLN1     :LoRa net tonight 21:00 on 433.775
+F4TUV-3>APLRT1,WIDE1-1:!/5KxM<(h(k7P[
+F4TUV-3>APLRT1,WIDE1-1:!/5KxQ<(h+k7P[
+F5WXY>APZMDR,WIDE1-1:!4841.04N/00235.66E&PHG2360/Home iGate
+)";
+
+#define CORPUS_FRAMES 40
+
+#endif
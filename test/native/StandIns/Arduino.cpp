@@ -0,0 +1,113 @@
+#include "Arduino.h"
+
+#include <chrono>
+#include <random>
+#include <thread>
+
+static const std::chrono::steady_clock::time_point bootTime = std::chrono::steady_clock::now();
+
+static std::mt19937 generator;
+
+HardwareSerial Serial;
+EspClass       ESP;
+
+unsigned long millis() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - bootTime).count();
+}
+
+unsigned long micros() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - bootTime).count();
+}
+
+void delay(uint32_t ms) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void delayMicroseconds(uint32_t us) {
+  std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+void yield() {
+  std::this_thread::yield();
+}
+
+long random(long howbig) {
+  if (howbig <= 0) {
+    return 0;
+  }
+  return generator() % howbig;
+}
+
+long random(long howsmall, long howbig) {
+  if (howsmall >= howbig) {
+    return howsmall;
+  }
+  return random(howbig - howsmall) + howsmall;
+}
+
+void randomSeed(unsigned long seed) {
+  generator.seed(seed);
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+}
+
+void digitalWrite(uint8_t pin, uint8_t val) {
+}
+
+int digitalRead(uint8_t pin) {
+  return HIGH;
+}
+
+void attachInterrupt(uint8_t pin, void (*handler)(void), int mode) {
+}
+
+void detachInterrupt(uint8_t pin) {
+}
+
+static int vlog(const char *format, va_list args) {
+  static const bool enabled = getenv("NATIVE_LOG") != NULL;
+
+  // Formatted even when not printed, so that the benchmarks pay for the logs like the iGate does
+  va_list copy;
+  va_copy(copy, args);
+  char buffer[256];
+  int  length = vsnprintf(buffer, sizeof(buffer), format, args);
+  if (enabled) {
+    if (length < (int)sizeof(buffer)) {
+      fputs(buffer, stdout);
+    } else {
+      vfprintf(stdout, format, copy);
+    }
+  }
+  va_end(copy);
+  return length;
+}
+
+int log_printf(const char *format, ...) {
+  va_list args;
+  va_start(args, format);
+  int length = vlog(format, args);
+  va_end(args);
+  return length;
+}
+
+int ets_printf(const char *format, ...) {
+  va_list args;
+  va_start(args, format);
+  int length = vlog(format, args);
+  va_end(args);
+  return length;
+}
+
+uint32_t EspClass::getFreeHeap() {
+  return esp_get_free_heap_size();
+}
+
+uint32_t EspClass::getMinFreeHeap() {
+  return esp_get_free_heap_size();
+}
+
+uint32_t EspClass::getMaxAllocHeap() {
+  return esp_get_free_heap_size();
+}
@@ -0,0 +1,82 @@
+#ifndef ARDUINO_H_
+#define ARDUINO_H_
+
+// Host stand-in of the parts of the ESP32 Arduino core used by the firmware, for the native test environment
+
+#include <algorithm>
+#include <math.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+
+#include "HardwareSerial.h"
+#include "IPAddress.h"
+#include "Print.h"
+#include "Stream.h"
+#include "WString.h"
+#include "esp_system.h"
+
+typedef bool    boolean;
+typedef uint8_t byte;
+
+#define LOW          0x0
+#define HIGH         0x1
+#define INPUT        0x01
+#define OUTPUT       0x03
+#define PULLUP       0x04
+#define INPUT_PULLUP 0x05
+#define RISING       0x01
+#define FALLING      0x02
+#define CHANGE       0x03
+
+#define PROGMEM
+#define pgm_read_byte(addr)      (*(const uint8_t *)(addr))
+#define pgm_read_byte_near(addr) pgm_read_byte(addr)
+
+using std::max;
+using std::min;
+
+unsigned long millis();
+unsigned long micros();
+void          delay(uint32_t ms);
+void          delayMicroseconds(uint32_t us);
+void          yield();
+
+long random(long howbig);
+long random(long howsmall, long howbig);
+void randomSeed(unsigned long seed);
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int  digitalRead(uint8_t pin);
+void attachInterrupt(uint8_t pin, void (*handler)(void), int mode);
+void detachInterrupt(uint8_t pin);
+
+/**
+ * @brief Formats like the core does, but only prints when the NATIVE_LOG environment variable is set so that the test output
+ *        stays readable.
+ */
+/**
+ * @brief Heap figures of the MQTT status records, the host has no fixed heap: all of them are 0.
+ */
+class EspClass {
+public:
+  uint32_t getFreeHeap();
+  uint32_t getMinFreeHeap();
+  uint32_t getMaxAllocHeap();
+};
+
+extern EspClass ESP;
+
+int log_printf(const char *format, ...) __attribute__((format(printf, 1, 2)));
+int ets_printf(const char *format, ...) __attribute__((format(printf, 1, 2)));
+
+#endif
@@ -0,0 +1,316 @@
+#include "FS.h"
+
+#include <map>
+#include <mutex>
+#include <string.h>
+#include <string>
+#include <vector>
+
+namespace fs {
+
+typedef std::shared_ptr<std::vector<uint8_t>> Data;
+
+struct FSState {
+  mutable std::mutex          mutex;
+  std::map<std::string, Data> files;
+  FSStats                     stats;
+};
+
+struct FileState {
+  std::shared_ptr<FSState> fs;
+  std::string              path;
+  Data                     data; // Kept by the handle when the file is removed, like an unlinked inode
+  size_t                   position;
+  bool                     open;
+  bool                     readable;
+  bool                     writable;
+  bool                     append;
+  bool                     directory;
+  std::vector<std::string> entries; // Files of the directory
+  size_t                   nextEntry;
+};
+
+static bool isInDirectory(const std::string &path, const std::string &directory) {
+  if (directory == "/") {
+    return path.size() > 1 && path[0] == '/';
+  }
+  return path.size() > directory.size() + 1 && path.compare(0, directory.size(), directory) == 0 && path[directory.size()] == '/';
+}
+
+File::File() {
+}
+
+File::File(std::shared_ptr<FileState> state) : _state(state) {
+}
+
+size_t File::write(uint8_t c) {
+  return write(&c, 1);
+}
+
+size_t File::write(const uint8_t *buf, size_t size) {
+  if (!*this || !_state->writable || size == 0) {
+    return 0;
+  }
+  std::lock_guard<std::mutex> lock(_state->fs->mutex);
+  std::vector<uint8_t>       &data = *_state->data;
+  if (_state->append) {
+    _state->position = data.size();
+  }
+  if (_state->position + size > data.size()) {
+    data.resize(_state->position + size);
+  }
+  memcpy(&data[_state->position], buf, size);
+  _state->position += size;
+  _state->fs->stats.writes++;
+  _state->fs->stats.bytesWritten += size;
+  return size;
+}
+
+int File::available() {
+  if (!*this || !_state->readable) {
+    return 0;
+  }
+  std::lock_guard<std::mutex> lock(_state->fs->mutex);
+  return (_state->position < _state->data->size()) ? _state->data->size() - _state->position : 0;
+}
+
+int File::read() {
+  uint8_t c;
+  return (read(&c, 1) == 1) ? c : -1;
+}
+
+int File::peek() {
+  if (!*this || !_state->readable) {
+    return -1;
+  }
+  std::lock_guard<std::mutex> lock(_state->fs->mutex);
+  return (_state->position < _state->data->size()) ? (*_state->data)[_state->position] : -1;
+}
+
+void File::flush() {
+  if (*this) {
+    std::lock_guard<std::mutex> lock(_state->fs->mutex);
+    _state->fs->stats.flushes++;
+  }
+}
+
+size_t File::read(uint8_t *buf, size_t size) {
+  if (!*this || !_state->readable) {
+    return 0;
+  }
+  std::lock_guard<std::mutex> lock(_state->fs->mutex);
+  const std::vector<uint8_t> &data = *_state->data;
+  size_t                      n    = (_state->position < data.size()) ? data.size() - _state->position : 0;
+  if (n > size) {
+    n = size;
+  }
+  if (n > 0) {
+    memcpy(buf, &data[_state->position], n);
+  }
+  _state->position += n;
+  _state->fs->stats.reads++;
+  _state->fs->stats.bytesRead += n;
+  return n;
+}
+
+bool File::seek(uint32_t pos, SeekMode mode) {
+  if (!*this || _state->directory) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(_state->fs->mutex);
+  int64_t                     target;
+  switch (mode) {
+  case SeekSet:
+    target = pos;
+    break;
+  case SeekCur:
+    target = (int64_t)_state->position + (int32_t)pos;
+    break;
+  case SeekEnd:
+    target = (int64_t)_state->data->size() + (int32_t)pos;
+    break;
+  default:
+    return false;
+  }
+  if (target < 0 || target > (int64_t)_state->data->size()) {
+    return false;
+  }
+  _state->position = target;
+  return true;
+}
+
+size_t File::position() const {
+  return *this ? _state->position : 0;
+}
+
+size_t File::size() const {
+  if (!*this || _state->directory) {
+    return 0;
+  }
+  std::lock_guard<std::mutex> lock(_state->fs->mutex);
+  return _state->data->size();
+}
+
+bool File::setBufferSize(size_t size) {
+  return *this;
+}
+
+void File::close() {
+  if (*this) {
+    std::lock_guard<std::mutex> lock(_state->fs->mutex);
+    _state->open = false;
+    _state->fs->stats.closes++;
+  }
+  _state.reset();
+}
+
+time_t File::getLastWrite() {
+  return 0;
+}
+
+File::operator bool() const {
+  return _state && _state->open;
+}
+
+const char *File::path() const {
+  return *this ? _state->path.c_str() : NULL;
+}
+
+const char *File::name() const {
+  if (!*this) {
+    return NULL;
+  }
+  size_t slash = _state->path.rfind('/');
+  return _state->path.c_str() + ((slash == std::string::npos) ? 0 : slash + 1);
+}
+
+bool File::isDirectory() {
+  return *this && _state->directory;
+}
+
+File File::openNextFile(const char *mode) {
+  if (!isDirectory() || _state->nextEntry >= _state->entries.size()) {
+    return File();
+  }
+  FS fs;
+  fs._state = _state->fs;
+  return fs.open(_state->entries[_state->nextEntry++].c_str(), mode);
+}
+
+void File::rewindDirectory() {
+  if (isDirectory()) {
+    _state->nextEntry = 0;
+  }
+}
+
+FS::FS() : _state(new FSState()) {
+  resetStats();
+}
+
+FS::~FS() {
+}
+
+File FS::open(const char *path, const char *mode, const bool create) {
+  std::lock_guard<std::mutex> lock(_state->mutex);
+  std::shared_ptr<FileState>  file(new FileState());
+  file->fs        = _state;
+  file->path      = path;
+  file->position  = 0;
+  file->open      = true;
+  file->readable  = (mode[0] == 'r' || mode[1] == '+');
+  file->writable  = (mode[0] != 'r' || mode[1] == '+');
+  file->append    = (mode[0] == 'a');
+  file->directory = false;
+  file->nextEntry = 0;
+
+  std::map<std::string, Data>::iterator it = _state->files.find(path);
+  if (it == _state->files.end()) {
+    if (mode[0] == 'r') {
+      // Like SPIFFS, a directory exists as long as a file is in it
+      if (file->path.size() > 1 && file->path[file->path.size() - 1] == '/') {
+        file->path.erase(file->path.size() - 1);
+      }
+      for (std::map<std::string, Data>::iterator entry = _state->files.begin(); entry != _state->files.end(); entry++) {
+        if (isInDirectory(entry->first, file->path)) {
+          file->entries.push_back(entry->first);
+        }
+      }
+      if (file->entries.empty() && file->path != "/") {
+        return File();
+      }
+      file->directory = true;
+      file->readable  = false;
+      file->writable  = false;
+      file->data.reset(new std::vector<uint8_t>());
+      _state->stats.opens++;
+      return File(file);
+    }
+    it = _state->files.insert(std::make_pair(std::string(path), Data(new std::vector<uint8_t>()))).first;
+  } else if (mode[0] == 'w') {
+    // Truncated in place, the other handles on the file see it too
+    it->second->clear();
+  }
+
+  file->data = it->second;
+  if (file->append) {
+    file->position = file->data->size();
+  }
+  _state->stats.opens++;
+  return File(file);
+}
+
+bool FS::exists(const char *path) {
+  std::lock_guard<std::mutex> lock(_state->mutex);
+  return _state->files.find(path) != _state->files.end();
+}
+
+bool FS::remove(const char *path) {
+  std::lock_guard<std::mutex> lock(_state->mutex);
+  return _state->files.erase(path) > 0;
+}
+
+bool FS::rename(const char *pathFrom, const char *pathTo) {
+  std::lock_guard<std::mutex>           lock(_state->mutex);
+  std::map<std::string, Data>::iterator from = _state->files.find(pathFrom);
+  if (from == _state->files.end() || _state->files.find(pathTo) != _state->files.end()) {
+    return false;
+  }
+  Data data = from->second;
+  _state->files.erase(from);
+  _state->files[pathTo] = data;
+  return true;
+}
+
+bool FS::mkdir(const char *path) {
+  return false;
+}
+
+bool FS::rmdir(const char *path) {
+  return false;
+}
+
+FSStats FS::getStats() const {
+  std::lock_guard<std::mutex> lock(_state->mutex);
+  return _state->stats;
+}
+
+void FS::resetStats() {
+  std::lock_guard<std::mutex> lock(_state->mutex);
+  memset(&_state->stats, 0, sizeof(_state->stats));
+}
+
+void FS::clear() {
+  std::lock_guard<std::mutex> lock(_state->mutex);
+  _state->files.clear();
+}
+
+size_t FS::getUsedBytes() const {
+  std::lock_guard<std::mutex> lock(_state->mutex);
+  size_t                      used = 0;
+  for (std::map<std::string, Data>::const_iterator it = _state->files.begin(); it != _state->files.end(); it++) {
+    used += it->second->size();
+  }
+  return used;
+}
+
+} // namespace fs
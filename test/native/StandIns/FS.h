@@ -0,0 +1,153 @@
+#ifndef FS_H_
+#define FS_H_
+
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "Stream.h"
+
+#define FILE_READ   "r"
+#define FILE_WRITE  "w"
+#define FILE_APPEND "a"
+
+namespace fs {
+
+enum SeekMode {
+  SeekSet = 0,
+  SeekCur = 1,
+  SeekEnd = 2
+};
+
+struct FSState;
+struct FileState;
+
+/**
+ * @brief Counters of the calls reaching the file system, the host stand-in of the flash cost of a change.
+ */
+struct FSStats {
+  uint32_t opens;
+  uint32_t closes;
+  uint32_t writes; // Calls of write() with at least one byte
+  uint32_t bytesWritten;
+  uint32_t flushes;
+  uint32_t reads; // Calls of read()
+  uint32_t bytesRead;
+};
+
+/**
+ * @brief Handle on a file of the in-memory file system, shared between its copies like the ESP32 one.
+ */
+class File : public Stream {
+public:
+  File();
+  explicit File(std::shared_ptr<FileState> state);
+
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t *buf, size_t size) override;
+  using Print::write;
+
+  int  available() override;
+  int  read() override;
+  int  peek() override;
+  void flush() override;
+
+  size_t read(uint8_t *buf, size_t size);
+  size_t readBytes(char *buffer, size_t length) override {
+    return read((uint8_t *)buffer, length);
+  }
+
+  /**
+   * @brief The offset of SeekCur and SeekEnd is taken as signed, as on the ESP32 where it goes through a 32 bits long.
+   */
+  bool seek(uint32_t pos, SeekMode mode);
+  bool seek(uint32_t pos) {
+    return seek(pos, SeekSet);
+  }
+
+  size_t position() const;
+  size_t size() const;
+  bool   setBufferSize(size_t size);
+  void   close();
+  time_t getLastWrite();
+
+  operator bool() const;
+
+  const char *path() const;
+  const char *name() const;
+
+  bool isDirectory();
+  File openNextFile(const char *mode = FILE_READ);
+  void rewindDirectory();
+
+private:
+  std::shared_ptr<FileState> _state;
+};
+
+/**
+ * @brief File system kept in RAM. It has no real directories: like SPIFFS, a directory is the common prefix of file names.
+ *        Renaming onto an existing file fails, as with SPIFFS.
+ */
+class FS {
+public:
+  FS();
+  virtual ~FS();
+
+  File open(const char *path, const char *mode = FILE_READ, const bool create = false);
+  File open(const String &path, const char *mode = FILE_READ, const bool create = false) {
+    return open(path.c_str(), mode, create);
+  }
+
+  bool exists(const char *path);
+  bool exists(const String &path) {
+    return exists(path.c_str());
+  }
+
+  bool remove(const char *path);
+  bool remove(const String &path) {
+    return remove(path.c_str());
+  }
+
+  bool rename(const char *pathFrom, const char *pathTo);
+  bool rename(const String &pathFrom, const String &pathTo) {
+    return rename(pathFrom.c_str(), pathTo.c_str());
+  }
+
+  bool mkdir(const char *path);
+  bool mkdir(const String &path) {
+    return mkdir(path.c_str());
+  }
+
+  bool rmdir(const char *path);
+  bool rmdir(const String &path) {
+    return rmdir(path.c_str());
+  }
+
+  FSStats getStats() const;
+  void    resetStats();
+
+protected:
+  /**
+   * @brief Removes every file.
+   */
+  void clear();
+
+  size_t getUsedBytes() const;
+
+  std::shared_ptr<FSState> _state;
+
+private:
+  friend class File;
+};
+
+} // namespace fs
+
+using fs::File;
+using fs::FS;
+using fs::SeekCur;
+using fs::SeekEnd;
+using fs::SeekMode;
+using fs::SeekSet;
+
+#endif
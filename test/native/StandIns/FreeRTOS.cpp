@@ -0,0 +1,370 @@
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <limits.h>
+#include <mutex>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define STACK_MARGIN (64 * 1024) // Added to each task stack, the host frames are larger than the ESP32 ones
+#define STACK_PAINT  0xA5
+
+struct NativeTask {
+  TaskFunction_t code;
+  void          *parameters;
+  std::string    name;
+  uint32_t       stackDepth; // As requested by the task, in bytes
+  uint8_t       *stack;
+  size_t         stackSize;  // Allocated, margin included
+  uintptr_t      stackStart; // Address of the first frame of the task
+};
+
+struct QueueDefinition {
+  std::mutex              mutex;
+  std::condition_variable notEmpty;
+  std::condition_variable notFull;
+  size_t                  length;
+  size_t                  itemSize;
+  std::vector<uint8_t>    storage;
+  size_t                  head;
+  size_t                  count;
+  QueueDefinition        *set; // Queue set this queue is a member of
+};
+
+static thread_local NativeTask *currentTask = NULL;
+
+static const std::chrono::steady_clock::time_point bootTime = std::chrono::steady_clock::now();
+
+static uintptr_t currentThreadToken() {
+  static thread_local char token;
+  return (uintptr_t)&token;
+}
+
+void vPortCPUInitializeMutex(portMUX_TYPE *mux) {
+  mux->owner = 0;
+  mux->count = 0;
+}
+
+void vPortEnterCritical(portMUX_TYPE *mux) {
+  uintptr_t self = currentThreadToken();
+  if (__atomic_load_n(&mux->owner, __ATOMIC_ACQUIRE) == self) {
+    mux->count++;
+    return;
+  }
+  uintptr_t expected = 0;
+  while (!__atomic_compare_exchange_n(&mux->owner, &expected, self, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+    expected = 0;
+    std::this_thread::yield();
+  }
+  mux->count = 1;
+}
+
+void vPortExitCritical(portMUX_TYPE *mux) {
+  if (--mux->count == 0) {
+    __atomic_store_n(&mux->owner, 0, __ATOMIC_RELEASE);
+  }
+}
+
+static void *taskEntry(void *param) {
+  NativeTask *task = static_cast<NativeTask *>(param);
+  uint8_t     frame;
+  currentTask      = task;
+  task->stackStart = (uintptr_t)&frame;
+  task->code(task->parameters);
+  // A FreeRTOS task must never return
+  fprintf(stderr, "Task %s returned\n", task->name.c_str());
+  abort();
+  return NULL;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t pvTaskCode, const char *pcName, uint32_t usStackDepth, void *pvParameters, UBaseType_t uxPriority, TaskHandle_t *pvCreatedTask, BaseType_t xCoreID) {
+  NativeTask *task = new NativeTask();
+  task->code       = pvTaskCode;
+  task->parameters = pvParameters;
+  task->name       = pcName;
+  task->stackDepth = usStackDepth;
+  task->stackSize  = (usStackDepth + STACK_MARGIN + 4095) & ~(size_t)4095;
+  if (task->stackSize < (size_t)PTHREAD_STACK_MIN) {
+    task->stackSize = PTHREAD_STACK_MIN;
+  }
+  task->stackStart = 0;
+
+  // The stack of a task is never freed, like its thread it lives until the end of the process
+  uint8_t *memory = new uint8_t[task->stackSize + 4096];
+  task->stack     = (uint8_t *)(((uintptr_t)memory + 4095) & ~(uintptr_t)4095);
+  memset(task->stack, STACK_PAINT, task->stackSize);
+
+  if (pvCreatedTask != NULL) {
+    *pvCreatedTask = task;
+  }
+
+  pthread_attr_t attributes;
+  pthread_attr_init(&attributes);
+  pthread_attr_setstack(&attributes, task->stack, task->stackSize);
+  pthread_attr_setdetachstate(&attributes, PTHREAD_CREATE_DETACHED);
+  pthread_t thread;
+  int       result = pthread_create(&thread, &attributes, taskEntry, task);
+  pthread_attr_destroy(&attributes);
+  if (result != 0) {
+    return pdFAIL;
+  }
+  pthread_setname_np(thread, task->name.substr(0, 15).c_str());
+  return pdPASS;
+}
+
+BaseType_t xTaskCreateUniversal(TaskFunction_t pvTaskCode, const char *pcName, uint32_t usStackDepth, void *pvParameters, UBaseType_t uxPriority, TaskHandle_t *pvCreatedTask, BaseType_t xCoreID) {
+  return xTaskCreatePinnedToCore(pvTaskCode, pcName, usStackDepth, pvParameters, uxPriority, pvCreatedTask, xCoreID);
+}
+
+BaseType_t xTaskCreate(TaskFunction_t pvTaskCode, const char *pcName, uint32_t usStackDepth, void *pvParameters, UBaseType_t uxPriority, TaskHandle_t *pvCreatedTask) {
+  return xTaskCreatePinnedToCore(pvTaskCode, pcName, usStackDepth, pvParameters, uxPriority, pvCreatedTask, tskNO_AFFINITY);
+}
+
+void vTaskDelete(TaskHandle_t xTaskToDelete) {
+  if (xTaskToDelete == NULL || xTaskToDelete == currentTask) {
+    pthread_exit(NULL);
+  }
+}
+
+void vTaskDelay(const TickType_t xTicksToDelay) {
+  if (xTicksToDelay == portMAX_DELAY) {
+    for (;;) {
+      std::this_thread::sleep_for(std::chrono::hours(1));
+    }
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(xTicksToDelay * portTICK_PERIOD_MS));
+}
+
+void taskYIELD() {
+  std::this_thread::yield();
+}
+
+TickType_t xTaskGetTickCount() {
+  return (TickType_t)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - bootTime).count() / portTICK_PERIOD_MS;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+  return currentTask;
+}
+
+char *pcTaskGetName(TaskHandle_t xTaskToQuery) {
+  NativeTask *task = (xTaskToQuery != NULL) ? xTaskToQuery : currentTask;
+  return (task != NULL) ? (char *)task->name.c_str() : (char *)"main";
+}
+
+BaseType_t xPortGetCoreID() {
+  return 0;
+}
+
+size_t nativeTaskGetStackUsed(TaskHandle_t xTask) {
+  NativeTask *task = (xTask != NULL) ? xTask : currentTask;
+  if (task == NULL || task->stackStart == 0) {
+    return 0;
+  }
+  // The stack grows down, the first byte not painted any more is the deepest one the task reached
+  size_t untouched = 0;
+  while (untouched < task->stackSize && task->stack[untouched] == STACK_PAINT) {
+    untouched++;
+  }
+  uintptr_t deepest = (uintptr_t)task->stack + untouched;
+  return (task->stackStart > deepest) ? task->stackStart - deepest : 0;
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t xTask) {
+  NativeTask *task = (xTask != NULL) ? xTask : currentTask;
+  if (task == NULL) {
+    return 0;
+  }
+  size_t used = nativeTaskGetStackUsed(task);
+  return (used < task->stackDepth) ? task->stackDepth - used : 0;
+}
+
+static std::chrono::steady_clock::time_point deadline(TickType_t ticks) {
+  return std::chrono::steady_clock::now() + std::chrono::milliseconds((uint64_t)ticks * portTICK_PERIOD_MS);
+}
+
+static bool waitFor(QueueDefinition *queue, std::unique_lock<std::mutex> &lock, std::condition_variable &condition, TickType_t ticks, bool (*ready)(QueueDefinition *)) {
+  if (ticks == portMAX_DELAY) {
+    condition.wait(lock, [queue, ready] {
+      return ready(queue);
+    });
+    return true;
+  }
+  return condition.wait_until(lock, deadline(ticks), [queue, ready] {
+    return ready(queue);
+  });
+}
+
+static bool hasItem(QueueDefinition *queue) {
+  return queue->count > 0;
+}
+
+static bool hasSpace(QueueDefinition *queue) {
+  return queue->count < queue->length;
+}
+
+static BaseType_t send(QueueHandle_t xQueue, const void *pvItemToQueue, TickType_t xTicksToWait, bool front) {
+  QueueDefinition *set;
+  {
+    std::unique_lock<std::mutex> lock(xQueue->mutex);
+    if (!waitFor(xQueue, lock, xQueue->notFull, xTicksToWait, hasSpace)) {
+      return pdFAIL;
+    }
+    size_t slot;
+    if (front) {
+      xQueue->head = (xQueue->head + xQueue->length - 1) % xQueue->length;
+      slot         = xQueue->head;
+    } else {
+      slot = (xQueue->head + xQueue->count) % xQueue->length;
+    }
+    if (xQueue->itemSize > 0) {
+      memcpy(&xQueue->storage[slot * xQueue->itemSize], pvItemToQueue, xQueue->itemSize);
+    }
+    xQueue->count++;
+    set = xQueue->set;
+  }
+  xQueue->notEmpty.notify_one();
+
+  // The member is posted to its set after the item is available, so that the task woken by the set finds it
+  if (set != NULL) {
+    send(set, &xQueue, 0, false);
+  }
+  return pdPASS;
+}
+
+static BaseType_t receive(QueueHandle_t xQueue, void *pvBuffer, TickType_t xTicksToWait, bool remove) {
+  {
+    std::unique_lock<std::mutex> lock(xQueue->mutex);
+    if (!waitFor(xQueue, lock, xQueue->notEmpty, xTicksToWait, hasItem)) {
+      return pdFAIL;
+    }
+    if (xQueue->itemSize > 0 && pvBuffer != NULL) {
+      memcpy(pvBuffer, &xQueue->storage[xQueue->head * xQueue->itemSize], xQueue->itemSize);
+    }
+    if (!remove) {
+      return pdPASS;
+    }
+    xQueue->head = (xQueue->head + 1) % xQueue->length;
+    xQueue->count--;
+  }
+  xQueue->notFull.notify_one();
+  return pdPASS;
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t uxQueueLength, UBaseType_t uxItemSize) {
+  QueueDefinition *queue = new QueueDefinition();
+  queue->length          = uxQueueLength;
+  queue->itemSize        = uxItemSize;
+  queue->storage.resize(uxQueueLength * uxItemSize);
+  queue->head  = 0;
+  queue->count = 0;
+  queue->set   = NULL;
+  return queue;
+}
+
+void vQueueDelete(QueueHandle_t xQueue) {
+  delete xQueue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t xQueue, const void *pvItemToQueue, TickType_t xTicksToWait) {
+  return send(xQueue, pvItemToQueue, xTicksToWait, false);
+}
+
+BaseType_t xQueueSendToBack(QueueHandle_t xQueue, const void *pvItemToQueue, TickType_t xTicksToWait) {
+  return send(xQueue, pvItemToQueue, xTicksToWait, false);
+}
+
+BaseType_t xQueueSendToFront(QueueHandle_t xQueue, const void *pvItemToQueue, TickType_t xTicksToWait) {
+  return send(xQueue, pvItemToQueue, xTicksToWait, true);
+}
+
+BaseType_t xQueueSendFromISR(QueueHandle_t xQueue, const void *pvItemToQueue, BaseType_t *pxHigherPriorityTaskWoken) {
+  if (pxHigherPriorityTaskWoken != NULL) {
+    *pxHigherPriorityTaskWoken = pdFALSE;
+  }
+  return send(xQueue, pvItemToQueue, 0, false);
+}
+
+BaseType_t xQueueReceive(QueueHandle_t xQueue, void *pvBuffer, TickType_t xTicksToWait) {
+  return receive(xQueue, pvBuffer, xTicksToWait, true);
+}
+
+BaseType_t xQueuePeek(QueueHandle_t xQueue, void *pvBuffer, TickType_t xTicksToWait) {
+  return receive(xQueue, pvBuffer, xTicksToWait, false);
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t xQueue) {
+  std::lock_guard<std::mutex> lock(xQueue->mutex);
+  return xQueue->count;
+}
+
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t xQueue) {
+  std::lock_guard<std::mutex> lock(xQueue->mutex);
+  return xQueue->length - xQueue->count;
+}
+
+BaseType_t xQueueReset(QueueHandle_t xQueue) {
+  {
+    std::lock_guard<std::mutex> lock(xQueue->mutex);
+    xQueue->head  = 0;
+    xQueue->count = 0;
+  }
+  xQueue->notFull.notify_all();
+  return pdPASS;
+}
+
+QueueSetHandle_t xQueueCreateSet(UBaseType_t uxEventQueueLength) {
+  return xQueueCreate(uxEventQueueLength, sizeof(QueueDefinition *));
+}
+
+BaseType_t xQueueAddToSet(QueueSetMemberHandle_t xQueueOrSemaphore, QueueSetHandle_t xQueueSet) {
+  std::lock_guard<std::mutex> lock(xQueueOrSemaphore->mutex);
+  // Like FreeRTOS, only an empty queue that is not in another set can be added
+  if (xQueueOrSemaphore->set != NULL || xQueueOrSemaphore->count > 0) {
+    return pdFAIL;
+  }
+  xQueueOrSemaphore->set = xQueueSet;
+  return pdPASS;
+}
+
+BaseType_t xQueueRemoveFromSet(QueueSetMemberHandle_t xQueueOrSemaphore, QueueSetHandle_t xQueueSet) {
+  std::lock_guard<std::mutex> lock(xQueueOrSemaphore->mutex);
+  if (xQueueOrSemaphore->set != xQueueSet || xQueueOrSemaphore->count > 0) {
+    return pdFAIL;
+  }
+  xQueueOrSemaphore->set = NULL;
+  return pdPASS;
+}
+
+QueueSetMemberHandle_t xQueueSelectFromSet(QueueSetHandle_t xQueueSet, TickType_t xTicksToWait) {
+  QueueSetMemberHandle_t member = NULL;
+  if (receive(xQueueSet, &member, xTicksToWait, true) != pdPASS) {
+    return NULL;
+  }
+  return member;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary() {
+  return xQueueCreate(1, 0);
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex() {
+  SemaphoreHandle_t mutex = xQueueCreate(1, 0);
+  mutex->count            = 1;
+  return mutex;
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t uxMaxCount, UBaseType_t uxInitialCount) {
+  SemaphoreHandle_t semaphore = xQueueCreate(uxMaxCount, 0);
+  semaphore->count            = uxInitialCount;
+  return semaphore;
+}
@@ -0,0 +1,48 @@
+#ifndef HARDWARE_SERIAL_H_
+#define HARDWARE_SERIAL_H_
+
+#include <stdio.h>
+
+#include "Stream.h"
+
+/**
+ * @brief Writes to stdout, never receives anything.
+ */
+class HardwareSerial : public Stream {
+public:
+  void begin(unsigned long baud) {
+  }
+
+  void end() {
+  }
+
+  int available() override {
+    return 0;
+  }
+
+  int read() override {
+    return -1;
+  }
+
+  int peek() override {
+    return -1;
+  }
+
+  size_t write(uint8_t c) override {
+    return fputc(c, stdout) == EOF ? 0 : 1;
+  }
+
+  size_t write(const uint8_t *buffer, size_t size) override {
+    return fwrite(buffer, 1, size, stdout);
+  }
+
+  using Print::write;
+
+  void flush() override {
+    fflush(stdout);
+  }
+};
+
+extern HardwareSerial Serial;
+
+#endif
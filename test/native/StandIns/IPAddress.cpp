@@ -0,0 +1,44 @@
+#include "IPAddress.h"
+
+#include <stdio.h>
+#include <string.h>
+
+IPAddress::IPAddress() {
+  _address.dword = 0;
+}
+
+IPAddress::IPAddress(uint8_t first, uint8_t second, uint8_t third, uint8_t fourth) {
+  _address.bytes[0] = first;
+  _address.bytes[1] = second;
+  _address.bytes[2] = third;
+  _address.bytes[3] = fourth;
+}
+
+IPAddress::IPAddress(uint32_t address) {
+  _address.dword = address;
+}
+
+IPAddress::IPAddress(const uint8_t *address) {
+  memcpy(_address.bytes, address, sizeof(_address.bytes));
+}
+
+bool IPAddress::fromString(const char *address) {
+  unsigned int bytes[4];
+  char         end;
+  if (sscanf(address, "%u.%u.%u.%u%c", &bytes[0], &bytes[1], &bytes[2], &bytes[3], &end) != 4) {
+    return false;
+  }
+  for (int i = 0; i < 4; i++) {
+    if (bytes[i] > 255) {
+      return false;
+    }
+    _address.bytes[i] = bytes[i];
+  }
+  return true;
+}
+
+String IPAddress::toString() const {
+  char buffer[16];
+  snprintf(buffer, sizeof(buffer), "%u.%u.%u.%u", _address.bytes[0], _address.bytes[1], _address.bytes[2], _address.bytes[3]);
+  return String(buffer);
+}
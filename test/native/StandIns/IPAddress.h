@@ -0,0 +1,51 @@
+#ifndef IPADDRESS_H_
+#define IPADDRESS_H_
+
+#include <stdint.h>
+
+#include "WString.h"
+
+class IPAddress {
+public:
+  IPAddress();
+  IPAddress(uint8_t first, uint8_t second, uint8_t third, uint8_t fourth);
+  IPAddress(uint32_t address);
+  explicit IPAddress(const uint8_t *address);
+
+  bool fromString(const char *address);
+  bool fromString(const String &address) {
+    return fromString(address.c_str());
+  }
+
+  operator uint32_t() const {
+    return _address.dword;
+  }
+
+  bool operator==(const IPAddress &addr) const {
+    return _address.dword == addr._address.dword;
+  }
+
+  bool operator!=(const IPAddress &addr) const {
+    return _address.dword != addr._address.dword;
+  }
+
+  uint8_t operator[](int index) const {
+    return _address.bytes[index];
+  }
+
+  uint8_t &operator[](int index) {
+    return _address.bytes[index];
+  }
+
+  String toString() const;
+
+private:
+  union {
+    uint8_t  bytes[4];
+    uint32_t dword;
+  } _address;
+};
+
+const IPAddress INADDR_NONE(0, 0, 0, 0);
+
+#endif
@@ -0,0 +1,129 @@
+#include "Print.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+
+size_t Print::write(const uint8_t *buffer, size_t size) {
+  size_t n = 0;
+  while (size--) {
+    if (write(*buffer++) == 0) {
+      break;
+    }
+    n++;
+  }
+  return n;
+}
+
+size_t Print::printf(const char *format, ...) {
+  va_list args;
+  va_start(args, format);
+  char  buffer[64];
+  int   length = vsnprintf(buffer, sizeof(buffer), format, args);
+  va_end(args);
+  if (length < 0) {
+    return 0;
+  }
+  if ((size_t)length < sizeof(buffer)) {
+    return write((const uint8_t *)buffer, length);
+  }
+
+  char *large = new char[length + 1];
+  va_start(args, format);
+  vsnprintf(large, length + 1, format, args);
+  va_end(args);
+  size_t n = write((const uint8_t *)large, length);
+  delete[] large;
+  return n;
+}
+
+size_t Print::print(const String &s) {
+  return write(s.c_str(), s.length());
+}
+
+size_t Print::print(const char str[]) {
+  return write(str);
+}
+
+size_t Print::print(char c) {
+  return write((uint8_t)c);
+}
+
+size_t Print::print(unsigned char n, int base) {
+  return print(String(n, base));
+}
+
+size_t Print::print(int n, int base) {
+  return print(String(n, base));
+}
+
+size_t Print::print(unsigned int n, int base) {
+  return print(String(n, base));
+}
+
+size_t Print::print(long n, int base) {
+  return print(String(n, base));
+}
+
+size_t Print::print(unsigned long n, int base) {
+  return print(String(n, base));
+}
+
+size_t Print::print(long long n, int base) {
+  return print(String(n, base));
+}
+
+size_t Print::print(unsigned long long n, int base) {
+  return print(String(n, base));
+}
+
+size_t Print::print(double n, int digits) {
+  return print(String(n, digits));
+}
+
+size_t Print::println(void) {
+  return print("\r\n");
+}
+
+size_t Print::println(const String &s) {
+  return print(s) + println();
+}
+
+size_t Print::println(const char str[]) {
+  return print(str) + println();
+}
+
+size_t Print::println(char c) {
+  return print(c) + println();
+}
+
+size_t Print::println(unsigned char n, int base) {
+  return print(n, base) + println();
+}
+
+size_t Print::println(int n, int base) {
+  return print(n, base) + println();
+}
+
+size_t Print::println(unsigned int n, int base) {
+  return print(n, base) + println();
+}
+
+size_t Print::println(long n, int base) {
+  return print(n, base) + println();
+}
+
+size_t Print::println(unsigned long n, int base) {
+  return print(n, base) + println();
+}
+
+size_t Print::println(long long n, int base) {
+  return print(n, base) + println();
+}
+
+size_t Print::println(unsigned long long n, int base) {
+  return print(n, base) + println();
+}
+
+size_t Print::println(double n, int digits) {
+  return print(n, digits) + println();
+}
@@ -0,0 +1,117 @@
+#include "RadioLib.h"
+#include "SimRadio.h"
+
+Module::Module(uint32_t cs, uint32_t irq, uint32_t rst, uint32_t gpio) {
+}
+
+SX1278::SX1278(Module *mod) {
+}
+
+int16_t SX1278::begin(float freq, float bw, uint8_t sf, uint8_t cr, uint8_t syncWord, int8_t power, uint16_t preambleLength, uint8_t gain) {
+  static const float bandwidths[] = {7.8, 10.4, 15.6, 20.8, 31.25, 41.7, 62.5, 125, 250, 500};
+
+  bool validBandwidth = false;
+  for (float bandwidth : bandwidths) {
+    validBandwidth |= (bw > bandwidth - 0.01 && bw < bandwidth + 0.01);
+  }
+  if (!validBandwidth) {
+    return RADIOLIB_ERR_INVALID_BANDWIDTH;
+  }
+  if (sf < 6 || sf > 12) {
+    return RADIOLIB_ERR_INVALID_SPREADING_FACTOR;
+  }
+  if (cr < 5 || cr > 8) {
+    return RADIOLIB_ERR_INVALID_CODING_RATE;
+  }
+  if (power < -3 || power > 20) {
+    return RADIOLIB_ERR_INVALID_OUTPUT_POWER;
+  }
+  if (preambleLength < 6) {
+    return RADIOLIB_ERR_INVALID_PREAMBLE_LENGTH;
+  }
+  if (gain > 6) {
+    return RADIOLIB_ERR_INVALID_GAIN;
+  }
+  return setFrequency(freq);
+}
+
+int16_t SX1278::setFrequency(float freq) {
+  if (freq < 137.0 || freq > 525.0) {
+    return RADIOLIB_ERR_INVALID_FREQUENCY;
+  }
+  return RADIOLIB_ERR_NONE;
+}
+
+int16_t SX1278::setCRC(bool enable, bool mode) {
+  return RADIOLIB_ERR_NONE;
+}
+
+int16_t SX1278::setCurrentLimit(uint8_t currentLimit) {
+  if (currentLimit < 45 || currentLimit > 240) {
+    return RADIOLIB_ERR_INVALID_CURRENT_LIMIT;
+  }
+  return RADIOLIB_ERR_NONE;
+}
+
+void SX1278::setDio0Action(void (*func)(void)) {
+  sim::Channel::get().setInterrupt(func);
+}
+
+void SX1278::clearDio0Action() {
+  sim::Channel::get().setInterrupt(NULL);
+}
+
+int16_t SX1278::standby() {
+  sim::Channel::get().standby();
+  return RADIOLIB_ERR_NONE;
+}
+
+int16_t SX1278::startReceive(uint8_t len, uint8_t mode) {
+  sim::Channel::get().startReceive();
+  return RADIOLIB_ERR_NONE;
+}
+
+size_t SX1278::getPacketLength(bool update) {
+  return sim::Channel::get().getPacketLength();
+}
+
+int16_t SX1278::readData(uint8_t *data, size_t len) {
+  return sim::Channel::get().readData(data, len);
+}
+
+int16_t SX1278::readData(String &str, size_t len) {
+  size_t  length = (len > 0) ? len : getPacketLength();
+  uint8_t data[RADIOLIB_SX127X_MAX_PACKET_LENGTH + 1];
+  int16_t state = readData(data, length);
+  data[length]  = '\0';
+  str           = String((const char *)data, length);
+  return state;
+}
+
+float SX1278::getRSSI(bool packet, bool skipReceive) {
+  return sim::Channel::get().getRssi(packet);
+}
+
+float SX1278::getSNR() {
+  return sim::Channel::get().getSnr();
+}
+
+float SX1278::getFrequencyError(bool autoCorrect) {
+  return sim::Channel::get().getFrequencyError();
+}
+
+int16_t SX1278::getModemStatus() {
+  return sim::Channel::get().isReceiving() ? 0x0B : 0x00;
+}
+
+int16_t SX1278::startTransmit(uint8_t *data, size_t len, uint8_t addr) {
+  if (len > RADIOLIB_SX127X_MAX_PACKET_LENGTH) {
+    return RADIOLIB_ERR_PACKET_TOO_LONG;
+  }
+  sim::Channel::get().startTransmit(data, len);
+  return RADIOLIB_ERR_NONE;
+}
+
+int16_t SX1278::startTransmit(String &str, uint8_t addr) {
+  return startTransmit((uint8_t *)str.c_str(), str.length(), addr);
+}
@@ -0,0 +1,67 @@
+#ifndef RADIOLIB_H_
+#define RADIOLIB_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "WString.h"
+
+// Host stand-in of RadioLib 5.7: an SX1278 on the simulated channel of SimRadio.h
+
+#define RADIOLIB_NC 0xFFFFFFFF
+
+#define RADIOLIB_ERR_NONE                     0
+#define RADIOLIB_ERR_UNKNOWN                  -1
+#define RADIOLIB_ERR_CHIP_NOT_FOUND           -2
+#define RADIOLIB_ERR_PACKET_TOO_LONG          -4
+#define RADIOLIB_ERR_TX_TIMEOUT               -5
+#define RADIOLIB_ERR_RX_TIMEOUT               -6
+#define RADIOLIB_ERR_CRC_MISMATCH             -7
+#define RADIOLIB_ERR_INVALID_BANDWIDTH        -8
+#define RADIOLIB_ERR_INVALID_SPREADING_FACTOR -9
+#define RADIOLIB_ERR_INVALID_CODING_RATE      -10
+#define RADIOLIB_ERR_INVALID_FREQUENCY        -12
+#define RADIOLIB_ERR_INVALID_OUTPUT_POWER     -13
+#define RADIOLIB_ERR_INVALID_CURRENT_LIMIT    -17
+#define RADIOLIB_ERR_INVALID_PREAMBLE_LENGTH  -18
+#define RADIOLIB_ERR_INVALID_GAIN             -19
+
+#define RADIOLIB_SX127X_SYNC_WORD         0x12
+#define RADIOLIB_SX127X_MAX_PACKET_LENGTH 255
+#define RADIOLIB_SX127X_RXSINGLE          0b00000110
+#define RADIOLIB_SX127X_RXCONTINUOUS      0b00000101
+
+class Module {
+public:
+  Module(uint32_t cs, uint32_t irq, uint32_t rst, uint32_t gpio = RADIOLIB_NC);
+};
+
+class SX1278 {
+public:
+  explicit SX1278(Module *mod);
+
+  int16_t begin(float freq = 434.0, float bw = 125.0, uint8_t sf = 9, uint8_t cr = 7, uint8_t syncWord = RADIOLIB_SX127X_SYNC_WORD, int8_t power = 10, uint16_t preambleLength = 8, uint8_t gain = 0);
+
+  int16_t setFrequency(float freq);
+  int16_t setCRC(bool enable, bool mode = false);
+  int16_t setCurrentLimit(uint8_t currentLimit);
+
+  void setDio0Action(void (*func)(void));
+  void clearDio0Action();
+
+  int16_t standby();
+  int16_t startReceive(uint8_t len = 0, uint8_t mode = RADIOLIB_SX127X_RXCONTINUOUS);
+  size_t  getPacketLength(bool update = true);
+  int16_t readData(uint8_t *data, size_t len);
+  int16_t readData(String &str, size_t len = 0);
+
+  float   getRSSI(bool packet = true, bool skipReceive = false);
+  float   getSNR();
+  float   getFrequencyError(bool autoCorrect = false);
+  int16_t getModemStatus();
+
+  int16_t startTransmit(uint8_t *data, size_t len, uint8_t addr = 0);
+  int16_t startTransmit(String &str, uint8_t addr = 0);
+};
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef SPI_H_
+#define SPI_H_
+
+#include <stdint.h>
+
+#define MSBFIRST  1
+#define SPI_MODE0 0
+
+class SPISettings {
+public:
+  SPISettings(uint32_t clock, uint8_t bitOrder, uint8_t dataMode) {
+  }
+};
+
+/**
+ * @brief The simulated modem is not behind a bus, the SPI pins are ignored and nothing answers on it.
+ */
+class SPIClass {
+public:
+  void begin(int8_t sck = -1, int8_t miso = -1, int8_t mosi = -1, int8_t ss = -1) {
+  }
+
+  void end() {
+  }
+
+  void beginTransaction(SPISettings settings) {
+  }
+
+  void endTransaction() {
+  }
+
+  uint8_t transfer(uint8_t data) {
+    return 0;
+  }
+};
+
+extern SPIClass SPI;
+
+#endif
@@ -0,0 +1,29 @@
+#include "SPIFFS.h"
+
+#define SPIFFS_PARTITION_SIZE 0x100000
+
+namespace fs {
+
+bool SPIFFSFS::begin(bool formatOnFail, const char *basePath, uint8_t maxOpenFiles, const char *partitionLabel) {
+  return true;
+}
+
+bool SPIFFSFS::format() {
+  clear();
+  return true;
+}
+
+size_t SPIFFSFS::totalBytes() {
+  return SPIFFS_PARTITION_SIZE;
+}
+
+size_t SPIFFSFS::usedBytes() {
+  return getUsedBytes();
+}
+
+void SPIFFSFS::end() {
+}
+
+} // namespace fs
+
+fs::SPIFFSFS SPIFFS;
@@ -0,0 +1,24 @@
+#ifndef SPIFFS_H_
+#define SPIFFS_H_
+
+#include "FS.h"
+
+namespace fs {
+
+/**
+ * @brief In-memory file system with the size of the spiffs partition of partitions.csv.
+ */
+class SPIFFSFS : public FS {
+public:
+  bool   begin(bool formatOnFail = false, const char *basePath = "/spiffs", uint8_t maxOpenFiles = 10, const char *partitionLabel = NULL);
+  bool   format();
+  size_t totalBytes();
+  size_t usedBytes();
+  void   end();
+};
+
+} // namespace fs
+
+extern fs::SPIFFSFS SPIFFS;
+
+#endif
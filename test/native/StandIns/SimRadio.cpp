@@ -0,0 +1,288 @@
+#include "SimRadio.h"
+
+#include <chrono>
+#include <esp_timer.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+
+#define PACKET_LOG_FIELDS 9 // NUMBER, TIMESTAMP, CALLSIGN, TARGET, PATH, DATA, RSSI, SNR, FREQ_ERROR
+
+// The iGate keeps its clock in UTC, so do the tests whatever the time zone of the host
+static struct UtcTimeZone {
+  UtcTimeZone() {
+    setenv("TZ", "UTC0", 1);
+    tzset();
+  }
+} utcTimeZone;
+
+time_t time(time_t *timer) noexcept {
+  time_t now = sim::Channel::get().now();
+  if (timer != NULL) {
+    *timer = now;
+  }
+  return now;
+}
+
+namespace sim {
+
+static const char frameHeader[] = "<\xff\x01";
+
+static std::vector<std::string> split(const std::string &text, char separator) {
+  std::vector<std::string> fields;
+  size_t                   start = 0;
+  for (;;) {
+    size_t end = text.find(separator, start);
+    fields.push_back(text.substr(start, (end == std::string::npos) ? std::string::npos : end - start));
+    if (end == std::string::npos) {
+      return fields;
+    }
+    start = end + 1;
+  }
+}
+
+static std::string trim(const std::string &text) {
+  size_t first = text.find_first_not_of(" \r");
+  if (first == std::string::npos) {
+    return "";
+  }
+  return text.substr(first, text.find_last_not_of(" \r") - first + 1);
+}
+
+std::string toPayload(const std::string &tnc2) {
+  return frameHeader + tnc2;
+}
+
+std::vector<Frame> parsePacketLog(const char *text) {
+  std::vector<Frame> frames;
+  for (const std::string &line : split(text, '\n')) {
+    std::vector<std::string> fields = split(line, '\t');
+    if (fields.size() < PACKET_LOG_FIELDS) {
+      continue;
+    }
+    // A tab in the data (there should be none, they are sanitized) splits it in several fields
+    while (fields.size() > PACKET_LOG_FIELDS) {
+      fields[5] += "\t" + fields[6];
+      fields.erase(fields.begin() + 6);
+    }
+
+    struct tm timeInfo = {};
+    if (sscanf(fields[1].c_str(), "%d-%d-%dT%d:%d:%dZ", &timeInfo.tm_year, &timeInfo.tm_mon, &timeInfo.tm_mday, &timeInfo.tm_hour, &timeInfo.tm_min, &timeInfo.tm_sec) != 6) {
+      continue;
+    }
+    timeInfo.tm_year -= 1900;
+    timeInfo.tm_mon -= 1;
+
+    Frame frame;
+    frame.rxTime    = timegm(&timeInfo);
+    frame.crcOk     = trim(fields[5]) != "INVALID PACKET";
+    frame.rssi      = atof(fields[6].c_str());
+    frame.snr       = atof(fields[7].c_str());
+    frame.freqError = atof(fields[8].c_str());
+    if (frame.crcOk) {
+      std::string tnc2 = fields[2] + ">" + fields[3];
+      if (!fields[4].empty()) {
+        tnc2 += "," + fields[4];
+      }
+      frame.payload = toPayload(tnc2 + ":" + fields[5]);
+    }
+    frames.push_back(frame);
+  }
+  return frames;
+}
+
+std::vector<Frame> parseRawTrace(const char *text, float rssi, float snr) {
+  std::vector<Frame> frames;
+  for (const std::string &line : split(text, '\n')) {
+    size_t tab = line.find('\t');
+    if (tab == std::string::npos) {
+      continue;
+    }
+    Frame frame;
+    frame.rxTime    = strtoll(line.c_str(), NULL, 10);
+    frame.payload   = toPayload(trim(line.substr(tab + 1)));
+    frame.crcOk     = true;
+    frame.rssi      = rssi;
+    frame.snr       = snr;
+    frame.freqError = 0;
+    frames.push_back(frame);
+  }
+  return frames;
+}
+
+Channel &Channel::get() {
+  static Channel channel;
+  return channel;
+}
+
+Channel::Channel() : _running(false), _interrupt(NULL), _next(0), _speed(0), _playStart(0), _traceStart(0), _armed(false), _delivered(0), _noiseRssi(-120), _transmitting(false), _txDone(0), _txDuration(1), _clockSet(false), _clockBase(0), _clockRealBase(0) {
+  _fifo.crcOk = false;
+}
+
+void Channel::play(const std::vector<Frame> &frames, float speed) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  if (frames.empty()) {
+    return;
+  }
+  // Frames not delivered yet from a previous call are dropped
+  _frames.assign(frames.begin(), frames.end());
+  _next       = 0;
+  _speed      = speed;
+  _playStart  = esp_timer_get_time();
+  _traceStart = frames[0].rxTime;
+  if (!_running) {
+    _running = true;
+    std::thread(&Channel::run, this).detach();
+  }
+  _changed.notify_all();
+}
+
+bool Channel::waitIdle(uint32_t timeoutMs) {
+  std::unique_lock<std::mutex> lock(_mutex);
+  return _changed.wait_for(lock, std::chrono::milliseconds(timeoutMs), [this] {
+    return _next == _frames.size() && _armed && !_transmitting;
+  });
+}
+
+std::vector<std::string> Channel::takeTransmitted() {
+  std::lock_guard<std::mutex> lock(_mutex);
+  std::vector<std::string>    transmitted;
+  transmitted.swap(_transmitted);
+  return transmitted;
+}
+
+size_t Channel::getDelivered() {
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _delivered;
+}
+
+void Channel::setNoiseRssi(float rssi) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  _noiseRssi = rssi;
+}
+
+void Channel::setTxDuration(uint32_t ms) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  _txDuration = ms;
+}
+
+void Channel::setInterrupt(void (*handler)(void)) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  _interrupt = handler;
+}
+
+void Channel::startReceive() {
+  std::lock_guard<std::mutex> lock(_mutex);
+  _armed = true;
+  _changed.notify_all();
+}
+
+void Channel::standby() {
+  std::lock_guard<std::mutex> lock(_mutex);
+  _armed = false;
+}
+
+size_t Channel::getPacketLength() {
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _fifo.payload.size();
+}
+
+int16_t Channel::readData(uint8_t *data, size_t length) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  size_t                      n = _fifo.payload.size();
+  if (length > 0 && length < n) {
+    n = length;
+  }
+  memcpy(data, _fifo.payload.data(), n);
+  return _fifo.crcOk ? 0 : -7; // RADIOLIB_ERR_CRC_MISMATCH
+}
+
+float Channel::getRssi(bool packet) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  return packet ? _fifo.rssi : _noiseRssi;
+}
+
+float Channel::getSnr() {
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _fifo.snr;
+}
+
+float Channel::getFrequencyError() {
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _fifo.freqError;
+}
+
+bool Channel::isReceiving() {
+  return false;
+}
+
+void Channel::startTransmit(const uint8_t *data, size_t length) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  _transmitted.push_back(std::string((const char *)data, length));
+  _armed        = false;
+  _transmitting = true;
+  _txDone       = esp_timer_get_time() + (int64_t)_txDuration * 1000;
+  _changed.notify_all();
+}
+
+time_t Channel::now() {
+  std::lock_guard<std::mutex> lock(_mutex);
+  return nowLocked();
+}
+
+time_t Channel::nowLocked() const {
+  if (!_clockSet) {
+    struct timespec real;
+    clock_gettime(CLOCK_REALTIME, &real);
+    return real.tv_sec;
+  }
+  return _clockBase + (time_t)((esp_timer_get_time() - _clockRealBase) * (double)_speed / 1000000);
+}
+
+void Channel::run() {
+  std::unique_lock<std::mutex> lock(_mutex);
+  for (;;) {
+    int64_t now  = esp_timer_get_time();
+    int64_t wake = INT64_MAX;
+    void (*interrupt)(void) = NULL;
+
+    if (_transmitting) {
+      if (now >= _txDone) {
+        _transmitting = false;
+        interrupt     = _interrupt;
+      } else {
+        wake = _txDone;
+      }
+    } else if (_armed && _next < _frames.size()) {
+      const Frame &frame = _frames[_next];
+      int64_t      due   = (_speed > 0) ? _playStart + (int64_t)((frame.rxTime - _traceStart) * 1000000.0 / _speed) : now;
+      if (now >= due) {
+        _fifo          = frame;
+        _armed         = false;
+        _clockSet      = true;
+        _clockBase     = frame.rxTime;
+        _clockRealBase = now;
+        _next++;
+        _delivered++;
+        interrupt = _interrupt;
+      } else {
+        wake = due;
+      }
+    }
+
+    if (interrupt != NULL) {
+      // The interrupt handler runs without the lock, like an ISR it may not call back into the modem
+      lock.unlock();
+      interrupt();
+      lock.lock();
+      _changed.notify_all();
+    } else if (wake == INT64_MAX) {
+      _changed.notify_all();
+      _changed.wait(lock);
+    } else {
+      _changed.wait_for(lock, std::chrono::microseconds(wake - now));
+    }
+  }
+}
+
+} // namespace sim
@@ -0,0 +1,132 @@
+#ifndef SIM_RADIO_H_
+#define SIM_RADIO_H_
+
+#include <condition_variable>
+#include <mutex>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <time.h>
+#include <vector>
+
+namespace sim {
+
+/**
+ * @brief A LoRa frame as received by the modem.
+ */
+struct Frame {
+  time_t      rxTime;  // UNIX time of the reception
+  std::string payload; // Content of the modem FIFO, LoRa APRS header included, empty if the CRC is wrong
+  bool        crcOk;
+  float       rssi;      // dBm
+  float       snr;       // dB
+  float       freqError; // Hz
+};
+
+/**
+ * @brief     Parses a trace in the packets.log format (the TSV lines of PacketLoggerTask, "INVALID PACKET" for the CRC errors).
+ *            The header and the lines that do not parse are skipped.
+ */
+std::vector<Frame> parsePacketLog(const char *text);
+
+/**
+ * @brief     Parses a raw trace, one "<UNIX time>\t<TNC2 frame>" per line, received with the given metrics.
+ */
+std::vector<Frame> parseRawTrace(const char *text, float rssi, float snr);
+
+/**
+ * @brief     Builds the payload of a frame from its TNC2 text.
+ */
+std::string toPayload(const std::string &tnc2);
+
+/**
+ * @brief The radio channel the simulated SX1278 listens to.
+ *
+ * A thread delivers the frames of the trace to the modem: it loads the frame in the FIFO and fires the DIO0 interrupt, then waits
+ * for the modem to go back to RX (which RadiolibTask does after reading the frame) before delivering the next one, so that no
+ * frame is lost even when replaying as fast as possible. The modem is half duplex: no frame is delivered while it transmits.
+ *
+ * The frames transmitted by the modem are recorded, their TX done interrupt fires after the configured duration.
+ *
+ * time() follows the trace: it is set to the time of each frame when delivered, and advances at the replay speed in between.
+ */
+class Channel {
+public:
+  static Channel &get();
+
+  /**
+   * @brief     Queues frames to deliver.
+   *
+   * @param[in] speed Replay speed relative to the times of the frames, 0 to deliver them as fast as the modem reads them.
+   */
+  void play(const std::vector<Frame> &frames, float speed);
+
+  /**
+   * @brief     Waits until all the frames were read by the modem and the last transmission is done.
+   *
+   * @return    false on timeout.
+   */
+  bool waitIdle(uint32_t timeoutMs);
+
+  /**
+   * @brief     Frames sent by the modem since the last call, LoRa APRS header included.
+   */
+  std::vector<std::string> takeTransmitted();
+
+  size_t getDelivered();
+
+  void setNoiseRssi(float rssi);
+  void setTxDuration(uint32_t ms);
+
+  // Modem side, called by the SX1278 stand-in
+  void    setInterrupt(void (*handler)(void));
+  void    startReceive();
+  void    standby();
+  size_t  getPacketLength();
+  int16_t readData(uint8_t *data, size_t length);
+  float   getRssi(bool packet);
+  float   getSnr();
+  float   getFrequencyError();
+  bool    isReceiving();
+  void    startTransmit(const uint8_t *data, size_t length);
+
+  /**
+   * @brief     Simulated wall-clock time, the real one before the first replay.
+   */
+  time_t now();
+
+private:
+  Channel();
+
+  void   run();
+  time_t nowLocked() const;
+
+  std::mutex              _mutex;
+  std::condition_variable _changed;
+  bool                    _running;
+  void (*_interrupt)(void);
+
+  std::vector<Frame> _frames;
+  size_t             _next;
+  float              _speed;
+  int64_t            _playStart;  // esp_timer time (us) of the play() call
+  time_t             _traceStart; // Time of the first frame of the play() call
+
+  bool     _armed; // The modem listens and its FIFO was read
+  Frame    _fifo;
+  size_t   _delivered;
+  float    _noiseRssi;
+  bool     _transmitting;
+  int64_t  _txDone; // esp_timer time (us) of the TX done interrupt
+  uint32_t _txDuration;
+
+  std::vector<std::string> _transmitted;
+
+  bool    _clockSet;
+  time_t  _clockBase;     // Simulated time at _clockRealBase
+  int64_t _clockRealBase; // esp_timer time (us)
+};
+
+} // namespace sim
+
+#endif
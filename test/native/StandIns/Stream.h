@@ -0,0 +1,42 @@
+#ifndef STREAM_H_
+#define STREAM_H_
+
+#include "Print.h"
+
+/**
+ * @brief Host stand-in of the Arduino Stream. The data of the stand-in streams is always in memory, so the reads never wait for
+ *        more bytes and the timeout is only kept for the interface.
+ */
+class Stream : public Print {
+public:
+  Stream() : _timeout(1000) {
+  }
+
+  virtual int available() = 0;
+  virtual int read()      = 0;
+  virtual int peek()      = 0;
+
+  void setTimeout(unsigned long timeout) {
+    _timeout = timeout;
+  }
+
+  unsigned long getTimeout() const {
+    return _timeout;
+  }
+
+  virtual size_t readBytes(char *buffer, size_t length);
+
+  size_t readBytes(uint8_t *buffer, size_t length) {
+    return readBytes((char *)buffer, length);
+  }
+
+  size_t readBytesUntil(char terminator, char *buffer, size_t length);
+
+  String readString();
+  String readStringUntil(char terminator);
+
+protected:
+  unsigned long _timeout;
+};
+
+#endif
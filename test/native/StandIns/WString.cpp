@@ -0,0 +1,400 @@
+#include "WString.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static std::string toBase(unsigned long long value, unsigned char base) {
+  if (base < 2 || base > 36) {
+    base = 10;
+  }
+  char  digits[65];
+  char *p = &digits[sizeof(digits) - 1];
+  *p      = '\0';
+  do {
+    unsigned int digit = value % base;
+    *--p               = (digit < 10) ? '0' + digit : 'a' + digit - 10;
+    value /= base;
+  } while (value != 0);
+  return p;
+}
+
+static std::string toSigned(long long value, unsigned char base) {
+  if (base == 10 && value < 0) {
+    return "-" + toBase(-(unsigned long long)value, base);
+  }
+  return toBase((unsigned long long)value, base);
+}
+
+static std::string toFixed(double value, unsigned int decimalPlaces) {
+  char buffer[64];
+  snprintf(buffer, sizeof(buffer), "%.*f", decimalPlaces, value);
+  return buffer;
+}
+
+String::String(const char *cstr) : _buffer(cstr != NULL ? cstr : "") {
+}
+
+String::String(const char *cstr, unsigned int length) : _buffer(cstr != NULL ? std::string(cstr, length) : "") {
+}
+
+String::String(const String &str) : _buffer(str._buffer) {
+}
+
+String::String(String &&rval) : _buffer(std::move(rval._buffer)) {
+}
+
+String::String(StringSumHelper &&rval) : _buffer(std::move(static_cast<String &>(rval)._buffer)) {
+}
+
+String::String(char c) : _buffer(1, c) {
+}
+
+String::String(unsigned char value, unsigned char base) : _buffer(toBase(value, base)) {
+}
+
+String::String(int value, unsigned char base) : _buffer(base == 10 ? toSigned(value, base) : toBase((unsigned int)value, base)) {
+}
+
+String::String(unsigned int value, unsigned char base) : _buffer(toBase(value, base)) {
+}
+
+String::String(long value, unsigned char base) : _buffer(base == 10 ? toSigned(value, base) : toBase((unsigned long)value, base)) {
+}
+
+String::String(unsigned long value, unsigned char base) : _buffer(toBase(value, base)) {
+}
+
+String::String(float value, unsigned int decimalPlaces) : _buffer(toFixed(value, decimalPlaces)) {
+}
+
+String::String(double value, unsigned int decimalPlaces) : _buffer(toFixed(value, decimalPlaces)) {
+}
+
+String::String(long long value, unsigned char base) : _buffer(toSigned(value, base)) {
+}
+
+String::String(unsigned long long value, unsigned char base) : _buffer(toBase(value, base)) {
+}
+
+String::~String() {
+}
+
+bool String::reserve(unsigned int size) {
+  _buffer.reserve(size);
+  return true;
+}
+
+String &String::operator=(const String &rhs) {
+  if (this != &rhs) {
+    _buffer = rhs._buffer;
+  }
+  return *this;
+}
+
+String &String::operator=(const char *cstr) {
+  _buffer = (cstr != NULL) ? cstr : "";
+  return *this;
+}
+
+String &String::operator=(String &&rval) {
+  if (this != &rval) {
+    _buffer = std::move(rval._buffer);
+  }
+  return *this;
+}
+
+String &String::operator=(StringSumHelper &&rval) {
+  return *this = static_cast<String &&>(rval);
+}
+
+bool String::concat(const String &str) {
+  _buffer += str._buffer;
+  return true;
+}
+
+bool String::concat(const char *cstr) {
+  if (cstr == NULL) {
+    return false;
+  }
+  _buffer += cstr;
+  return true;
+}
+
+bool String::concat(const char *cstr, unsigned int length) {
+  if (cstr == NULL) {
+    return false;
+  }
+  _buffer.append(cstr, length);
+  return true;
+}
+
+bool String::concat(char c) {
+  _buffer += c;
+  return true;
+}
+
+bool String::concat(unsigned char num) {
+  return concat(String(num));
+}
+
+bool String::concat(int num) {
+  return concat(String(num));
+}
+
+bool String::concat(unsigned int num) {
+  return concat(String(num));
+}
+
+bool String::concat(long num) {
+  return concat(String(num));
+}
+
+bool String::concat(unsigned long num) {
+  return concat(String(num));
+}
+
+bool String::concat(float num) {
+  return concat(String(num));
+}
+
+bool String::concat(double num) {
+  return concat(String(num));
+}
+
+bool String::concat(long long num) {
+  return concat(String(num));
+}
+
+bool String::concat(unsigned long long num) {
+  return concat(String(num));
+}
+
+// The sum helper is a temporary, appending to it in place is how the Arduino core chains the + operators
+#define STRING_SUM(type)                                              \
+  StringSumHelper &operator+(const StringSumHelper &lhs, type rhs) { \
+    StringSumHelper &a = const_cast<StringSumHelper &>(lhs);          \
+    a.concat(rhs);                                                    \
+    return a;                                                         \
+  }
+
+STRING_SUM(const String &)
+STRING_SUM(const char *)
+STRING_SUM(char)
+STRING_SUM(unsigned char)
+STRING_SUM(int)
+STRING_SUM(unsigned int)
+STRING_SUM(long)
+STRING_SUM(unsigned long)
+STRING_SUM(float)
+STRING_SUM(double)
+STRING_SUM(long long)
+STRING_SUM(unsigned long long)
+
+int String::compareTo(const String &s) const {
+  return strcmp(c_str(), s.c_str());
+}
+
+bool String::equals(const String &s) const {
+  return _buffer == s._buffer;
+}
+
+bool String::equals(const char *cstr) const {
+  return strcmp(c_str(), cstr != NULL ? cstr : "") == 0;
+}
+
+bool String::equalsIgnoreCase(const String &s) const {
+  return length() == s.length() && strcasecmp(c_str(), s.c_str()) == 0;
+}
+
+bool String::startsWith(const String &prefix) const {
+  return startsWith(prefix, 0);
+}
+
+bool String::startsWith(const String &prefix, unsigned int offset) const {
+  if (offset > length() || prefix.length() > length() - offset) {
+    return false;
+  }
+  return _buffer.compare(offset, prefix.length(), prefix._buffer) == 0;
+}
+
+bool String::endsWith(const String &suffix) const {
+  if (suffix.length() > length()) {
+    return false;
+  }
+  return _buffer.compare(length() - suffix.length(), suffix.length(), suffix._buffer) == 0;
+}
+
+char String::charAt(unsigned int index) const {
+  return (*this)[index];
+}
+
+void String::setCharAt(unsigned int index, char c) {
+  if (index < length()) {
+    _buffer[index] = c;
+  }
+}
+
+char String::operator[](unsigned int index) const {
+  return (index < length()) ? _buffer[index] : '\0';
+}
+
+char &String::operator[](unsigned int index) {
+  static char dummy;
+  if (index >= length()) {
+    dummy = '\0';
+    return dummy;
+  }
+  return _buffer[index];
+}
+
+void String::getBytes(unsigned char *buf, unsigned int bufsize, unsigned int index) const {
+  if (bufsize == 0 || buf == NULL) {
+    return;
+  }
+  if (index >= length()) {
+    buf[0] = '\0';
+    return;
+  }
+  unsigned int n = length() - index;
+  if (n > bufsize - 1) {
+    n = bufsize - 1;
+  }
+  memcpy(buf, c_str() + index, n);
+  buf[n] = '\0';
+}
+
+void String::toCharArray(char *buf, unsigned int bufsize, unsigned int index) const {
+  getBytes((unsigned char *)buf, bufsize, index);
+}
+
+int String::indexOf(char ch) const {
+  return indexOf(ch, 0);
+}
+
+int String::indexOf(char ch, unsigned int fromIndex) const {
+  size_t pos = _buffer.find(ch, fromIndex);
+  return (pos == std::string::npos) ? -1 : (int)pos;
+}
+
+int String::indexOf(const String &str) const {
+  return indexOf(str, 0);
+}
+
+int String::indexOf(const String &str, unsigned int fromIndex) const {
+  if (fromIndex >= length()) {
+    return -1;
+  }
+  size_t pos = _buffer.find(str._buffer, fromIndex);
+  return (pos == std::string::npos) ? -1 : (int)pos;
+}
+
+int String::lastIndexOf(char ch) const {
+  return lastIndexOf(ch, length() - 1);
+}
+
+int String::lastIndexOf(char ch, unsigned int fromIndex) const {
+  if (fromIndex >= length()) {
+    return -1;
+  }
+  size_t pos = _buffer.rfind(ch, fromIndex);
+  return (pos == std::string::npos) ? -1 : (int)pos;
+}
+
+int String::lastIndexOf(const String &str) const {
+  return lastIndexOf(str, length() - str.length());
+}
+
+int String::lastIndexOf(const String &str, unsigned int fromIndex) const {
+  if (str.length() == 0 || str.length() > length() || fromIndex >= length()) {
+    return -1;
+  }
+  size_t pos = _buffer.rfind(str._buffer, fromIndex);
+  return (pos == std::string::npos) ? -1 : (int)pos;
+}
+
+String String::substring(unsigned int beginIndex) const {
+  return substring(beginIndex, length());
+}
+
+String String::substring(unsigned int left, unsigned int right) const {
+  if (left > right) {
+    unsigned int temp = right;
+    right             = left;
+    left              = temp;
+  }
+  if (left >= length()) {
+    return String();
+  }
+  if (right > length()) {
+    right = length();
+  }
+  return String(c_str() + left, right - left);
+}
+
+void String::replace(char find, char replace) {
+  for (char &c : _buffer) {
+    if (c == find) {
+      c = replace;
+    }
+  }
+}
+
+void String::replace(const String &find, const String &replace) {
+  if (find.length() == 0) {
+    return;
+  }
+  size_t pos = 0;
+  while ((pos = _buffer.find(find._buffer, pos)) != std::string::npos) {
+    _buffer.replace(pos, find.length(), replace._buffer);
+    pos += replace.length();
+  }
+}
+
+void String::remove(unsigned int index) {
+  remove(index, (unsigned int)-1);
+}
+
+void String::remove(unsigned int index, unsigned int count) {
+  if (index >= length()) {
+    return;
+  }
+  _buffer.erase(index, count);
+}
+
+void String::toLowerCase() {
+  for (char &c : _buffer) {
+    c = tolower((unsigned char)c);
+  }
+}
+
+void String::toUpperCase() {
+  for (char &c : _buffer) {
+    c = toupper((unsigned char)c);
+  }
+}
+
+void String::trim() {
+  size_t first = 0;
+  while (first < _buffer.length() && isspace((unsigned char)_buffer[first])) {
+    first++;
+  }
+  size_t last = _buffer.length();
+  while (last > first && isspace((unsigned char)_buffer[last - 1])) {
+    last--;
+  }
+  _buffer = _buffer.substr(first, last - first);
+}
+
+long String::toInt() const {
+  return atol(c_str());
+}
+
+float String::toFloat() const {
+  return (float)atof(c_str());
+}
+
+double String::toDouble() const {
+  return atof(c_str());
+}
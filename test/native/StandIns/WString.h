@@ -0,0 +1,208 @@
+#ifndef WSTRING_H_
+#define WSTRING_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+class StringSumHelper;
+
+/**
+ * @brief Host stand-in of the Arduino String, with the same interface as the ESP32 core one. Backed by a std::string.
+ */
+class String {
+public:
+  String(const char *cstr = "");
+  String(const char *cstr, unsigned int length);
+  String(const String &str);
+  String(String &&rval);
+  String(StringSumHelper &&rval);
+  explicit String(char c);
+  explicit String(unsigned char value, unsigned char base = 10);
+  explicit String(int value, unsigned char base = 10);
+  explicit String(unsigned int value, unsigned char base = 10);
+  explicit String(long value, unsigned char base = 10);
+  explicit String(unsigned long value, unsigned char base = 10);
+  explicit String(float value, unsigned int decimalPlaces = 2);
+  explicit String(double value, unsigned int decimalPlaces = 2);
+  explicit String(long long value, unsigned char base = 10);
+  explicit String(unsigned long long value, unsigned char base = 10);
+  ~String();
+
+  bool reserve(unsigned int size);
+
+  unsigned int length() const {
+    return _buffer.length();
+  }
+
+  bool isEmpty() const {
+    return _buffer.empty();
+  }
+
+  void clear() {
+    _buffer.clear();
+  }
+
+  const char *c_str() const {
+    return _buffer.c_str();
+  }
+
+  char *begin() {
+    return &_buffer[0];
+  }
+
+  char *end() {
+    return &_buffer[0] + _buffer.length();
+  }
+
+  explicit operator bool() const {
+    return true;
+  }
+
+  String &operator=(const String &rhs);
+  String &operator=(const char *cstr);
+  String &operator=(String &&rval);
+  String &operator=(StringSumHelper &&rval);
+
+  bool concat(const String &str);
+  bool concat(const char *cstr);
+  bool concat(const char *cstr, unsigned int length);
+  bool concat(char c);
+  bool concat(unsigned char num);
+  bool concat(int num);
+  bool concat(unsigned int num);
+  bool concat(long num);
+  bool concat(unsigned long num);
+  bool concat(float num);
+  bool concat(double num);
+  bool concat(long long num);
+  bool concat(unsigned long long num);
+
+  template <typename T> String &operator+=(const T &rhs) {
+    concat(rhs);
+    return *this;
+  }
+
+  String &operator+=(const char *cstr) {
+    concat(cstr);
+    return *this;
+  }
+
+  friend StringSumHelper &operator+(const StringSumHelper &lhs, const String &rhs);
+  friend StringSumHelper &operator+(const StringSumHelper &lhs, const char *cstr);
+  friend StringSumHelper &operator+(const StringSumHelper &lhs, char c);
+  friend StringSumHelper &operator+(const StringSumHelper &lhs, unsigned char num);
+  friend StringSumHelper &operator+(const StringSumHelper &lhs, int num);
+  friend StringSumHelper &operator+(const StringSumHelper &lhs, unsigned int num);
+  friend StringSumHelper &operator+(const StringSumHelper &lhs, long num);
+  friend StringSumHelper &operator+(const StringSumHelper &lhs, unsigned long num);
+  friend StringSumHelper &operator+(const StringSumHelper &lhs, float num);
+  friend StringSumHelper &operator+(const StringSumHelper &lhs, double num);
+  friend StringSumHelper &operator+(const StringSumHelper &lhs, long long num);
+  friend StringSumHelper &operator+(const StringSumHelper &lhs, unsigned long long num);
+
+  int  compareTo(const String &s) const;
+  bool equals(const String &s) const;
+  bool equals(const char *cstr) const;
+  bool equalsIgnoreCase(const String &s) const;
+  bool startsWith(const String &prefix) const;
+  bool startsWith(const String &prefix, unsigned int offset) const;
+  bool endsWith(const String &suffix) const;
+
+  bool operator==(const String &rhs) const {
+    return equals(rhs);
+  }
+  bool operator==(const char *cstr) const {
+    return equals(cstr);
+  }
+  bool operator!=(const String &rhs) const {
+    return !equals(rhs);
+  }
+  bool operator!=(const char *cstr) const {
+    return !equals(cstr);
+  }
+  bool operator<(const String &rhs) const {
+    return compareTo(rhs) < 0;
+  }
+  bool operator>(const String &rhs) const {
+    return compareTo(rhs) > 0;
+  }
+  bool operator<=(const String &rhs) const {
+    return compareTo(rhs) <= 0;
+  }
+  bool operator>=(const String &rhs) const {
+    return compareTo(rhs) >= 0;
+  }
+
+  char  charAt(unsigned int index) const;
+  void  setCharAt(unsigned int index, char c);
+  char  operator[](unsigned int index) const;
+  char &operator[](unsigned int index);
+  void  getBytes(unsigned char *buf, unsigned int bufsize, unsigned int index = 0) const;
+  void  toCharArray(char *buf, unsigned int bufsize, unsigned int index = 0) const;
+
+  int indexOf(char ch) const;
+  int indexOf(char ch, unsigned int fromIndex) const;
+  int indexOf(const String &str) const;
+  int indexOf(const String &str, unsigned int fromIndex) const;
+  int lastIndexOf(char ch) const;
+  int lastIndexOf(char ch, unsigned int fromIndex) const;
+  int lastIndexOf(const String &str) const;
+  int lastIndexOf(const String &str, unsigned int fromIndex) const;
+
+  String substring(unsigned int beginIndex) const;
+  String substring(unsigned int beginIndex, unsigned int endIndex) const;
+
+  void replace(char find, char replace);
+  void replace(const String &find, const String &replace);
+  void remove(unsigned int index);
+  void remove(unsigned int index, unsigned int count);
+  void toLowerCase();
+  void toUpperCase();
+  void trim();
+
+  long   toInt() const;
+  float  toFloat() const;
+  double toDouble() const;
+
+private:
+  std::string _buffer;
+};
+
+class StringSumHelper : public String {
+public:
+  StringSumHelper(const String &s) : String(s) {
+  }
+  StringSumHelper(const char *p) : String(p) {
+  }
+  StringSumHelper(char c) : String(c) {
+  }
+  StringSumHelper(unsigned char num) : String(num) {
+  }
+  StringSumHelper(int num) : String(num) {
+  }
+  StringSumHelper(unsigned int num) : String(num) {
+  }
+  StringSumHelper(long num) : String(num) {
+  }
+  StringSumHelper(unsigned long num) : String(num) {
+  }
+  StringSumHelper(float num) : String(num) {
+  }
+  StringSumHelper(double num) : String(num) {
+  }
+  StringSumHelper(long long num) : String(num) {
+  }
+  StringSumHelper(unsigned long long num) : String(num) {
+  }
+};
+
+inline bool operator==(const char *lhs, const String &rhs) {
+  return rhs.equals(lhs);
+}
+
+inline bool operator!=(const char *lhs, const String &rhs) {
+  return !rhs.equals(lhs);
+}
+
+#endif
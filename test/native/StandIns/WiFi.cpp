@@ -0,0 +1,207 @@
+#include "WiFi.h"
+
+#include <atomic>
+#include <lwip/sockets.h>
+#include <netdb.h>
+#include <string.h>
+
+#define WIFI_CLIENT_DEF_CONN_TIMEOUT_MS 3000
+#define WIFI_CLIENT_MAX_WRITE_RETRY     10
+#define WIFI_CLIENT_SELECT_TIMEOUT_US   1000000
+
+WiFiClass WiFi;
+
+static std::atomic<size_t> writesBeforeFailure(SIZE_MAX);
+
+void nativeWiFiFailWritesAfter(size_t bytes) {
+  writesBeforeFailure = bytes;
+}
+
+class WiFiClient::Socket {
+public:
+  explicit Socket(int fd) : fd(fd) {
+  }
+
+  ~Socket() {
+    close(fd);
+  }
+
+  const int fd;
+};
+
+int WiFiClass::hostByName(const char *hostname, IPAddress &result) {
+  struct addrinfo  hints = {};
+  struct addrinfo *info;
+  hints.ai_family = AF_INET;
+  if (getaddrinfo(hostname, NULL, &hints, &info) != 0) {
+    return 0;
+  }
+  result = IPAddress((uint32_t)((struct sockaddr_in *)info->ai_addr)->sin_addr.s_addr);
+  freeaddrinfo(info);
+  return 1;
+}
+
+wl_status_t WiFiClass::status() {
+  return WL_CONNECTED;
+}
+
+int8_t WiFiClass::RSSI() {
+  return 0;
+}
+
+WiFiClient::WiFiClient() : _connected(false) {
+}
+
+WiFiClient::WiFiClient(int fd) : _socket(new Socket(fd)), _connected(true) {
+}
+
+int WiFiClient::connect(IPAddress ip, uint16_t port) {
+  return connect(ip, port, WIFI_CLIENT_DEF_CONN_TIMEOUT_MS);
+}
+
+int WiFiClient::connect(IPAddress ip, uint16_t port, int32_t timeout) {
+  stop();
+  int fd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+  if (fd < 0) {
+    return 0;
+  }
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+
+  struct sockaddr_in address = {};
+  address.sin_family         = AF_INET;
+  address.sin_addr.s_addr    = (uint32_t)ip;
+  address.sin_port           = htons(port);
+  if (::connect(fd, (struct sockaddr *)&address, sizeof(address)) < 0 && errno != EINPROGRESS) {
+    close(fd);
+    return 0;
+  }
+
+  fd_set writable;
+  FD_ZERO(&writable);
+  FD_SET(fd, &writable);
+  struct timeval tv = {timeout / 1000, (timeout % 1000) * 1000};
+  int            error;
+  socklen_t      length = sizeof(error);
+  if (select(fd + 1, NULL, &writable, NULL, &tv) <= 0 || getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &length) < 0 || error != 0) {
+    close(fd);
+    return 0;
+  }
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) & ~O_NONBLOCK);
+  _socket.reset(new Socket(fd));
+  _connected = true;
+  return 1;
+}
+
+int WiFiClient::connect(const char *host, uint16_t port) {
+  return connect(host, port, WIFI_CLIENT_DEF_CONN_TIMEOUT_MS);
+}
+
+int WiFiClient::connect(const char *host, uint16_t port, int32_t timeout) {
+  IPAddress ip;
+  if (!WiFi.hostByName(host, ip)) {
+    return 0;
+  }
+  return connect(ip, port, timeout);
+}
+
+size_t WiFiClient::write(uint8_t c) {
+  return write(&c, 1);
+}
+
+size_t WiFiClient::write(const uint8_t *buf, size_t size) {
+  if (!_connected) {
+    return 0;
+  }
+
+  size_t sent = 0;
+  for (int retry = WIFI_CLIENT_MAX_WRITE_RETRY; retry > 0 && sent < size; retry--) {
+    fd_set writable;
+    FD_ZERO(&writable);
+    FD_SET(fd(), &writable);
+    struct timeval tv = {0, WIFI_CLIENT_SELECT_TIMEOUT_US};
+    if (select(fd() + 1, NULL, &writable, NULL, &tv) < 0) {
+      break;
+    }
+    if (!FD_ISSET(fd(), &writable)) {
+      continue;
+    }
+
+    size_t  allowed = writesBeforeFailure;
+    ssize_t res     = (allowed == 0) ? -1 : send(fd(), buf + sent, std::min(size - sent, allowed), MSG_DONTWAIT | MSG_NOSIGNAL);
+    if (allowed == 0) {
+      // A single reset, the next connections work
+      writesBeforeFailure = SIZE_MAX;
+      errno               = ECONNRESET;
+    }
+    if (res > 0) {
+      sent += res;
+      if (allowed != SIZE_MAX) {
+        writesBeforeFailure = allowed - res;
+      }
+      retry = WIFI_CLIENT_MAX_WRITE_RETRY + 1;
+    } else if (res < 0 && errno != EAGAIN) {
+      stop();
+      break;
+    }
+  }
+  return sent;
+}
+
+int WiFiClient::available() {
+  int count = 0;
+  if (!_connected || ioctl(fd(), FIONREAD, &count) < 0) {
+    return 0;
+  }
+  return count;
+}
+
+int WiFiClient::read() {
+  uint8_t c;
+  return (read(&c, 1) == 1) ? c : -1;
+}
+
+int WiFiClient::read(uint8_t *buf, size_t size) {
+  if (!_connected) {
+    return -1;
+  }
+  ssize_t res = recv(fd(), buf, size, MSG_DONTWAIT);
+  if (res < 0 && errno != EAGAIN) {
+    stop();
+  }
+  return res;
+}
+
+int WiFiClient::peek() {
+  uint8_t c;
+  if (!_connected || recv(fd(), &c, 1, MSG_DONTWAIT | MSG_PEEK) != 1) {
+    return -1;
+  }
+  return c;
+}
+
+void WiFiClient::flush() {
+}
+
+void WiFiClient::stop() {
+  _socket.reset();
+  _connected = false;
+}
+
+uint8_t WiFiClient::connected() {
+  if (_connected) {
+    uint8_t c;
+    ssize_t res = recv(fd(), &c, 1, MSG_DONTWAIT | MSG_PEEK);
+    if (res == 0 || (res < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+      stop();
+    }
+  }
+  return _connected;
+}
+
+WiFiClient::operator bool() {
+  return connected();
+}
+
+int WiFiClient::fd() const {
+  return _socket ? _socket->fd : -1;
+}
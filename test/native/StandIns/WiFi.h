@@ -0,0 +1,69 @@
+#ifndef WIFI_H_
+#define WIFI_H_
+
+#include <memory>
+
+#include "Client.h"
+#include "IPAddress.h"
+
+/**
+ * @brief TCP client over the sockets of the host, with the behaviour of the ESP32 core one: connect() waits at most its timeout,
+ *        write() stops at the first error and returns the bytes sent until then, read() never blocks.
+ */
+class WiFiClient : public Client {
+public:
+  WiFiClient();
+  explicit WiFiClient(int fd); // Takes over a connected socket
+
+  int     connect(IPAddress ip, uint16_t port) override;
+  int     connect(IPAddress ip, uint16_t port, int32_t timeout);
+  int     connect(const char *host, uint16_t port) override;
+  int     connect(const char *host, uint16_t port, int32_t timeout);
+  size_t  write(uint8_t c) override;
+  size_t  write(const uint8_t *buf, size_t size) override;
+  int     available() override;
+  int     read() override;
+  int     read(uint8_t *buf, size_t size) override;
+  int     peek() override;
+  void    flush() override;
+  void    stop() override;
+  uint8_t connected() override;
+  operator bool() override;
+  int     fd() const;
+
+  using Print::write;
+
+private:
+  class Socket;
+  std::shared_ptr<Socket> _socket;
+  bool                    _connected;
+};
+
+typedef enum {
+  WL_IDLE_STATUS     = 0,
+  WL_NO_SSID_AVAIL   = 1,
+  WL_SCAN_COMPLETED  = 2,
+  WL_CONNECTED       = 3,
+  WL_CONNECT_FAILED  = 4,
+  WL_CONNECTION_LOST = 5,
+  WL_DISCONNECTED    = 6,
+} wl_status_t;
+
+/**
+ * @brief The network of the host, always connected.
+ */
+class WiFiClass {
+public:
+  static int         hostByName(const char *hostname, IPAddress &result);
+  static wl_status_t status();
+  static int8_t      RSSI();
+};
+
+extern WiFiClass WiFi;
+
+/**
+ * @brief     Resets the connection of the client writing once the given number of bytes were sent by all the clients, only once.
+ */
+void nativeWiFiFailWritesAfter(size_t bytes);
+
+#endif
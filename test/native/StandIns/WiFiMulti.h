@@ -0,0 +1,17 @@
+#ifndef WIFIMULTI_H_
+#define WIFIMULTI_H_
+
+#include "IPAddress.h"
+
+class WiFiMulti {
+public:
+  bool addAP(const char *ssid, const char *passphrase = NULL) {
+    return true;
+  }
+
+  uint8_t run(uint32_t connectTimeout = 5000) {
+    return 0;
+  }
+};
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef WIFIUDP_H_
+#define WIFIUDP_H_
+
+#include "IPAddress.h"
+#include "Stream.h"
+
+/**
+ * @brief There is no network on the host, no packet can be sent.
+ */
+class WiFiUDP : public Stream {
+public:
+  int beginPacket(IPAddress ip, uint16_t port) {
+    return 0;
+  }
+
+  int beginPacket(const char *host, uint16_t port) {
+    return 0;
+  }
+
+  int endPacket() {
+    return 0;
+  }
+
+  size_t write(uint8_t c) override {
+    return 0;
+  }
+
+  using Print::write;
+
+  int available() override {
+    return 0;
+  }
+
+  int read() override {
+    return -1;
+  }
+
+  int peek() override {
+    return -1;
+  }
+};
+
+#endif
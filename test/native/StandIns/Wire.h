@@ -0,0 +1,54 @@
+#ifndef WIRE_H_
+#define WIRE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "Stream.h"
+
+/**
+ * @brief I2C bus without any device: transmissions are not acknowledged and nothing can be read.
+ */
+class TwoWire : public Stream {
+public:
+  bool begin(int sda = -1, int scl = -1, uint32_t frequency = 0) {
+    return true;
+  }
+
+  bool end() {
+    return true;
+  }
+
+  void beginTransmission(uint16_t address) {
+  }
+
+  uint8_t endTransmission(bool sendStop = true) {
+    return 2; // NACK on the address
+  }
+
+  uint8_t requestFrom(uint16_t address, uint8_t size, bool sendStop = true) {
+    return 0;
+  }
+
+  size_t write(uint8_t c) override {
+    return 1;
+  }
+
+  using Print::write;
+
+  int available() override {
+    return 0;
+  }
+
+  int read() override {
+    return -1;
+  }
+
+  int peek() override {
+    return -1;
+  }
+};
+
+extern TwoWire Wire;
+
+#endif
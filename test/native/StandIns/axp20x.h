@@ -0,0 +1,45 @@
+#ifndef AXP20X_H_
+#define AXP20X_H_
+
+#include <stdint.h>
+
+#include "Wire.h"
+
+#define AXP192_SLAVE_ADDRESS 0x34
+#define AXP202_SLAVE_ADDRESS 0x35
+
+#define AXP202_OFF 0
+#define AXP202_ON  1
+
+#define AXP_PASS     0
+#define AXP_FAIL     -1
+#define AXP_NOT_INIT -2
+
+enum {
+  AXP192_DCDC1 = 0,
+  AXP192_DCDC3 = 1,
+  AXP192_LDO2  = 2,
+  AXP192_LDO3  = 3,
+  AXP192_DCDC2 = 4,
+  AXP192_EXTEN = 6,
+};
+
+/**
+ * @brief Power chip stand-in, none is ever found on the bus.
+ */
+class AXP20X_Class {
+public:
+  int begin(TwoWire &port = Wire, uint8_t addr = AXP202_SLAVE_ADDRESS, bool isAxp173 = false) {
+    return AXP_FAIL;
+  }
+
+  int setDCDC1Voltage(uint16_t mv) {
+    return AXP_NOT_INIT;
+  }
+
+  int setPowerOutPut(uint8_t ch, bool en) {
+    return AXP_NOT_INIT;
+  }
+};
+
+#endif
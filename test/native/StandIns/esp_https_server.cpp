@@ -0,0 +1,56 @@
+#include "esp_https_server.h"
+
+#include <string.h>
+
+esp_err_t httpd_resp_set_type(httpd_req_t *r, const char *type) {
+  r->type = type;
+  return ESP_OK;
+}
+
+esp_err_t httpd_resp_set_hdr(httpd_req_t *r, const char *field, const char *value) {
+  return ESP_OK;
+}
+
+esp_err_t httpd_resp_send_chunk(httpd_req_t *r, const char *buf, ssize_t buf_len) {
+  if (buf == NULL) {
+    r->complete = true;
+    return ESP_OK;
+  }
+  r->body.append(buf, buf_len);
+  return ESP_OK;
+}
+
+esp_err_t httpd_resp_sendstr_chunk(httpd_req_t *r, const char *str) {
+  return httpd_resp_send_chunk(r, str, (str != NULL) ? strlen(str) : 0);
+}
+
+esp_err_t httpd_req_get_url_query_str(httpd_req_t *r, char *buf, size_t buf_len) {
+  if (r->query.empty()) {
+    return ESP_ERR_NOT_FOUND;
+  }
+  strncpy(buf, r->query.c_str(), buf_len - 1);
+  buf[buf_len - 1] = '\0';
+  return ESP_OK;
+}
+
+esp_err_t httpd_query_key_value(const char *qry, const char *key, char *val, size_t val_size) {
+  size_t keyLength = strlen(key);
+  while (qry != NULL && *qry != '\0') {
+    const char *end = strchr(qry, '&');
+    if (end == NULL) {
+      end = qry + strlen(qry);
+    }
+    if (strncmp(qry, key, keyLength) == 0 && qry[keyLength] == '=') {
+      const char *value  = qry + keyLength + 1;
+      size_t      length = end - value;
+      if (length >= val_size) {
+        length = val_size - 1;
+      }
+      memcpy(val, value, length);
+      val[length] = '\0';
+      return ESP_OK;
+    }
+    qry = (*end == '&') ? end + 1 : end;
+  }
+  return ESP_ERR_NOT_FOUND;
+}
@@ -0,0 +1,26 @@
+#ifndef ESP_HTTPS_SERVER_H_
+#define ESP_HTTPS_SERVER_H_
+
+#include <stddef.h>
+#include <string>
+
+#include "esp_system.h"
+
+/**
+ * @brief A request served by the host stand-in: its query is set by the test and the response is collected in body.
+ */
+typedef struct httpd_req {
+  std::string query;
+  std::string type;
+  std::string body;
+  bool        complete; // The final (NULL) chunk was sent
+} httpd_req_t;
+
+esp_err_t httpd_resp_set_type(httpd_req_t *r, const char *type);
+esp_err_t httpd_resp_set_hdr(httpd_req_t *r, const char *field, const char *value);
+esp_err_t httpd_resp_send_chunk(httpd_req_t *r, const char *buf, ssize_t buf_len);
+esp_err_t httpd_resp_sendstr_chunk(httpd_req_t *r, const char *str);
+esp_err_t httpd_req_get_url_query_str(httpd_req_t *r, char *buf, size_t buf_len);
+esp_err_t httpd_query_key_value(const char *qry, const char *key, char *val, size_t val_size);
+
+#endif
@@ -0,0 +1,42 @@
+#include "esp_system.h"
+
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+static std::mutex                      handlersMutex;
+static std::vector<shutdown_handler_t> handlers;
+
+esp_err_t esp_register_shutdown_handler(shutdown_handler_t handle) {
+  std::lock_guard<std::mutex> lock(handlersMutex);
+  if (std::find(handlers.begin(), handlers.end(), handle) != handlers.end()) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  handlers.push_back(handle);
+  return ESP_OK;
+}
+
+esp_err_t esp_unregister_shutdown_handler(shutdown_handler_t handle) {
+  std::lock_guard<std::mutex> lock(handlersMutex);
+  std::vector<shutdown_handler_t>::iterator it = std::find(handlers.begin(), handlers.end(), handle);
+  if (it == handlers.end()) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  handlers.erase(it);
+  return ESP_OK;
+}
+
+void esp_restart() {
+  std::vector<shutdown_handler_t> toCall;
+  {
+    std::lock_guard<std::mutex> lock(handlersMutex);
+    toCall = handlers;
+  }
+  for (shutdown_handler_t handler : toCall) {
+    handler();
+  }
+}
+
+uint32_t esp_get_free_heap_size() {
+  return 0;
+}
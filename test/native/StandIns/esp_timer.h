@@ -0,0 +1,11 @@
+#ifndef ESP_TIMER_H_
+#define ESP_TIMER_H_
+
+#include <stdint.h>
+
+/**
+ * @brief Microseconds since the start of the process, monotonic.
+ */
+int64_t esp_timer_get_time();
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef FREERTOS_H_
+#define FREERTOS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Host stand-in of the ESP-IDF FreeRTOS port: tasks are threads, queues and semaphores are built on std::mutex and
+// std::condition_variable, critical sections are spinlocks. The tick is 1ms, like on the iGate.
+
+typedef int          BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t     TickType_t;
+typedef uint8_t      StackType_t;
+
+#define pdFALSE ((BaseType_t)0)
+#define pdTRUE  ((BaseType_t)1)
+#define pdFAIL  pdFALSE
+#define pdPASS  pdTRUE
+
+#define configTICK_RATE_HZ       1000
+#define configMINIMAL_STACK_SIZE 768
+#define INCLUDE_vTaskDelete      1
+
+#define portMAX_DELAY      ((TickType_t)0xffffffffUL)
+#define portTICK_PERIOD_MS ((TickType_t)1000 / configTICK_RATE_HZ)
+#define pdMS_TO_TICKS(ms)  ((TickType_t)(((TickType_t)(ms) * (TickType_t)configTICK_RATE_HZ) / (TickType_t)1000U))
+#define tskNO_AFFINITY     ((BaseType_t)0x7FFFFFFF)
+
+typedef struct {
+  volatile uintptr_t owner; // 0 when free
+  uint32_t           count; // Recursion depth of the owner
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED \
+  { 0, 0 }
+
+void vPortCPUInitializeMutex(portMUX_TYPE *mux);
+void vPortEnterCritical(portMUX_TYPE *mux);
+void vPortExitCritical(portMUX_TYPE *mux);
+
+#define portMUX_INITIALIZE(mux)        vPortCPUInitializeMutex(mux)
+#define portENTER_CRITICAL(mux)        vPortEnterCritical(mux)
+#define portEXIT_CRITICAL(mux)         vPortExitCritical(mux)
+#define portENTER_CRITICAL_ISR(mux)    vPortEnterCritical(mux)
+#define portEXIT_CRITICAL_ISR(mux)     vPortExitCritical(mux)
+#define portENTER_CRITICAL_SAFE(mux)   vPortEnterCritical(mux)
+#define portEXIT_CRITICAL_SAFE(mux)    vPortExitCritical(mux)
+#define taskENTER_CRITICAL(mux)        vPortEnterCritical(mux)
+#define taskEXIT_CRITICAL(mux)         vPortExitCritical(mux)
+#define taskENTER_CRITICAL_ISR(mux)    vPortEnterCritical(mux)
+#define taskEXIT_CRITICAL_ISR(mux)     vPortExitCritical(mux)
+#define portYIELD_FROM_ISR(...)        ((void)0)
+#define portYIELD()                    taskYIELD()
+
+#include "task.h"
+
+#endif
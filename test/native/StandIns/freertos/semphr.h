@@ -0,0 +1,20 @@
+#ifndef FREERTOS_SEMPHR_H_
+#define FREERTOS_SEMPHR_H_
+
+#include "queue.h"
+
+typedef QueueHandle_t SemaphoreHandle_t;
+
+// A semaphore is a queue of items of size 0, a mutex is such a queue created with its token available
+SemaphoreHandle_t xSemaphoreCreateBinary();
+SemaphoreHandle_t xSemaphoreCreateMutex();
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t uxMaxCount, UBaseType_t uxInitialCount);
+
+#define vSemaphoreDelete(xSemaphore)                                vQueueDelete((QueueHandle_t)(xSemaphore))
+#define xSemaphoreTake(xSemaphore, xBlockTime)                      xQueueReceive((QueueHandle_t)(xSemaphore), NULL, (xBlockTime))
+#define xSemaphoreGive(xSemaphore)                                  xQueueSend((QueueHandle_t)(xSemaphore), NULL, 0)
+#define xSemaphoreGiveFromISR(xSemaphore, pxHigherPriorityTaskWoken) xQueueSendFromISR((QueueHandle_t)(xSemaphore), NULL, (pxHigherPriorityTaskWoken))
+#define xSemaphoreTakeFromISR(xSemaphore, pxHigherPriorityTaskWoken) xQueueReceive((QueueHandle_t)(xSemaphore), NULL, 0)
+#define uxSemaphoreGetCount(xSemaphore)                             uxQueueMessagesWaiting((QueueHandle_t)(xSemaphore))
+
+#endif
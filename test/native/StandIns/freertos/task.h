@@ -0,0 +1,43 @@
+#ifndef FREERTOS_TASK_H_
+#define FREERTOS_TASK_H_
+
+#include "FreeRTOS.h"
+
+struct NativeTask;
+
+typedef struct NativeTask *TaskHandle_t;
+typedef TaskHandle_t       xTaskHandle;
+typedef void (*TaskFunction_t)(void *);
+
+/**
+ * @brief Starts the task on its own thread. The thread stack is usStackDepth (in bytes, as with ESP-IDF) plus a margin for the
+ *        larger frames of the host, it is painted so that uxTaskGetStackHighWaterMark() can measure what the task used.
+ */
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t pvTaskCode, const char *pcName, uint32_t usStackDepth, void *pvParameters, UBaseType_t uxPriority, TaskHandle_t *pvCreatedTask, BaseType_t xCoreID);
+BaseType_t xTaskCreateUniversal(TaskFunction_t pvTaskCode, const char *pcName, uint32_t usStackDepth, void *pvParameters, UBaseType_t uxPriority, TaskHandle_t *pvCreatedTask, BaseType_t xCoreID);
+BaseType_t xTaskCreate(TaskFunction_t pvTaskCode, const char *pcName, uint32_t usStackDepth, void *pvParameters, UBaseType_t uxPriority, TaskHandle_t *pvCreatedTask);
+
+/**
+ * @brief Only a task can delete itself (with its own handle or NULL), the threads of the other tasks cannot be stopped.
+ */
+void vTaskDelete(TaskHandle_t xTaskToDelete);
+
+void         vTaskDelay(const TickType_t xTicksToDelay);
+void         taskYIELD();
+TickType_t   xTaskGetTickCount();
+TaskHandle_t xTaskGetCurrentTaskHandle();
+char        *pcTaskGetName(TaskHandle_t xTaskToQuery);
+BaseType_t   xPortGetCoreID();
+
+/**
+ * @brief Bytes of the task stack (as sized for the iGate) that were never used, 0 if the task used more than that on the host.
+ */
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t xTask);
+
+/**
+ * @brief Host only: bytes of stack the task used so far. The frames of the host are larger than the Xtensa ones (64 bits
+ *        pointers, glibc printf), so this is an upper bound of the usage on the target.
+ */
+size_t nativeTaskGetStackUsed(TaskHandle_t xTask);
+
+#endif
@@ -0,0 +1,18 @@
+#ifndef LWIP_SOCKETS_H_
+#define LWIP_SOCKETS_H_
+
+// lwIP has the BSD socket API of the host
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/ioctl.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// IPAddress.h declares a constant of the same name, like the ESP32 core
+#undef INADDR_NONE
+
+#endif
@@ -0,0 +1,247 @@
+#include <Arduino.h>
+#include <algorithm>
+#include <PacketBus.h>
+#include <PacketPool.h>
+#include <SPIFFS.h>
+#include <WiFi.h>
+#include <lwip/sockets.h>
+#include <mutex>
+#include <thread>
+#include <unistd.h>
+#include <unity.h>
+#include <vector>
+
+#include "System.h"
+#include "TaskAprsIs.h"
+#include "project_configuration.h"
+
+#define PACKET_POOL_SIZE 32
+#define PACKET_BUS_SIZE  16
+
+#define CALLSIGN      "F4XYZ-10"
+#define LOGIN_TIMEOUT 2000 // ms
+#define LINE_TIMEOUT  2000 // ms
+#define CLOSED_PORT   1    // Nothing listens there, the connection is refused at once
+#define SPOOL_TIMEOUT 8000 // ms, reconnection and replay of the spool
+#define BATCH_LINES   6
+
+/**
+ * @brief APRS-IS server on the loopback interface: answers the login, then records the lines it receives.
+ */
+class FakeServer {
+public:
+  FakeServer() : _connections(0), _logins(0) {
+    _socket                    = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    struct sockaddr_in address = {};
+    socklen_t          length  = sizeof(address);
+    address.sin_family         = AF_INET;
+    address.sin_addr.s_addr    = htonl(INADDR_LOOPBACK);
+    bind(_socket, (struct sockaddr *)&address, sizeof(address));
+    listen(_socket, 8);
+    getsockname(_socket, (struct sockaddr *)&address, &length);
+    _port = ntohs(address.sin_port);
+    std::thread(&FakeServer::run, this).detach();
+  }
+
+  uint16_t getPort() const {
+    return _port;
+  }
+
+  int getConnections() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _connections;
+  }
+
+  int getLogins() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _logins;
+  }
+
+  std::vector<std::string> getLines() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _lines;
+  }
+
+private:
+  void run() {
+    for (;;) {
+      int client = accept(_socket, NULL, NULL);
+      if (client < 0) {
+        return;
+      }
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _connections++;
+      }
+      std::thread(&FakeServer::serve, this, client).detach();
+    }
+  }
+
+  void serve(int client) {
+    const char banner[] = "# aprsc 2.1.14 test\r\n";
+    send(client, banner, strlen(banner), MSG_NOSIGNAL);
+    std::string received;
+    char        buffer[512];
+    ssize_t     length;
+    while ((length = recv(client, buffer, sizeof(buffer), 0)) > 0) {
+      received.append(buffer, length);
+      size_t end;
+      while ((end = received.find('\n')) != std::string::npos) {
+        std::string line = received.substr(0, end);
+        received.erase(0, end + 1);
+        while (!line.empty() && (line.back() == '\r' || line[0] == '\r')) {
+          line.erase((line.back() == '\r') ? line.size() - 1 : 0, 1);
+        }
+        if (line.compare(0, 5, "user ") == 0) {
+          const char logresp[] = "# logresp " CALLSIGN " verified, server T2TEST\r\n";
+          send(client, logresp, strlen(logresp), MSG_NOSIGNAL);
+          std::lock_guard<std::mutex> lock(_mutex);
+          _logins++;
+        } else if (!line.empty()) {
+          std::lock_guard<std::mutex> lock(_mutex);
+          _lines.push_back(line);
+        }
+      }
+    }
+    close(client);
+  }
+
+  int                      _socket;
+  uint16_t                 _port;
+  std::mutex               _mutex;
+  int                      _connections;
+  int                      _logins;
+  std::vector<std::string> _lines;
+};
+
+static Configuration config;
+static System        lora;
+static PacketBus    *bus;
+static AprsIsTask   *aprsIsTask;
+static FakeServer   *serverA;
+static FakeServer   *serverB;
+
+static void publish(const char *tnc2) {
+  Packet *packet = lora.getPacketPool()->acquire();
+  TEST_ASSERT_NOT_NULL(packet);
+  packet->origin = Packet::RF;
+  packet->msg.decode(tnc2);
+  bus->publish(packet, PacketBus::ToAprsIs);
+  packet->release();
+}
+
+/**
+ * @brief Waits until condition() holds, at most timeoutMs.
+ */
+template <typename Condition> static bool waitFor(Condition condition, uint32_t timeoutMs) {
+  uint32_t start = millis();
+  while (!condition()) {
+    if (millis() - start >= timeoutMs) {
+      return false;
+    }
+    delay(10);
+  }
+  return true;
+}
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+void test_probe_keeps_fastest_connection(void) {
+  // The primary refuses the connection, both backups accept: one of them is used and logged in right away
+  TEST_ASSERT_TRUE(waitFor([] { return aprsIsTask->getConnectLatency().getCount() > 0; }, LOGIN_TIMEOUT));
+  TEST_ASSERT_EQUAL(1, aprsIsTask->getConnectLatency().getCount());
+  TEST_ASSERT_EQUAL(0, aprsIsTask->getConnectFailures());
+
+  // The probe connection to the winner was kept, the one to the other server closed without logging in
+  FakeServer *winner = (serverA->getLogins() > 0) ? serverA : serverB;
+  FakeServer *loser  = (winner == serverA) ? serverB : serverA;
+  delay(200);
+  TEST_ASSERT_EQUAL(1, winner->getConnections());
+  TEST_ASSERT_EQUAL(1, winner->getLogins());
+  TEST_ASSERT_TRUE(loser->getConnections() <= 1);
+  TEST_ASSERT_EQUAL(0, loser->getLogins());
+}
+
+void test_uplink(void) {
+  FakeServer *winner = (serverA->getLogins() > 0) ? serverA : serverB;
+  size_t      before = winner->getLines().size();
+  publish("F4ABC-9>APLT00,WIDE1-1:!4850.00N/00220.00E>LoRa tracker");
+  TEST_ASSERT_TRUE(waitFor([&] { return winner->getLines().size() > before; }, LINE_TIMEOUT));
+  std::string line = winner->getLines().back();
+  TEST_ASSERT_EQUAL_STRING("F4ABC-9>APLT00,WIDE1-1,qAO," CALLSIGN ":!4850.00N/00220.00E>LoRa tracker", line.c_str());
+}
+
+void test_partial_write_spools_the_rest(void) {
+  std::vector<std::string> expected;
+  for (int i = 0; i < BATCH_LINES; i++) {
+    expected.push_back(std::string("F4ABC-9>APLT00,WIDE1-1,qAO," CALLSIGN ":>Status ") + std::to_string(i));
+  }
+  size_t beforeA = serverA->getLines().size();
+  size_t beforeB = serverB->getLines().size();
+
+  // The connection is reset in the middle of the third line, whatever the lines were batched
+  nativeWiFiFailWritesAfter(2 * (expected[0].size() + 2) + 10);
+  for (int i = 0; i < BATCH_LINES; i++) {
+    publish((std::string("F4ABC-9>APLT00,WIDE1-1:>Status ") + std::to_string(i)).c_str());
+  }
+
+  // The lines sent before the reset are not spooled, the others are replayed once connected again (maybe to the other server)
+  std::vector<std::string> received;
+  TEST_ASSERT_TRUE(waitFor(
+      [&] {
+        std::vector<std::string> linesA = serverA->getLines();
+        std::vector<std::string> linesB = serverB->getLines();
+        received.assign(linesA.begin() + beforeA, linesA.end());
+        received.insert(received.end(), linesB.begin() + beforeB, linesB.end());
+        return received.size() >= BATCH_LINES;
+      },
+      SPOOL_TIMEOUT));
+  delay(500);
+  std::vector<std::string> linesA = serverA->getLines();
+  std::vector<std::string> linesB = serverB->getLines();
+  TEST_ASSERT_EQUAL(BATCH_LINES, linesA.size() - beforeA + linesB.size() - beforeB);
+  for (const std::string &line : expected) {
+    TEST_ASSERT_EQUAL(1, std::count(linesA.begin() + beforeA, linesA.end(), line) + std::count(linesB.begin() + beforeB, linesB.end(), line));
+  }
+  TEST_ASSERT_EQUAL(1, aprsIsTask->getUplinkFailures());
+  TEST_ASSERT_TRUE(aprsIsTask->getSpoolReplayed() > 0);
+}
+
+int main(int argc, char **argv) {
+  SPIFFS.begin();
+  serverA = new FakeServer();
+  serverB = new FakeServer();
+
+  config.callsign                   = CALLSIGN;
+  config.aprs_is.active             = true;
+  config.aprs_is.passcode           = "12345";
+  config.aprs_is.server             = "127.0.0.1";
+  config.aprs_is.port               = CLOSED_PORT;
+  config.aprs_is.spool_rate         = 10;
+  Configuration::APRS_IS::Server backup;
+  backup.server = "127.0.0.1";
+  backup.port   = serverA->getPort();
+  config.aprs_is.backups.push_back(backup);
+  backup.port = serverB->getPort();
+  config.aprs_is.backups.push_back(backup);
+  lora.setBoardConfig(&TTGO_LORA32_V2);
+  lora.setUserConfig(&config);
+  lora.setPacketPool(new PacketPool(PACKET_POOL_SIZE));
+  lora.connectedViaWifi(true);
+  bus        = new PacketBus(PACKET_BUS_SIZE);
+  aprsIsTask = new AprsIsTask(3, 0, false, lora, *bus, NULL);
+
+  UNITY_BEGIN();
+  RUN_TEST(test_probe_keeps_fastest_connection);
+  RUN_TEST(test_uplink);
+  RUN_TEST(test_partial_write_spools_the_rest);
+  int failures = UNITY_END();
+
+  // The task never returns: leave without running the static destructors under its feet
+  fflush(stdout);
+  _exit(failures);
+}
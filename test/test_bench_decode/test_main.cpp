@@ -0,0 +1,152 @@
+#include <APRS-Decoder.h>
+#include <Allocations.h>
+#include <Arduino.h>
+#include <Corpus.h>
+#include <SimRadio.h>
+#include <atomic>
+#include <esp_timer.h>
+#include <string>
+#include <unity.h>
+#include <vector>
+
+#include "TaskRadiolib.h"
+
+#define BENCH_ROUNDS 500 // Times the corpus is decoded by each path
+
+// Frames as some trackers send them: line ends and tabs in the text
+static const char *const controlFrames[] = {
+    "F4ABC-9>APLT00,WIDE1-1:!4850.12N/00220.45E>LoRa tracker\r\n",
+    "F4JKL-2>APLRG1,WIDE2-1:>Digi\tup 12 days\r",
+    "F1YZA-7>APLRT1,WIDE1-1:>Status\x1b[0m\n",
+};
+
+static std::vector<std::string> fifos; // Content of the modem FIFO for each frame, LoRa APRS header included
+
+/**
+ * @brief The RX path before the decode was reworked: RadioLib readData(String &), two substrings and a replace() per control char.
+ */
+static bool decodeWithStrings(const std::string &fifo, APRSMessage &msg) {
+  // What SX1278::readData(String &) does with the FIFO
+  String   str;
+  uint8_t *data = new uint8_t[fifo.size() + 1];
+  memcpy(data, fifo.data(), fifo.size());
+  data[fifo.size()] = 0;
+  str               = String((char *)data);
+  delete[] data;
+
+  if (str.substring(0, 3) != "<\xff\x01") {
+    return false;
+  }
+  String msgData = str.substring(3);
+
+  // Replace all non-printable chars by spaces
+  for (char c = 0; c < ' '; c++) {
+    msgData.replace(String(c), " ");
+  }
+  msg.decode(msgData);
+  return true;
+}
+
+static uint8_t rxBuffer[RADIOLIB_SX127X_MAX_PACKET_LENGTH + 1];
+
+/**
+ * @brief The RX path of RadiolibTask: the FIFO is read into a static buffer and sanitised in place.
+ */
+static bool decodeInPlace(const std::string &fifo, String &rxData, APRSMessage &msg) {
+  // What SX1278::readData(uint8_t *, size_t) does with the FIFO
+  memcpy(rxBuffer, fifo.data(), fifo.size());
+  rxBuffer[fifo.size()] = '\0';
+
+  const char *text = RadiolibTask::extractText(rxBuffer, fifo.size());
+  if (text == NULL) {
+    return false;
+  }
+  rxData = text;
+  msg.decode(rxData);
+  return true;
+}
+
+struct Result {
+  double nsPerFrame;
+  double allocationsPerFrame;
+};
+
+template <typename Decode> static Result bench(const char *name, Decode decode) {
+  APRSMessage msg;
+  // One round to warm up the caches and the buffers kept between frames
+  for (const std::string &fifo : fifos) {
+    decode(fifo, msg);
+  }
+
+  uint32_t startAllocations = allocations;
+  int64_t  start            = esp_timer_get_time();
+  for (int round = 0; round < BENCH_ROUNDS; round++) {
+    for (const std::string &fifo : fifos) {
+      decode(fifo, msg);
+    }
+  }
+  size_t frames = BENCH_ROUNDS * fifos.size();
+  Result result;
+  result.nsPerFrame          = (esp_timer_get_time() - start) * 1000.0 / frames;
+  result.allocationsPerFrame = (double)(allocations - startAllocations) / frames;
+
+  char message[128];
+  snprintf(message, sizeof(message), "%s: %.0fns and %.1f allocations per frame", name, result.nsPerFrame, result.allocationsPerFrame);
+  TEST_MESSAGE(message);
+  return result;
+}
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+void test_same_messages(void) {
+  APRSMessage before;
+  APRSMessage after;
+  String      rxData;
+  for (const std::string &fifo : fifos) {
+    TEST_ASSERT_TRUE(decodeWithStrings(fifo, before));
+    TEST_ASSERT_TRUE(decodeInPlace(fifo, rxData, after));
+    TEST_ASSERT_EQUAL_STRING(before.encode().c_str(), after.encode().c_str());
+  }
+  TEST_ASSERT_FALSE(decodeInPlace("<\xff", rxData, after));
+  TEST_ASSERT_FALSE(decodeInPlace("F4ABC>APRS:>Not LoRa APRS", rxData, after));
+}
+
+void test_decode_paths(void) {
+  String rxData;
+  rxData.reserve(RADIOLIB_SX127X_MAX_PACKET_LENGTH);
+  Result before = bench("readData(String) + substring + replace", decodeWithStrings);
+  Result after  = bench("static buffer + table", [&](const std::string &fifo, APRSMessage &msg) { return decodeInPlace(fifo, rxData, msg); });
+
+  // What is left is APRSMessage::decode()
+  std::vector<String> texts;
+  for (const std::string &fifo : fifos) {
+    texts.push_back(String(fifo.substr(3).c_str()));
+  }
+  size_t next   = 0;
+  Result decode = bench("APRSMessage::decode() alone", [&](const std::string &fifo, APRSMessage &msg) {
+    msg.decode(texts[next++ % texts.size()]);
+    return true;
+  });
+
+  TEST_ASSERT_TRUE(after.allocationsPerFrame < before.allocationsPerFrame);
+  TEST_ASSERT_EQUAL_FLOAT(decode.allocationsPerFrame, after.allocationsPerFrame);
+}
+
+int main(int argc, char **argv) {
+  std::string text(corpus);
+  for (size_t start = 0, end; (end = text.find('\n', start)) != std::string::npos; start = end + 1) {
+    fifos.push_back(sim::toPayload(text.substr(start, end - start)));
+  }
+  for (const char *frame : controlFrames) {
+    fifos.push_back(sim::toPayload(frame));
+  }
+
+  UNITY_BEGIN();
+  RUN_TEST(test_same_messages);
+  RUN_TEST(test_decode_paths);
+  return UNITY_END();
+}
@@ -0,0 +1,180 @@
+#include <APRS-Decoder.h>
+#include <Allocations.h>
+#include <Arduino.h>
+#include <Client.h>
+#include <Corpus.h>
+#include <LineFramer.h>
+#include <esp_timer.h>
+#include <memory>
+#include <string>
+#include <unity.h>
+#include <vector>
+
+#define BENCH_ROUNDS     250  // Times the corpus is received
+#define HEARTBEAT_LINES  20   // Data lines between two server comments
+#define SEGMENT_SIZE     536  // Bytes made available at a time, the default TCP MSS: lines straddle the reads
+#define SERVER_HEARTBEAT "# aprsc 2.1.14-g5e22b37 18 Oct 2026 10:30:00 GMT T2TEST 192.0.2.10:14580"
+
+static std::string              traffic; // APRS-IS downlink, "\r\n" terminated lines
+static std::vector<std::string> lines;   // The same lines, without their terminator
+
+/**
+ * @brief Serves the captured traffic like a socket, SEGMENT_SIZE bytes available at a time.
+ */
+class TrafficClient : public Client {
+public:
+  explicit TrafficClient(const std::string &data) : _data(data), _position(0) {
+  }
+
+  int connect(IPAddress ip, uint16_t port) override {
+    return 0;
+  }
+  int connect(const char *host, uint16_t port) override {
+    return 0;
+  }
+  size_t write(uint8_t c) override {
+    return 0;
+  }
+  size_t write(const uint8_t *buf, size_t size) override {
+    return 0;
+  }
+  int available() override {
+    size_t left = _data.size() - _position;
+    return std::min<size_t>(left, SEGMENT_SIZE - _position % SEGMENT_SIZE);
+  }
+  int read() override {
+    return (_position < _data.size()) ? (uint8_t)_data[_position++] : -1;
+  }
+  int read(uint8_t *buf, size_t size) override {
+    size_t n = std::min<size_t>(size, available());
+    memcpy(buf, _data.data() + _position, n);
+    _position += n;
+    return n;
+  }
+  int peek() override {
+    return (_position < _data.size()) ? (uint8_t)_data[_position] : -1;
+  }
+  void flush() override {
+  }
+  void stop() override {
+  }
+  uint8_t connected() override {
+    return _position < _data.size();
+  }
+  operator bool() override {
+    return true;
+  }
+
+private:
+  const std::string &_data;
+  size_t             _position;
+};
+
+struct Result {
+  double nsPerLine;
+  double allocationsPerLine;
+};
+
+static Result report(const char *name, int64_t time, uint32_t lineAllocations) {
+  Result result;
+  result.nsPerLine          = time * 1000.0 / lines.size();
+  result.allocationsPerLine = (double)lineAllocations / lines.size();
+
+  char message[160];
+  snprintf(message, sizeof(message), "%s: %.0fns and %.2f allocations per line, %.0f lines/s, %.1fMB/s", name, result.nsPerLine, result.allocationsPerLine, lines.size() * 1e6 / time, traffic.size() / (double)time);
+  TEST_MESSAGE(message);
+  return result;
+}
+
+/**
+ * @brief The downlink before the line framer: APRS_IS::getAPRSMessage(), which read a String until '\n' and decoded it.
+ */
+static Result readWithStrings(std::vector<std::string> *received) {
+  TrafficClient client(traffic);
+  uint32_t      startAllocations = allocations;
+  int64_t       start            = esp_timer_get_time();
+  while (client.available() > 0) {
+    String line = client.readStringUntil('\n');
+    if (received != NULL) {
+      received->push_back(line.c_str());
+    }
+    if (line.startsWith("#") || line.length() == 0) {
+      continue;
+    }
+    std::shared_ptr<APRSMessage> msg = std::shared_ptr<APRSMessage>(new APRSMessage());
+    msg->decode(line);
+  }
+  return report("readStringUntil() + getAPRSMessage()", esp_timer_get_time() - start, allocations - startAllocations);
+}
+
+static LineFramer framer;
+
+static Result readWithFramer(std::vector<std::string> *received) {
+  TrafficClient client(traffic);
+  framer.reset();
+  uint32_t startAllocations = allocations;
+  int64_t  start            = esp_timer_get_time();
+  while (client.available() > 0) {
+    const char *line;
+    size_t      length;
+    while (framer.next(&line, &length) || (framer.fill(client) > 0 && framer.next(&line, &length))) {
+      if (received != NULL) {
+        received->push_back(std::string(line, length));
+      }
+    }
+  }
+  return report("LineFramer", esp_timer_get_time() - start, allocations - startAllocations);
+}
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+void test_same_lines(void) {
+  std::vector<std::string> before;
+  std::vector<std::string> after;
+  readWithStrings(&before);
+  readWithFramer(&after);
+  TEST_ASSERT_EQUAL(lines.size(), before.size());
+  TEST_ASSERT_EQUAL(lines.size(), after.size());
+  for (size_t i = 0; i < lines.size(); i++) {
+    // readStringUntil() kept the '\r'
+    std::string withReturn = lines[i] + "\r";
+    TEST_ASSERT_EQUAL_STRING(withReturn.c_str(), before[i].c_str());
+    TEST_ASSERT_EQUAL_STRING(lines[i].c_str(), after[i].c_str());
+  }
+  TEST_ASSERT_EQUAL(0, framer.getOverflowCount());
+}
+
+void test_read_paths(void) {
+  Result before = readWithStrings(NULL);
+  Result after  = readWithFramer(NULL);
+  // The timings are only reported, a loaded runner would make a comparison fail
+  TEST_ASSERT_EQUAL_FLOAT(0, after.allocationsPerLine);
+  TEST_ASSERT_TRUE(after.allocationsPerLine < before.allocationsPerLine);
+}
+
+int main(int argc, char **argv) {
+  // The corpus as an APRS-IS server sends it: gated by an iGate, with the periodic server comment
+  std::string text(corpus);
+  for (int round = 0; round < BENCH_ROUNDS; round++) {
+    for (size_t start = 0, end; (end = text.find('\n', start)) != std::string::npos; start = end + 1) {
+      if (lines.size() % (HEARTBEAT_LINES + 1) == 0) {
+        lines.push_back(SERVER_HEARTBEAT);
+      }
+      std::string frame = text.substr(start, end - start);
+      size_t      colon = frame.find(':');
+      lines.push_back(frame.substr(0, colon) + ",qAR,F4XYZ-10" + frame.substr(colon));
+    }
+  }
+  for (const std::string &line : lines) {
+    traffic += line + "\r\n";
+  }
+
+  UNITY_BEGIN();
+  RUN_TEST(test_same_lines);
+  RUN_TEST(test_read_paths);
+  return UNITY_END();
+}
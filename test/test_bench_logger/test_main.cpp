@@ -0,0 +1,180 @@
+#include <Arduino.h>
+#include <Corpus.h>
+#include <PacketBus.h>
+#include <PacketPool.h>
+#include <SPIFFS.h>
+#include <esp_timer.h>
+#include <string>
+#include <unistd.h>
+#include <unity.h>
+#include <vector>
+
+#include "System.h"
+#include "TaskPacketLogger.h"
+#include "project_configuration.h"
+
+#define BENCH_ROUNDS   50 // Times the corpus is logged
+#define BENCH_LINES    (BENCH_ROUNDS * CORPUS_FRAMES)
+#define BENCH_TIMEOUT  10000 // ms
+#define BENCH_RX_TIME  1684922400
+#define LOG_FLUSH_SIZE 2048 // Same as TaskPacketLogger.cpp
+
+// Every packet fits in the pool and the bus: the publisher never waits and none is dropped, the logger sets the pace
+#define PACKET_POOL_SIZE (BENCH_LINES + 1)
+#define PACKET_BUS_SIZE  (BENCH_LINES + 1)
+
+static Configuration            config;
+static System                   lora;
+static PacketBus               *bus;
+static PacketLoggerTask        *loggerTask;
+static std::vector<std::string> frames;
+
+struct Result {
+  int64_t     time; // us
+  fs::FSStats fs;
+};
+
+static fs::FSStats diff(const fs::FSStats &after, const fs::FSStats &before) {
+  fs::FSStats stats;
+  stats.opens        = after.opens - before.opens;
+  stats.closes       = after.closes - before.closes;
+  stats.writes       = after.writes - before.writes;
+  stats.bytesWritten = after.bytesWritten - before.bytesWritten;
+  stats.flushes      = after.flushes - before.flushes;
+  stats.reads        = after.reads - before.reads;
+  stats.bytesRead    = after.bytesRead - before.bytesRead;
+  return stats;
+}
+
+static void report(const char *name, const Result &result) {
+  char message[256];
+  snprintf(message, sizeof(message), "%s: %u lines in %lldus (%.0f lines/s), per 100 lines %.1f opens, %.1f closes, %.1f writes, %.1f flushes, %u bytes", name, BENCH_LINES, (long long)result.time, BENCH_LINES * 1e6 / result.time, result.fs.opens * 100.0 / BENCH_LINES, result.fs.closes * 100.0 / BENCH_LINES, result.fs.writes * 100.0 / BENCH_LINES, result.fs.flushes * 100.0 / BENCH_LINES, result.fs.bytesWritten);
+  TEST_MESSAGE(message);
+}
+
+/**
+ * @brief The logging loop before the file was kept open: open, print and close for every line.
+ */
+static Result logPerLine() {
+  const char fmt[] = "%zu" SEPARATOR "%s" SEPARATOR "%s" SEPARATOR "%s" SEPARATOR "%s" SEPARATOR "%s" SEPARATOR "%.1f" SEPARATOR "%.1f" SEPARATOR "%.1f\n";
+  APRSMessage msg;
+  fs::FSStats before = SPIFFS.getStats();
+  int64_t     start  = esp_timer_get_time();
+  for (size_t counter = 0; counter < BENCH_LINES; counter++) {
+    msg.decode(frames[counter % frames.size()].c_str());
+    time_t    rxTime = BENCH_RX_TIME + counter;
+    struct tm timeInfo;
+    gmtime_r(&rxTime, &timeInfo);
+
+    File csv_file = SPIFFS.open("/before.log", "a");
+    char timestamp[21];
+    strftime(timestamp, sizeof(timestamp), "%FT%TZ", &timeInfo);
+    int   lineLength = snprintf(nullptr, 0, fmt, counter, timestamp, msg.getSource().c_str(), msg.getDestination().c_str(), msg.getPath().c_str(), msg.getRawBody().c_str(), -95.0f, 8.25f, 120.0f);
+    char *line       = new char[lineLength + 1];
+    snprintf(line, lineLength + 1, fmt, counter, timestamp, msg.getSource().c_str(), msg.getDestination().c_str(), msg.getPath().c_str(), msg.getRawBody().c_str(), -95.0f, 8.25f, 120.0f);
+    csv_file.print(line);
+    delete[] line;
+    csv_file.close();
+  }
+  Result result;
+  result.time = esp_timer_get_time() - start;
+  result.fs   = diff(SPIFFS.getStats(), before);
+  return result;
+}
+
+static void publish(size_t index) {
+  Packet *packet = lora.getPacketPool()->acquire();
+  TEST_ASSERT_NOT_NULL(packet);
+  packet->origin       = Packet::RF;
+  packet->rx.rxTime    = BENCH_RX_TIME + index;
+  packet->rx.rssi      = -95.0f;
+  packet->rx.snr       = 8.25f;
+  packet->rx.freqError = 120.0f;
+  packet->msg.decode(frames[index % frames.size()].c_str());
+  bus->publish(packet, PacketBus::RfReceived);
+  packet->release();
+}
+
+static bool waitLogged(uint32_t lines) {
+  uint32_t start = millis();
+  while (loggerTask->getLoggedLines() < lines) {
+    if (millis() - start >= BENCH_TIMEOUT) {
+      return false;
+    }
+    delay(1);
+  }
+  return true;
+}
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+void test_corpus(void) {
+  TEST_ASSERT_EQUAL(CORPUS_FRAMES, frames.size());
+}
+
+/**
+ * @brief The file system of the host is in RAM: the times are the CPU cost of each loop (the buffered one includes handing the
+ *        packets over to the task), the flash cost is in the calls reaching the file system.
+ */
+void test_buffered_log(void) {
+  // The first line creates the file, the measures start once the logger runs
+  publish(0);
+  TEST_ASSERT_TRUE(waitLogged(1));
+  loggerTask->flush();
+
+  Result before = logPerLine();
+  report("open/print/close per line", before);
+  TEST_ASSERT_EQUAL(BENCH_LINES, before.fs.opens);
+  TEST_ASSERT_EQUAL(BENCH_LINES, before.fs.closes);
+
+  fs::FSStats start = SPIFFS.getStats();
+  int64_t     time  = esp_timer_get_time();
+  for (size_t i = 1; i <= BENCH_LINES; i++) {
+    publish(i);
+  }
+  TEST_ASSERT_TRUE(waitLogged(BENCH_LINES + 1));
+  loggerTask->flush();
+  Result after;
+  after.time = esp_timer_get_time() - time;
+  after.fs   = diff(SPIFFS.getStats(), start);
+  report("file kept open, buffered", after);
+  char message[128];
+  snprintf(message, sizeof(message), "buffered, time spent by the task per line: %uus mean, %uus max", loggerTask->getLineTime().getMean(), loggerTask->getLineTime().getMax());
+  TEST_MESSAGE(message);
+
+  // The same lines reach the file, in writes of LOG_FLUSH_SIZE bytes
+  TEST_ASSERT_EQUAL(0, after.fs.opens);
+  TEST_ASSERT_EQUAL(0, after.fs.closes);
+  TEST_ASSERT_TRUE(after.fs.writes <= after.fs.bytesWritten / LOG_FLUSH_SIZE + 1);
+  TEST_ASSERT_INT_WITHIN(BENCH_LINES, before.fs.bytesWritten, after.fs.bytesWritten);
+}
+
+int main(int argc, char **argv) {
+  std::string text(corpus);
+  for (size_t start = 0, end; (end = text.find('\n', start)) != std::string::npos; start = end + 1) {
+    frames.push_back(text.substr(start, end - start));
+  }
+
+  config.callsign                 = "F4XYZ-10";
+  config.packetLogger.active      = true;
+  config.packetLogger.nb_lines    = 2 * BENCH_LINES; // No rotation during the measure
+  config.packetLogger.tail_length = 10;
+  lora.setBoardConfig(&TTGO_LORA32_V2);
+  lora.setUserConfig(&config);
+  lora.setPacketPool(new PacketPool(PACKET_POOL_SIZE));
+  bus        = new PacketBus(PACKET_BUS_SIZE);
+  loggerTask = new PacketLoggerTask(3, 0, false, lora, "packets.log", *bus);
+
+  UNITY_BEGIN();
+  RUN_TEST(test_corpus);
+  RUN_TEST(test_buffered_log);
+  int failures = UNITY_END();
+
+  // The task never returns: leave without running the static destructors under its feet
+  fflush(stdout);
+  _exit(failures);
+}
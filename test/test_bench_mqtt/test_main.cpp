@@ -0,0 +1,123 @@
+#include <APRS-Decoder.h>
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <Corpus.h>
+#include <esp_timer.h>
+#include <string>
+#include <unity.h>
+
+#include "TaskMQTT.h"
+
+#define BENCH_ROUNDS  200 // Times the corpus is encoded by each encoding
+#define BENCH_RX_TIME 1684922400
+#define DOC_SIZE      768 // Same as MQTT_DOC_SIZE in TaskMQTT.cpp
+#define PAYLOAD_SIZE  512 // Same as MQTTTask::PAYLOAD_SIZE
+
+static Packet              packets[CORPUS_FRAMES];
+static DynamicJsonDocument doc(DOC_SIZE);
+static char                payload[PAYLOAD_SIZE];
+
+struct Result {
+  double nsPerPacket;
+  size_t bytes;
+};
+
+template <typename Encode> static Result bench(const char *name, Encode encode) {
+  Result result;
+  result.bytes = 0;
+  for (Packet &packet : packets) {
+    MQTTTask::buildDocument(&packet, doc);
+    result.bytes += encode();
+  }
+
+  // The documents are built outside of the measure, MQTTTask builds the same one for both encodings
+  int64_t time = 0;
+  for (int round = 0; round < BENCH_ROUNDS; round++) {
+    for (Packet &packet : packets) {
+      MQTTTask::buildDocument(&packet, doc);
+      int64_t start = esp_timer_get_time();
+      encode();
+      time += esp_timer_get_time() - start;
+    }
+  }
+  result.nsPerPacket = time * 1000.0 / (BENCH_ROUNDS * CORPUS_FRAMES);
+
+  char message[160];
+  snprintf(message, sizeof(message), "%s: %.1f bytes and %.0fns per packet", name, (double)result.bytes / CORPUS_FRAMES, result.nsPerPacket);
+  TEST_MESSAGE(message);
+  return result;
+}
+
+static size_t encodeJson() {
+  size_t length = measureJson(doc);
+  serializeJson(doc, payload, sizeof(payload));
+  return length;
+}
+
+static size_t encodeMsgPack() {
+  size_t length = measureMsgPack(doc);
+  serializeMsgPack(doc, payload, sizeof(payload));
+  return length;
+}
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+void test_corpus(void) {
+  TEST_ASSERT_EQUAL_STRING("F5WXY", packets[CORPUS_FRAMES - 1].msg.getSource().c_str());
+}
+
+void test_same_content(void) {
+  DynamicJsonDocument decoded(DOC_SIZE);
+  char                json[PAYLOAD_SIZE];
+  for (Packet &packet : packets) {
+    MQTTTask::buildDocument(&packet, doc);
+    TEST_ASSERT_FALSE(doc.overflowed());
+    size_t jsonLength    = encodeJson();
+    size_t msgPackLength = measureMsgPack(doc);
+    TEST_ASSERT_TRUE(jsonLength < sizeof(payload));
+    TEST_ASSERT_TRUE(msgPackLength < jsonLength);
+
+    // The MessagePack payload holds the same fields and values (a const input is copied, not referenced by the document)
+    memcpy(json, payload, jsonLength + 1);
+    encodeMsgPack();
+    TEST_ASSERT_TRUE(deserializeMsgPack(decoded, (const char *)payload, msgPackLength) == DeserializationError::Ok);
+    serializeJson(decoded, payload, sizeof(payload));
+    TEST_ASSERT_EQUAL_STRING(json, payload);
+  }
+}
+
+void test_encodings(void) {
+  Result json    = bench("JSON", encodeJson);
+  Result msgPack = bench("MessagePack", encodeMsgPack);
+
+  char message[64];
+  snprintf(message, sizeof(message), "MessagePack payloads are %.1f%% smaller", 100.0 - msgPack.bytes * 100.0 / json.bytes);
+  TEST_MESSAGE(message);
+  TEST_ASSERT_TRUE(msgPack.bytes < json.bytes);
+}
+
+int main(int argc, char **argv) {
+  // Reception metrics spread over the range of the SX1278: whole dBm RSSI, SNR in quarters of dB, any frequency error
+  std::string text(corpus);
+  size_t      i = 0;
+  for (size_t start = 0, end; (end = text.find('\n', start)) != std::string::npos && i < CORPUS_FRAMES; start = end + 1, i++) {
+    Packet &packet = packets[i];
+    packet.msg.decode(text.substr(start, end - start).c_str());
+    packet.origin             = Packet::RF;
+    packet.rx.rxTime          = BENCH_RX_TIME + i * 17;
+    packet.rx.rssi            = -70.0f - (i * 7) % 55;
+    packet.rx.snr             = ((i * 13) % 60) / 4.0f - 10.0f;
+    packet.rx.freqError       = ((i * 7919) % 4000) * 0.37f - 740.0f;
+    packet.rx.spreadingFactor = 12;
+  }
+
+  UNITY_BEGIN();
+  RUN_TEST(test_corpus);
+  RUN_TEST(test_same_content);
+  RUN_TEST(test_encodings);
+  return UNITY_END();
+}
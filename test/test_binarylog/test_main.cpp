@@ -0,0 +1,239 @@
+#include <BinaryLog.h>
+#include <SPIFFS.h>
+#include <unity.h>
+#include <vector>
+
+#define LOG_PATH       "/packets.bin"
+#define INDEX_INTERVAL 4
+#define BUFFER_SIZE    256
+#define FIRST_SEQ      100
+#define FIRST_TIME     1700000000
+
+/**
+ * @brief Record number i of the tests: received every 2 seconds, one in 7 with a CRC error.
+ */
+static BinaryLog::Record makeRecord(uint32_t i) {
+  BinaryLog::Record record = {};
+  record.rxTime            = FIRST_TIME + 2 * i;
+  record.rssi              = -100 - (float)(i % 20);
+  record.snr               = 10 - (float)(i % 15) / 2;
+  record.freqError         = (float)i;
+  record.crcOk             = i % 7 != 3;
+  if (record.crcOk) {
+    record.frameLength = snprintf(record.frame, sizeof(record.frame), "F4ABC-%u>APLT00,WIDE1-1:!4852.00N/00220.00E>packet %u", i % 16, i);
+  }
+  return record;
+}
+
+static void assertRecord(uint32_t i, const BinaryLog::Record &record) {
+  BinaryLog::Record expected = makeRecord(i);
+  TEST_ASSERT_EQUAL(FIRST_SEQ + i, record.seq);
+  TEST_ASSERT_EQUAL(expected.rxTime, record.rxTime);
+  TEST_ASSERT_EQUAL_FLOAT(expected.rssi, record.rssi);
+  TEST_ASSERT_EQUAL_FLOAT(expected.snr, record.snr);
+  TEST_ASSERT_EQUAL_FLOAT(expected.freqError, record.freqError);
+  TEST_ASSERT_EQUAL(expected.crcOk, record.crcOk);
+  TEST_ASSERT_EQUAL(expected.frameLength, record.frameLength);
+  TEST_ASSERT_EQUAL_STRING(expected.frame, record.frame);
+}
+
+static void writeLog(uint32_t count) {
+  BinaryLog log(SPIFFS, INDEX_INTERVAL, BUFFER_SIZE);
+  TEST_ASSERT_TRUE(log.create(LOG_PATH, FIRST_SEQ));
+  for (uint32_t i = 0; i < count; i++) {
+    BinaryLog::Record record = makeRecord(i);
+    TEST_ASSERT_TRUE(log.append(record));
+    TEST_ASSERT_EQUAL(FIRST_SEQ + i, record.seq);
+  }
+  TEST_ASSERT_TRUE(log.flush());
+}
+
+static std::vector<uint8_t> readFile(const char *path) {
+  File                 file = SPIFFS.open(path, "r");
+  std::vector<uint8_t> data(file.size());
+  file.read(data.data(), data.size());
+  return data;
+}
+
+static void writeFile(const char *path, const std::vector<uint8_t> &data) {
+  File file = SPIFFS.open(path, "w");
+  file.write(data.data(), data.size());
+}
+
+void setUp(void) {
+  SPIFFS.format();
+}
+
+void tearDown(void) {
+}
+
+void test_round_trip(void) {
+  writeLog(50);
+
+  BinaryLog::Reader reader(SPIFFS);
+  TEST_ASSERT_TRUE(reader.open(LOG_PATH));
+  TEST_ASSERT_EQUAL(FIRST_SEQ, reader.getFirstSeq());
+  BinaryLog::Record record;
+  for (uint32_t i = 0; i < 50; i++) {
+    TEST_ASSERT_TRUE(reader.next(record));
+    assertRecord(i, record);
+  }
+  TEST_ASSERT_FALSE(reader.next(record));
+
+  // One index entry every INDEX_INTERVAL records
+  TEST_ASSERT_EQUAL((50 + INDEX_INTERVAL - 1) / INDEX_INTERVAL * 12, SPIFFS.open(BinaryLog::getIndexPath(LOG_PATH), "r").size());
+}
+
+void test_reopen(void) {
+  writeLog(10);
+
+  BinaryLog log(SPIFFS, INDEX_INTERVAL, BUFFER_SIZE);
+  TEST_ASSERT_TRUE(log.open(LOG_PATH));
+  TEST_ASSERT_EQUAL(FIRST_SEQ, log.getFirstSeq());
+  TEST_ASSERT_EQUAL(FIRST_SEQ + 10, log.getNextSeq());
+  TEST_ASSERT_EQUAL(10, log.getCount());
+  for (uint32_t i = 10; i < 20; i++) {
+    BinaryLog::Record record = makeRecord(i);
+    TEST_ASSERT_TRUE(log.append(record));
+  }
+  log.close();
+
+  BinaryLog::Reader reader(SPIFFS);
+  BinaryLog::Record record;
+  TEST_ASSERT_TRUE(reader.open(LOG_PATH));
+  TEST_ASSERT_TRUE(reader.seek(FIRST_SEQ + 13));
+  TEST_ASSERT_TRUE(reader.next(record));
+  assertRecord(13, record);
+}
+
+void test_seek(void) {
+  writeLog(50);
+
+  BinaryLog::Reader reader(SPIFFS);
+  BinaryLog::Record record;
+  TEST_ASSERT_TRUE(reader.open(LOG_PATH));
+  for (uint32_t i = 0; i < 50; i++) {
+    TEST_ASSERT_TRUE(reader.seek(FIRST_SEQ + i));
+    TEST_ASSERT_TRUE(reader.next(record));
+    assertRecord(i, record);
+  }
+  // Before the first record and after the last one
+  TEST_ASSERT_TRUE(reader.seek(0));
+  TEST_ASSERT_TRUE(reader.next(record));
+  assertRecord(0, record);
+  TEST_ASSERT_FALSE(reader.seek(FIRST_SEQ + 50));
+}
+
+void test_seek_without_index(void) {
+  writeLog(20);
+  SPIFFS.remove(BinaryLog::getIndexPath(LOG_PATH).c_str());
+
+  BinaryLog::Reader reader(SPIFFS);
+  BinaryLog::Record record;
+  TEST_ASSERT_TRUE(reader.open(LOG_PATH));
+  TEST_ASSERT_TRUE(reader.seek(FIRST_SEQ + 17));
+  TEST_ASSERT_TRUE(reader.next(record));
+  assertRecord(17, record);
+}
+
+void test_seek_time(void) {
+  writeLog(50);
+
+  BinaryLog::Reader reader(SPIFFS);
+  BinaryLog::Record record;
+  TEST_ASSERT_TRUE(reader.open(LOG_PATH));
+  for (uint32_t i = 0; i < 50; i++) {
+    // Exactly at the time of a record, then between two records
+    TEST_ASSERT_TRUE(reader.seekTime(FIRST_TIME + 2 * i));
+    TEST_ASSERT_TRUE(reader.next(record));
+    assertRecord(i, record);
+    if (i < 49) {
+      TEST_ASSERT_TRUE(reader.seekTime(FIRST_TIME + 2 * i + 1));
+      TEST_ASSERT_TRUE(reader.next(record));
+      assertRecord(i + 1, record);
+    }
+  }
+  TEST_ASSERT_TRUE(reader.seekTime(0));
+  TEST_ASSERT_TRUE(reader.next(record));
+  assertRecord(0, record);
+  TEST_ASSERT_FALSE(reader.seekTime(FIRST_TIME + 2 * 50));
+}
+
+void test_index_rebuilt(void) {
+  writeLog(30);
+  std::vector<uint8_t> index = readFile(BinaryLog::getIndexPath(LOG_PATH).c_str());
+  // Entries missing, as when the power is lost between the records and the index
+  writeFile(BinaryLog::getIndexPath(LOG_PATH).c_str(), std::vector<uint8_t>(index.begin(), index.begin() + 2 * 12));
+
+  BinaryLog log(SPIFFS, INDEX_INTERVAL, BUFFER_SIZE);
+  TEST_ASSERT_TRUE(log.open(LOG_PATH));
+  TEST_ASSERT_EQUAL(FIRST_SEQ + 30, log.getNextSeq());
+  log.close();
+  TEST_ASSERT_TRUE(index == readFile(BinaryLog::getIndexPath(LOG_PATH).c_str()));
+}
+
+void test_truncated_record(void) {
+  writeLog(10);
+  std::vector<uint8_t> data = readFile(LOG_PATH);
+  data.resize(data.size() - 5);
+  writeFile(LOG_PATH, data);
+
+  BinaryLog log(SPIFFS, INDEX_INTERVAL, BUFFER_SIZE);
+  TEST_ASSERT_FALSE(log.open(LOG_PATH));
+  TEST_ASSERT_EQUAL(FIRST_SEQ + 9, log.getNextSeq());
+}
+
+void test_damaged_header(void) {
+  writeLog(10);
+  std::vector<uint8_t> data = readFile(LOG_PATH);
+  data[0]                   = 0;
+  writeFile(LOG_PATH, data);
+
+  // The records are still readable
+  BinaryLog log(SPIFFS, INDEX_INTERVAL, BUFFER_SIZE);
+  TEST_ASSERT_FALSE(log.open(LOG_PATH));
+  TEST_ASSERT_EQUAL(FIRST_SEQ + 10, log.getNextSeq());
+
+  // Nothing readable at all
+  data.resize(8);
+  writeFile(LOG_PATH, data);
+  uint32_t nextSeq = 0;
+  TEST_ASSERT_FALSE(BinaryLog::findNextSeq(SPIFFS, LOG_PATH, &nextSeq));
+  TEST_ASSERT_FALSE(BinaryLog::findNextSeq(SPIFFS, "/missing.bin", &nextSeq));
+}
+
+void test_other_index_interval(void) {
+  writeLog(10);
+
+  BinaryLog log(SPIFFS, INDEX_INTERVAL * 2, BUFFER_SIZE);
+  TEST_ASSERT_FALSE(log.open(LOG_PATH));
+  TEST_ASSERT_EQUAL(FIRST_SEQ + 10, log.getNextSeq());
+}
+
+void test_to_tsv(void) {
+  char              line[BinaryLog::MAX_FRAME + 128];
+  BinaryLog::Record record = makeRecord(0);
+  record.seq               = 7;
+  TEST_ASSERT_TRUE(BinaryLog::toTsv(record, line, sizeof(line)) > 0);
+  TEST_ASSERT_EQUAL_STRING("7\t2023-11-14T22:13:20Z\tF4ABC-0\tAPLT00\tWIDE1-1\t!4852.00N/00220.00E>packet 0\t-100.0\t10.0\t0.0\n", line);
+
+  record = makeRecord(3);
+  TEST_ASSERT_TRUE(BinaryLog::toTsv(record, line, sizeof(line)) > 0);
+  TEST_ASSERT_EQUAL_STRING("0\t2023-11-14T22:13:26Z\t \t \t \tINVALID PACKET\t-103.0\t8.5\t3.0\n", line);
+  TEST_ASSERT_EQUAL(0, BinaryLog::toTsv(record, line, 10));
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_round_trip);
+  RUN_TEST(test_reopen);
+  RUN_TEST(test_seek);
+  RUN_TEST(test_seek_without_index);
+  RUN_TEST(test_seek_time);
+  RUN_TEST(test_index_rebuilt);
+  RUN_TEST(test_truncated_record);
+  RUN_TEST(test_damaged_header);
+  RUN_TEST(test_other_index_interval);
+  RUN_TEST(test_to_tsv);
+  return UNITY_END();
+}
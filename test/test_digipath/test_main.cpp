@@ -0,0 +1,162 @@
+#include <DigiPath.h>
+#include <unity.h>
+
+#define PATH_SIZE (DigiPath::MAX_HOPS * (DigiPath::HOP_SIZE + 1))
+
+static DigiPath::Rules rules;
+static char            newPath[PATH_SIZE];
+
+/**
+ * @brief Parses and processes a path, newPath receives the path afterwards.
+ */
+static DigiPath::Result digi(const char *path) {
+  DigiPath digiPath;
+  TEST_ASSERT_TRUE(digiPath.parse(path));
+  DigiPath::Result result = digiPath.process(rules);
+  TEST_ASSERT_TRUE(digiPath.format(newPath, sizeof(newPath)) > 0 || newPath[0] == '\0');
+  return result;
+}
+
+static void assertDigipeat(const char *path, const char *expected) {
+  TEST_ASSERT_EQUAL_STRING(DigiPath::toString(DigiPath::Digipeat), DigiPath::toString(digi(path)));
+  TEST_ASSERT_EQUAL_STRING(expected, newPath);
+}
+
+static void assertRefused(const char *path, DigiPath::Result expected) {
+  TEST_ASSERT_EQUAL_STRING(DigiPath::toString(expected), DigiPath::toString(digi(path)));
+  // The path is left untouched
+  TEST_ASSERT_EQUAL_STRING(path, newPath);
+}
+
+void setUp(void) {
+  // The rules of the examples of DigiPath.h
+  rules.callsign  = "DIGI";
+  rules.maxHops   = 2;
+  rules.traceWide = true;
+  rules.fillIn    = false;
+}
+
+void tearDown(void) {
+}
+
+void test_wide_traced(void) {
+  assertDigipeat("WIDE1-1", "DIGI,WIDE1*");
+  assertDigipeat("WIDE2-2", "DIGI*,WIDE2-1");
+  assertDigipeat("WIDE1-1,WIDE2-1", "DIGI,WIDE1*,WIDE2-1");
+  assertDigipeat("OTHER*,WIDE2-1", "OTHER,DIGI,WIDE2*");
+}
+
+void test_wide_not_traced(void) {
+  rules.traceWide = false;
+  assertDigipeat("WIDE2-2", "WIDE2-1");
+  assertDigipeat("WIDE1-1", "WIDE1*");
+  assertDigipeat("OTHER*,WIDE2-1", "OTHER,WIDE2*");
+}
+
+void test_trace(void) {
+  // TRACE always inserts the callsign
+  rules.traceWide = false;
+  assertDigipeat("TRACE2-2", "DIGI*,TRACE2-1");
+  assertDigipeat("TRACE1-1", "DIGI,TRACE1*");
+}
+
+void test_own_callsign(void) {
+  assertDigipeat("DIGI", "DIGI*");
+  assertDigipeat("OTHER*,DIGI,WIDE2-1", "OTHER,DIGI*,WIDE2-1");
+  assertRefused("OTHER,DIGI", DigiPath::NotForUs);
+}
+
+void test_fill_in(void) {
+  rules.fillIn = true;
+  assertDigipeat("WIDE1-1", "DIGI,WIDE1*");
+  assertDigipeat("WIDE1-1,WIDE2-1", "DIGI,WIDE1*,WIDE2-1");
+  assertRefused("WIDE2-2", DigiPath::NotForUs);
+  assertRefused("WIDE2-1", DigiPath::NotForUs);
+  assertRefused("TRACE1-1", DigiPath::NotForUs);
+}
+
+void test_refused(void) {
+  assertRefused("DIGI*,WIDE2-1", DigiPath::Loop);
+  assertRefused("DIGI,WIDE1*,WIDE2-1", DigiPath::Loop);
+  assertRefused("WIDE3-3", DigiPath::TooManyHops);
+  assertRefused("WIDE2-3", DigiPath::Invalid);
+  assertRefused("WIDE1*", DigiPath::NotForUs);
+  assertRefused("RFONLY", DigiPath::NotForUs);
+  assertRefused("TCPIP,WIDE1-1", DigiPath::NotForUs);
+  assertRefused("WIDE8-1", DigiPath::NotForUs);
+  assertRefused("WIDE2-0", DigiPath::NotForUs);
+  assertRefused("WIDE22-2", DigiPath::NotForUs);
+  assertRefused("WIDE", DigiPath::NotForUs);
+}
+
+void test_path_full(void) {
+  assertRefused("A,B,C,D,E,F,G*,WIDE1-1", DigiPath::PathFull);
+  // Nothing to insert without tracing
+  rules.traceWide = false;
+  assertDigipeat("A,B,C,D,E,F,G*,WIDE1-1", "A,B,C,D,E,F,G,WIDE1*");
+}
+
+void test_longest_hops(void) {
+  // The longest alias and callsign a hop can hold
+  rules.callsign = "CALL10-15";
+  rules.maxHops  = 7;
+  assertDigipeat("TRACE7-7", "CALL10-15*,TRACE7-6");
+  assertDigipeat("WIDE7-1", "CALL10-15,WIDE7*");
+
+  rules.callsign = "CALLS10-15";
+  assertRefused("WIDE2-2", DigiPath::Invalid);
+}
+
+void test_parse(void) {
+  DigiPath path;
+  TEST_ASSERT_TRUE(path.parse(""));
+  TEST_ASSERT_EQUAL(0, path.format(newPath, sizeof(newPath)));
+  TEST_ASSERT_EQUAL_STRING("", newPath);
+
+  TEST_ASSERT_TRUE(path.parse("A,B,C,D,E,F,G,H"));
+  TEST_ASSERT_FALSE(path.parse("A,B,C,D,E,F,G,H,I"));
+  TEST_ASSERT_TRUE(path.parse("CALL10-15*"));
+  TEST_ASSERT_FALSE(path.parse("CALLS10-15"));
+  TEST_ASSERT_FALSE(path.parse("WIDE1-1,,WIDE2-1"));
+  TEST_ASSERT_FALSE(path.parse("*"));
+}
+
+void test_format(void) {
+  DigiPath path;
+  TEST_ASSERT_TRUE(path.parse("OTHER*,WIDE2-1"));
+  TEST_ASSERT_EQUAL(14, path.format(newPath, sizeof(newPath)));
+  TEST_ASSERT_EQUAL_STRING("OTHER*,WIDE2-1", newPath);
+  // No partial path
+  TEST_ASSERT_EQUAL(0, path.format(newPath, 14));
+  TEST_ASSERT_EQUAL(14, path.format(newPath, 15));
+}
+
+void test_last_digipeater(void) {
+  DigiPath path;
+  TEST_ASSERT_TRUE(path.parse("WIDE1-1"));
+  TEST_ASSERT_NULL(path.getLastDigipeater());
+  TEST_ASSERT_TRUE(path.parse("F1AB*,WIDE2-1"));
+  TEST_ASSERT_EQUAL_STRING("F1AB", path.getLastDigipeater());
+  TEST_ASSERT_TRUE(path.parse("F1AB,WIDE1*,WIDE2-1"));
+  TEST_ASSERT_EQUAL_STRING("F1AB", path.getLastDigipeater());
+  TEST_ASSERT_TRUE(path.parse("WIDE1*,WIDE2-1"));
+  TEST_ASSERT_NULL(path.getLastDigipeater());
+  TEST_ASSERT_TRUE(path.parse("RELAY*,WIDE2-1"));
+  TEST_ASSERT_NULL(path.getLastDigipeater());
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_wide_traced);
+  RUN_TEST(test_wide_not_traced);
+  RUN_TEST(test_trace);
+  RUN_TEST(test_own_callsign);
+  RUN_TEST(test_fill_in);
+  RUN_TEST(test_refused);
+  RUN_TEST(test_path_full);
+  RUN_TEST(test_longest_hops);
+  RUN_TEST(test_parse);
+  RUN_TEST(test_format);
+  RUN_TEST(test_last_digipeater);
+  return UNITY_END();
+}
@@ -0,0 +1,53 @@
+#include <DupeCache.h>
+#include <unity.h>
+
+#define WINDOW_MS 30000
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+void test_hash(void) {
+  uint32_t hash = DupeCache::hash("F4ABC-9", "APLT00", "!4852.00N/00220.00E>");
+  // The trailing spaces of the body do not matter, the separators between the fields do
+  TEST_ASSERT_EQUAL(hash, DupeCache::hash("F4ABC-9", "APLT00", "!4852.00N/00220.00E>  "));
+  TEST_ASSERT_NOT_EQUAL(DupeCache::hash("AB", "C", "x"), DupeCache::hash("A", "BC", "x"));
+  TEST_ASSERT_NOT_EQUAL(hash, DupeCache::hash("F4ABC-9", "APLT00", "!4852.00N/00220.00E-"));
+}
+
+void test_window(void) {
+  DupeCache cache(4, WINDOW_MS);
+  TEST_ASSERT_FALSE(cache.check(1, 1000));
+  TEST_ASSERT_TRUE(cache.check(1, 1000 + WINDOW_MS - 1));
+  TEST_ASSERT_FALSE(cache.check(1, 1000 + WINDOW_MS));
+  TEST_ASSERT_EQUAL(1, cache.getHits());
+  TEST_ASSERT_EQUAL(2, cache.getMisses());
+}
+
+void test_early_evictions(void) {
+  DupeCache cache(4, WINDOW_MS);
+  for (uint32_t i = 0; i < 4; i++) {
+    TEST_ASSERT_FALSE(cache.check(i, i * 1000));
+  }
+  TEST_ASSERT_EQUAL(0, cache.getEarlyEvictions());
+
+  // The ring is full of packets still in their window: the oldest is replaced and its duplicate is missed
+  TEST_ASSERT_FALSE(cache.check(4, 4000));
+  TEST_ASSERT_EQUAL(1, cache.getEarlyEvictions());
+  TEST_ASSERT_FALSE(cache.check(0, 5000));
+  TEST_ASSERT_EQUAL(2, cache.getEarlyEvictions());
+
+  // Replacing entries older than the window is not counted
+  TEST_ASSERT_FALSE(cache.check(5, 100000));
+  TEST_ASSERT_EQUAL(2, cache.getEarlyEvictions());
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_hash);
+  RUN_TEST(test_window);
+  RUN_TEST(test_early_evictions);
+  return UNITY_END();
+}
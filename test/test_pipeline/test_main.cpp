@@ -0,0 +1,320 @@
+#include <Arduino.h>
+#include <PacketBus.h>
+#include <PacketPool.h>
+#include <SimRadio.h>
+#include <StationTable.h>
+#include <TxScheduler.h>
+#include <esp_timer.h>
+#include <unistd.h>
+#include <unity.h>
+#include <vector>
+
+#include "System.h"
+#include "TaskRadiolib.h"
+#include "TaskRouter.h"
+#include "project_configuration.h"
+
+// Same sizes as the firmware, except the bus which also feeds the probe of the tests
+#define PACKET_POOL_SIZE   32
+#define PACKET_BUS_SIZE    32
+#define STATION_TABLE_SIZE 64
+#define TX_QUEUE_SIZE      8
+
+#define CALLSIGN        "F4XYZ-10"
+#define SETTLE_MS       200  // Time without any new packet after which the pipeline is considered idle
+#define REPLAY_TIMEOUT  5000 // ms
+#define REPLAY_SPEED    100  // Relative to the trace timestamps
+#define TIMED_FRAMES    5
+#define REPLAY_INTERVAL 10 // s between the frames of the timed trace
+#define BURST_FRAMES    500
+
+// Capture of packets.log: one frame for each path through the router
+static const char trace[] = R"(NUMBER	TIMESTAMP	CALLSIGN	TARGET	PATH	DATA	RSSI	SNR	FREQ_ERROR
+0	2023-05-01T10:00:00Z	F4ABC-9	APLT00	WIDE1-1	!4850.00N/00220.00E>LoRa tracker	-95.0	8.2	120.0
+1	2023-05-01T10:00:04Z	F4DEF	APRS	WIDE2-2	>Fill-in digi does not repeat WIDE2-2	-102.5	2.0	-80.0
+2	2023-05-01T10:00:09Z	 	 	 	INVALID PACKET	-118.5	-12.8	300.0
+3	2023-05-01T10:00:11Z	F4ABC-9	APLT00	F1DIG,WIDE1*	!4850.00N/00220.00E>LoRa tracker	-110.0	-3.5	40.0
+4	2023-05-01T10:00:15Z	F4GHI	APRS	RFONLY	>Not for APRS-IS	-99.0	6.0	10.0
+5	2023-05-01T10:00:20Z	F4XYZ-10	APLG01	F1DIG*,WIDE1*	!4851.00NL00221.00E&Our own beacon	-104.0	1.0	0.0
+6	2023-05-01T10:00:26Z	F4JKL-7	APDR15	F4XYZ-10	=4852.00N/00222.00E-Addressed to us	-90.0	9.5	-150.0
+7	2023-05-01T10:00:31Z	F4MNO	APRS	TCPIP,WIDE1-1	>Came from the internet	-97.0	7.0	25.0
+)";
+
+#define TRACE_FRAMES  8
+#define TRACE_CORRUPT 1
+#define TRACE_DUPES   1
+#define TRACE_GATED   3 // Frames 0, 1 and 6
+
+static Configuration          config;
+static System                 lora;
+static PacketBus             *bus;
+static PacketBus::Subscriber *probe;
+static TxScheduler           *scheduler;
+static RadiolibTask          *modemTask;
+static RouterTask            *routerTask;
+
+struct Received {
+  uint32_t   topics;
+  String     source;
+  String     tnc2;
+  RxMetadata rx;
+};
+
+/**
+ * @brief Collects what the pipeline published until it stays idle for settleMs.
+ */
+static std::vector<Received> collect(uint32_t settleMs = SETTLE_MS) {
+  std::vector<Received> received;
+  for (;;) {
+    uint32_t topics;
+    Packet  *packet = bus->receive(probe, pdMS_TO_TICKS(settleMs), &topics);
+    if (packet == NULL) {
+      return received;
+    }
+    Received entry;
+    entry.topics = topics;
+    entry.source = packet->msg.getSource();
+    entry.tnc2   = (topics & PacketBus::RfCorrupt) ? "" : packet->msg.encode();
+    entry.rx     = packet->rx;
+    received.push_back(entry);
+    packet->release();
+  }
+}
+
+static size_t countTopic(const std::vector<Received> &received, uint32_t topic) {
+  size_t count = 0;
+  for (const Received &entry : received) {
+    if (entry.topics & topic) {
+      count++;
+    }
+  }
+  return count;
+}
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+void test_trace_is_parsed(void) {
+  std::vector<sim::Frame> frames = sim::parsePacketLog(trace);
+  TEST_ASSERT_EQUAL(TRACE_FRAMES, frames.size());
+  TEST_ASSERT_TRUE(frames[0].crcOk);
+  TEST_ASSERT_FALSE(frames[2].crcOk);
+  TEST_ASSERT_EQUAL(1682935200, frames[0].rxTime);
+  TEST_ASSERT_EQUAL_STRING("<\xff\x01"
+                           "F4ABC-9>APLT00,WIDE1-1:!4850.00N/00220.00E>LoRa tracker",
+                           frames[0].payload.c_str());
+}
+
+void test_replay_routes_every_frame(void) {
+  // Real time between the frames, the digipeated ones are sent before the next frame comes
+  std::vector<sim::Frame> frames = sim::parsePacketLog(trace);
+  sim::Channel::get().play(frames, REPLAY_SPEED);
+  TEST_ASSERT_TRUE(sim::Channel::get().waitIdle(REPLAY_TIMEOUT));
+  std::vector<Received> received = collect();
+
+  TEST_ASSERT_EQUAL(TRACE_FRAMES - TRACE_CORRUPT, countTopic(received, PacketBus::RfReceived));
+  TEST_ASSERT_EQUAL(TRACE_CORRUPT, countTopic(received, PacketBus::RfCorrupt));
+  TEST_ASSERT_EQUAL(TRACE_GATED, countTopic(received, PacketBus::ToAprsIs));
+  TEST_ASSERT_EQUAL(TRACE_DUPES, routerTask->getDupeCache().getHits());
+  TEST_ASSERT_EQUAL(TRACE_FRAMES - TRACE_CORRUPT, routerTask->getLatency().getCount());
+  TEST_ASSERT_EQUAL(TRACE_FRAMES - TRACE_CORRUPT, modemTask->getRxCount());
+  TEST_ASSERT_EQUAL(TRACE_CORRUPT, modemTask->getRxCorruptCount());
+
+  // The modem and the router publish the same packet, check the metrics of the first publication of each frame
+  size_t frame = 0;
+  for (const Received &entry : received) {
+    if (entry.topics & PacketBus::ToAprsIs) {
+      continue;
+    }
+    TEST_ASSERT_TRUE(frame < frames.size());
+    TEST_ASSERT_EQUAL(frames[frame].crcOk, entry.rx.crcOk);
+    TEST_ASSERT_EQUAL(frames[frame].rxTime, entry.rx.rxTime);
+    TEST_ASSERT_EQUAL_FLOAT(frames[frame].rssi, entry.rx.rssi);
+    TEST_ASSERT_EQUAL_FLOAT(frames[frame].snr, entry.rx.snr);
+    TEST_ASSERT_EQUAL_FLOAT(frames[frame].freqError, entry.rx.freqError);
+    if (frames[frame].crcOk) {
+      TEST_ASSERT_EQUAL_STRING(frames[frame].payload.c_str() + 3, entry.tnc2.c_str());
+    }
+    frame++;
+  }
+  TEST_ASSERT_EQUAL(frames.size(), frame);
+
+  // Gated: the WIDE1-1 one, the WIDE2-2 one heard directly and the one addressed to us
+  std::vector<String> gated;
+  for (const Received &entry : received) {
+    if (entry.topics & PacketBus::ToAprsIs) {
+      gated.push_back(entry.source);
+    }
+  }
+  TEST_ASSERT_EQUAL(TRACE_GATED, gated.size());
+  TEST_ASSERT_EQUAL_STRING("F4ABC-9", gated[0].c_str());
+  TEST_ASSERT_EQUAL_STRING("F4DEF", gated[1].c_str());
+  TEST_ASSERT_EQUAL_STRING("F4JKL-7", gated[2].c_str());
+
+  // Digipeated: WIDE1-1 with our callsign traced, and the frame addressed to us
+  std::vector<std::string> transmitted = sim::Channel::get().takeTransmitted();
+  TEST_ASSERT_EQUAL(2, transmitted.size());
+  TEST_ASSERT_EQUAL(2, modemTask->getTxCount());
+  TEST_ASSERT_EQUAL_STRING("<\xff\x01"
+                           "F4ABC-9>APLT00,F4XYZ-10,WIDE1*:!4850.00N/00220.00E>LoRa tracker",
+                           transmitted[0].c_str());
+  TEST_ASSERT_EQUAL_STRING("<\xff\x01"
+                           "F4JKL-7>APDR15,F4XYZ-10*:=4852.00N/00222.00E-Addressed to us",
+                           transmitted[1].c_str());
+
+  // Every station heard on RF but us
+  TEST_ASSERT_EQUAL(5, lora.getStationTable()->getCount());
+
+  char info[160];
+  snprintf(info, sizeof(info), "Router latency %uus mean, %uus max. Decode %uus mean.", routerTask->getLatency().getMean(), routerTask->getLatency().getMax(), modemTask->getDecodeTime().getMean());
+  TEST_MESSAGE(info);
+}
+
+void test_replay_follows_trace_time(void) {
+  // New stations, so that the dupe cache does not drop them
+  String raw;
+  for (int i = 0; i < TIMED_FRAMES; i++) {
+    raw += String(1683000000 + i * REPLAY_INTERVAL) + "\tF5AA-" + String(i + 1) + ">APRS,WIDE2-1:>Timed frame " + String(i) + "\n";
+  }
+  std::vector<sim::Frame> frames = sim::parseRawTrace(raw.c_str(), -100, 5);
+  TEST_ASSERT_EQUAL(TIMED_FRAMES, frames.size());
+
+  uint32_t start = millis();
+  sim::Channel::get().play(frames, REPLAY_SPEED);
+  TEST_ASSERT_TRUE(sim::Channel::get().waitIdle(REPLAY_TIMEOUT));
+  uint32_t elapsed = millis() - start;
+  // The last frame is due TIMED_FRAMES - 1 intervals after the first one
+  TEST_ASSERT_GREATER_OR_EQUAL((TIMED_FRAMES - 1) * REPLAY_INTERVAL * 1000 / REPLAY_SPEED, elapsed);
+
+  std::vector<Received> received = collect();
+  size_t                frame    = 0;
+  for (const Received &entry : received) {
+    if (entry.topics & PacketBus::RfReceived) {
+      // The clock runs REPLAY_SPEED times faster than real time, allow for the wake-up of the modem task
+      TEST_ASSERT_INT_WITHIN(1, frames[frame].rxTime, entry.rx.rxTime);
+      frame++;
+    }
+  }
+  TEST_ASSERT_EQUAL(frames.size(), frame);
+  TEST_ASSERT_EQUAL(frames.size(), countTopic(received, PacketBus::ToAprsIs));
+
+  // WIDE2-1 is not handled in fill-in mode
+  size_t transmitted = sim::Channel::get().takeTransmitted().size();
+  TEST_ASSERT_EQUAL(0, transmitted);
+}
+
+void test_replayed_packet_stays_local(void) {
+  // A frame of /replay.log, then the same frame heard on RF within the dupe window
+  const char frame[]  = "F7RPL-9>APLT00,WIDE1-1:!4850.00N/00220.00E>Replayed and heard";
+  size_t     stations = lora.getStationTable()->getCount();
+  uint32_t   dupes    = routerTask->getDupeCache().getHits();
+
+  Packet *packet = lora.getPacketPool()->acquire();
+  TEST_ASSERT_NOT_NULL(packet);
+  packet->origin     = Packet::Replay;
+  packet->rx.irqTime = esp_timer_get_time();
+  packet->msg.decode(frame);
+  bus->publish(packet, PacketBus::RfReceived);
+  packet->release();
+
+  std::vector<Received> received = collect();
+  TEST_ASSERT_EQUAL(1, countTopic(received, PacketBus::RfReceived));
+  TEST_ASSERT_EQUAL(0, countTopic(received, PacketBus::ToAprsIs));
+  TEST_ASSERT_EQUAL(stations, lora.getStationTable()->getCount());
+  TEST_ASSERT_EQUAL(0, sim::Channel::get().takeTransmitted().size());
+
+  std::vector<sim::Frame> frames = sim::parseRawTrace((String("1685000000\t") + frame + "\n").c_str(), -100, 5);
+  sim::Channel::get().play(frames, 0);
+  TEST_ASSERT_TRUE(sim::Channel::get().waitIdle(REPLAY_TIMEOUT));
+  received = collect();
+  TEST_ASSERT_EQUAL(1, countTopic(received, PacketBus::ToAprsIs));
+  TEST_ASSERT_EQUAL(dupes, routerTask->getDupeCache().getHits());
+  TEST_ASSERT_EQUAL(stations + 1, lora.getStationTable()->getCount());
+  TEST_ASSERT_EQUAL(1, sim::Channel::get().takeTransmitted().size());
+}
+
+void test_replay_burst(void) {
+  // Back-to-back frames from new stations, as fast as the modem reads them. Nothing is transmitted: a frame received while the
+  // modem starts a transmission would be lost, as on the air.
+  config.digi.active = false;
+  String raw;
+  for (int i = 0; i < BURST_FRAMES; i++) {
+    raw += String(1684000000 + i) + "\tF6B" + String(i) + ">APRS,WIDE1-1:!4850.00N/00220.00E>Burst " + String(i) + "\n";
+  }
+  std::vector<sim::Frame> frames = sim::parseRawTrace(raw.c_str(), -100, 5);
+
+  size_t   delivered = sim::Channel::get().getDelivered();
+  uint32_t decoded   = modemTask->getDecodeTime().getCount();
+  uint32_t routed    = routerTask->getLatency().getCount();
+  uint32_t exhausted = lora.getPacketPool()->getExhaustedCount();
+  int64_t  start     = esp_timer_get_time();
+  sim::Channel::get().play(frames, 0);
+  // The probe must keep up, or the packets it did not read would exhaust the pool
+  size_t received = 0;
+  while (!sim::Channel::get().waitIdle(1)) {
+    received += countTopic(collect(0), PacketBus::RfReceived);
+  }
+  int64_t elapsed = esp_timer_get_time() - start;
+  received += countTopic(collect(SETTLE_MS), PacketBus::RfReceived);
+  config.digi.active = true;
+
+  uint32_t poolExhausted = lora.getPacketPool()->getExhaustedCount() - exhausted;
+  TEST_ASSERT_EQUAL(BURST_FRAMES, sim::Channel::get().getDelivered() - delivered);
+  TEST_ASSERT_EQUAL(BURST_FRAMES, modemTask->getDecodeTime().getCount() - decoded + poolExhausted);
+  TEST_ASSERT_EQUAL(BURST_FRAMES - poolExhausted, received);
+
+  char info[160];
+  snprintf(info, sizeof(info), "%u frames in %ums: %u frames/s. Routed %u, pool exhausted %u times.", BURST_FRAMES, (unsigned)(elapsed / 1000), (unsigned)(BURST_FRAMES * 1000000LL / elapsed), routerTask->getLatency().getCount() - routed, poolExhausted);
+  TEST_MESSAGE(info);
+}
+
+void test_stack_usage(void) {
+  // The host frames are larger than the Xtensa ones, this is an upper bound. The target values are published by MQTT.
+  char info[120];
+  snprintf(info, sizeof(info), "Stack used on the host: modem %u bytes, router %u bytes.", (unsigned)nativeTaskGetStackUsed(modemTask->handle), (unsigned)nativeTaskGetStackUsed(routerTask->handle));
+  TEST_MESSAGE(info);
+  TEST_ASSERT_GREATER_THAN(0, nativeTaskGetStackUsed(modemTask->handle));
+  TEST_ASSERT_GREATER_THAN(0, nativeTaskGetStackUsed(routerTask->handle));
+}
+
+int main(int argc, char **argv) {
+  config.callsign       = CALLSIGN;
+  config.digi.active    = true;
+  config.aprs_is.active = true;
+  config.lora.tx_enable = true;
+  config.lora.dutyCycle = 0;
+  lora.setBoardConfig(&TTGO_LORA32_V2);
+  lora.setUserConfig(&config);
+  lora.setPacketPool(new PacketPool(PACKET_POOL_SIZE));
+  lora.setStationTable(new StationTable(STATION_TABLE_SIZE));
+  bus   = new PacketBus(PACKET_BUS_SIZE);
+  probe = bus->subscribe("Probe", PacketBus::RfReceived | PacketBus::RfCorrupt | PacketBus::ToAprsIs);
+
+  TxScheduler::Config txConfig;
+  txConfig.spreadingFactor = config.lora.spreadingFactor;
+  txConfig.signalBandwidth = config.lora.signalBandwidth;
+  txConfig.codingRate4     = config.lora.codingRate4;
+  txConfig.preambleLength  = LORA_PREAMBLE_LENGTH;
+  txConfig.dutyCycle       = config.lora.dutyCycle;
+  scheduler                = new TxScheduler(TX_QUEUE_SIZE, txConfig);
+
+  // The tasks run until the end of the process, like on the target
+  modemTask  = new RadiolibTask(5, 0, false, lora, *bus, *scheduler);
+  routerTask = new RouterTask(4, 0, false, lora, *bus, *scheduler);
+
+  UNITY_BEGIN();
+  RUN_TEST(test_trace_is_parsed);
+  RUN_TEST(test_replay_routes_every_frame);
+  RUN_TEST(test_replay_follows_trace_time);
+  RUN_TEST(test_replayed_packet_stays_local);
+  RUN_TEST(test_replay_burst);
+  RUN_TEST(test_stack_usage);
+  int failures = UNITY_END();
+
+  // The tasks never return: leave without running the static destructors under their feet
+  fflush(stdout);
+  _exit(failures);
+}
@@ -0,0 +1,103 @@
+#include <StationTable.h>
+#include <unity.h>
+
+#define WINDOW_MS   (30 * 60000)
+#define INTERVAL_MS 10000
+
+static void hear(StationTable &table, const char *callsign, uint32_t now) {
+  Station heard = {};
+  strcpy(heard.callsign, callsign);
+  heard.lastHeard = now;
+  table.update(heard);
+}
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+void test_update(void) {
+  StationTable table(4);
+  Station      station;
+  hear(table, "F4ABC-9", 1000);
+  hear(table, "F4ABC-9", 2000);
+  TEST_ASSERT_TRUE(table.find("F4ABC-9", &station));
+  TEST_ASSERT_EQUAL(2, station.packets);
+  TEST_ASSERT_EQUAL(2000, station.lastHeard);
+  TEST_ASSERT_FALSE(table.find("F4ABC", &station));
+  TEST_ASSERT_EQUAL(1, table.getCount());
+}
+
+void test_evicts_least_recently_heard(void) {
+  StationTable table(3);
+  hear(table, "A", 1);
+  hear(table, "B", 2);
+  hear(table, "C", 3);
+  hear(table, "A", 4);
+  hear(table, "D", 5);
+
+  Station stations[4];
+  TEST_ASSERT_EQUAL(3, table.snapshot(stations, 4));
+  TEST_ASSERT_EQUAL_STRING("D", stations[0].callsign);
+  TEST_ASSERT_EQUAL_STRING("A", stations[1].callsign);
+  TEST_ASSERT_EQUAL_STRING("C", stations[2].callsign);
+  TEST_ASSERT_EQUAL(1, table.getEvictions());
+  TEST_ASSERT_FALSE(table.wasHeard("B", 5, WINDOW_MS));
+}
+
+void test_was_heard(void) {
+  StationTable table(4);
+  hear(table, "F4ABC-9", 1000);
+  TEST_ASSERT_TRUE(table.wasHeard("F4ABC-9", 1000 + WINDOW_MS - 1, WINDOW_MS));
+  TEST_ASSERT_FALSE(table.wasHeard("F4ABC-9", 1000 + WINDOW_MS, WINDOW_MS));
+  TEST_ASSERT_FALSE(table.wasHeard("F4ABC", 1000, WINDOW_MS));
+  // millis() wraps around after 49 days
+  hear(table, "F4ABC-9", 0xFFFFF000);
+  TEST_ASSERT_TRUE(table.wasHeard("F4ABC-9", 0x1000, WINDOW_MS));
+}
+
+void test_gate(void) {
+  StationTable table(2);
+  TEST_ASSERT_FALSE(table.gate("F4ABC-9", 1000, INTERVAL_MS));
+
+  hear(table, "F4ABC-9", 1000);
+  TEST_ASSERT_TRUE(table.gate("F4ABC-9", 2000, INTERVAL_MS));
+  TEST_ASSERT_FALSE(table.gate("F4ABC-9", 2000 + INTERVAL_MS - 1, INTERVAL_MS));
+  TEST_ASSERT_TRUE(table.gate("F4ABC-9", 2000 + INTERVAL_MS, INTERVAL_MS));
+  // Hearing the station again keeps the rate limit
+  hear(table, "F4ABC-9", 2000 + INTERVAL_MS);
+  TEST_ASSERT_FALSE(table.gate("F4ABC-9", 2000 + INTERVAL_MS, INTERVAL_MS));
+
+  // A station evicted then heard again starts afresh
+  hear(table, "A", 3000 + INTERVAL_MS);
+  hear(table, "B", 4000 + INTERVAL_MS);
+  hear(table, "F4ABC-9", 5000 + INTERVAL_MS);
+  TEST_ASSERT_TRUE(table.gate("F4ABC-9", 5000 + INTERVAL_MS, INTERVAL_MS));
+}
+
+void test_many_stations(void) {
+  // Fills the table several times so that the hash table goes through many backward shift deletions
+  StationTable table(64);
+  char         callsign[Station::CALLSIGN_SIZE];
+  for (uint32_t i = 0; i < 1000; i++) {
+    snprintf(callsign, sizeof(callsign), "F%uABC", i);
+    hear(table, callsign, i);
+  }
+  TEST_ASSERT_EQUAL(64, table.getCount());
+  TEST_ASSERT_EQUAL(1000 - 64, table.getEvictions());
+  for (uint32_t i = 0; i < 1000; i++) {
+    snprintf(callsign, sizeof(callsign), "F%uABC", i);
+    TEST_ASSERT_EQUAL(i >= 1000 - 64, table.wasHeard(callsign, 1000, WINDOW_MS));
+  }
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_update);
+  RUN_TEST(test_evicts_least_recently_heard);
+  RUN_TEST(test_was_heard);
+  RUN_TEST(test_gate);
+  RUN_TEST(test_many_stations);
+  return UNITY_END();
+}